@@ -3,28 +3,218 @@
 #include <fstream>
 #include <sstream>
 
-#define MAX_VERTICES pow(2,28)
+#ifdef ENABLE_64BIT_INDICES
+#	define MAX_VERTICES pow(2,34)
+#else
+#	define MAX_VERTICES pow(2,28)
+#endif
 
 #include "mesh_subdiv_catmull-clark_cpu.h"
 
 int main(int argc, char* argv[])
 {
+	const std::string usage = std::string("Usage: ") + argv[0] + " <filename>.obj <depth> [timing=nb_repetitions (default 0)] [--gather] [--write-cage <filename>.cage] [--ply|--dump] [--low-memory] [--fused] [--reorder morton|rcm] [--soa] [--simd scalar|avx2|avx512] [--sparse-creases] [--limit] [--uv smooth|linear-boundaries|linear] [--stencils levels|composed] [--adaptive]" ;
 	if (argc < 3)
 	{
-		std::cout << "Usage: " << argv[0] << " <filename>.obj <depth> [timing=nb_repetitions (default 0)]" << std::endl ;
+		std::cout << usage << std::endl ;
 		return 0 ;
 	}
 
 	const std::string f_name(argv[1]) ;
 	const uint D = atoi(argv[2]) ;
-	const uint timing_reps = (argc < 4) ? 0 : atoi(argv[3]) ;
+	const bool timing_reps_given = argc >= 4 && argv[3][0] != '-' ;
+	const uint timing_reps = timing_reps_given ? atoi(argv[3]) : 0 ;
+
+	bool gather = false ;
+	std::string f_name_cage ;
+	std::string format_out = "obj" ;
+	bool low_memory = false ;
+	bool level_fused = false ;
+	bool soa = false ;
+	bool sparse_creases = false ;
+	bool limit = false ;
+	bool uv = false ;
+	Mesh_Subdiv_CPU::Uv_interpolation uv_interpolation = Mesh_Subdiv_CPU::UV_INTERPOLATION_LINEAR_BOUNDARIES ;
+	Mesh_Subdiv_CPU::Stencil_evaluation stencil_evaluation = Mesh_Subdiv_CPU::STENCIL_EVALUATION_NONE ;
+	bool adaptive = false ;
+	bool simd = false ;
+	Simd_isa simd_isa = SIMD_ISA_SCALAR ;
+	std::string reorder_name ;
+	Mesh::Cage_ordering cage_ordering = Mesh::CAGE_ORDERING_MORTON ;
+	for (int i = timing_reps_given ? 4 : 3 ; i < argc ; ++i)
+	{
+		const std::string option(argv[i]) ;
+		if (option == "--ply" || option == "--dump")
+			format_out = option.substr(2) ;
+		else if (option == "--low-memory")
+			low_memory = true ;
+		else if (option == "--fused")
+			level_fused = true ;
+		else if (option == "--soa")
+			soa = true ;
+		else if (option == "--sparse-creases")
+			sparse_creases = true ;
+		else if (option == "--limit")
+			limit = true ;
+		else if (option == "--uv")
+		{
+			uv = true ;
+			const std::string uv_name(i + 1 < argc ? argv[++i] : "") ;
+			if (uv_name == "smooth")
+				uv_interpolation = Mesh_Subdiv_CPU::UV_INTERPOLATION_SMOOTH ;
+			else if (uv_name == "linear-boundaries")
+				uv_interpolation = Mesh_Subdiv_CPU::UV_INTERPOLATION_LINEAR_BOUNDARIES ;
+			else if (uv_name == "linear")
+				uv_interpolation = Mesh_Subdiv_CPU::UV_INTERPOLATION_LINEAR ;
+			else
+			{
+				std::cout << "ERROR: unknown UV interpolation '" << uv_name << "'" << std::endl << usage << std::endl ;
+				return 1 ;
+			}
+		}
+		else if (option == "--stencils")
+		{
+			const std::string stencil_name(i + 1 < argc ? argv[++i] : "") ;
+			if (stencil_name == "levels")
+				stencil_evaluation = Mesh_Subdiv_CPU::STENCIL_EVALUATION_PER_LEVEL ;
+			else if (stencil_name == "composed")
+				stencil_evaluation = Mesh_Subdiv_CPU::STENCIL_EVALUATION_COMPOSED ;
+			else
+			{
+				std::cout << "ERROR: unknown stencil evaluation '" << stencil_name << "'" << std::endl << usage << std::endl ;
+				return 1 ;
+			}
+		}
+		else if (option == "--adaptive")
+			adaptive = true ;
+		else if (option == "--reorder")
+		{
+			reorder_name = i + 1 < argc ? argv[++i] : "" ;
+			if (reorder_name == "morton")
+				cage_ordering = Mesh::CAGE_ORDERING_MORTON ;
+			else if (reorder_name == "rcm")
+				cage_ordering = Mesh::CAGE_ORDERING_RCM ;
+			else
+			{
+				std::cout << "ERROR: unknown cage ordering '" << reorder_name << "'" << std::endl << usage << std::endl ;
+				return 1 ;
+			}
+		}
+		else if (option == "--simd")
+		{
+			simd = true ;
+			const std::string simd_isa_name_arg(i + 1 < argc ? argv[++i] : "") ;
+			if (simd_isa_name_arg == "scalar")
+				simd_isa = SIMD_ISA_SCALAR ;
+			else if (simd_isa_name_arg == "avx2")
+				simd_isa = SIMD_ISA_AVX2 ;
+			else if (simd_isa_name_arg == "avx512")
+				simd_isa = SIMD_ISA_AVX512 ;
+			else
+			{
+				std::cout << "ERROR: unknown instruction set '" << simd_isa_name_arg << "'" << std::endl << usage << std::endl ;
+				return 1 ;
+			}
+		}
+		else if (option == "--gather")
+			gather = true ;
+		else if (option == "--write-cage")
+		{
+			f_name_cage = i + 1 < argc ? argv[++i] : "" ;
+			if (f_name_cage.empty())
+			{
+				std::cout << "ERROR: --write-cage needs a filename" << std::endl << usage << std::endl ;
+				return 1 ;
+			}
+		}
+		else
+		{
+			std::cout << "ERROR: unknown option '" << option << "'" << std::endl << usage << std::endl ;
+			return 1 ;
+		}
+	}
+
+	// adaptive output is a set of quads: it has no halfedge buffers to dump
+	if (adaptive && format_out == "dump")
+	{
+		std::cout << "ERROR: --dump is not available with --adaptive" << std::endl << usage << std::endl ;
+		return 1 ;
+	}
+
+	// adaptive subdivision refines its own scratch meshes, with AoS vertices and dense creases, and outputs patches without UVs nor normals
+	if (adaptive)
+	{
+		const std::pair<bool, std::string> uniform_options[] = {{limit, "--limit"}, {uv, "--uv"}, {stencil_evaluation != Mesh_Subdiv_CPU::STENCIL_EVALUATION_NONE, "--stencils"},
+																 {soa, "--soa"}, {simd, "--simd"}, {sparse_creases, "--sparse-creases"}, {low_memory, "--low-memory"}, {level_fused, "--fused"}} ;
+		for (const auto& option: uniform_options)
+		{
+			if (option.first)
+			{
+				std::cout << "ERROR: " << option.second << " is not available with --adaptive" << std::endl << usage << std::endl ;
+				return 1 ;
+			}
+		}
+	}
+
+	// stencil tables are refined from the halfedges of all depths, which low-memory mode releases
+	if (stencil_evaluation != Mesh_Subdiv_CPU::STENCIL_EVALUATION_NONE && low_memory)
+	{
+		std::cout << "ERROR: --stencils is not available with --low-memory" << std::endl << usage << std::endl ;
+		return 1 ;
+	}
+
+	// the instruction set only selects SoA kernels
+	if (simd && !soa)
+	{
+		std::cout << "ERROR: --simd is only available with --soa" << std::endl << usage << std::endl ;
+		return 1 ;
+	}
 
 	std::stringstream fname_out_ss ;
-	fname_out_ss << "S" << D << "_catmull-clark_cpu.obj" ;
+	fname_out_ss << "S" << D << "_catmull-clark_cpu." << format_out ;
 	std::string fname_out = fname_out_ss.str() ;
 
 	std::cout << "Loading " << f_name << std::endl ;
 	Mesh_Subdiv_CatmullClark_CPU M(f_name, D) ;
+	if (!M.is_loaded())
+		return 1 ;
+	if (!reorder_name.empty())
+	{
+		const index_t cache_misses = M.estimate_cache_misses() ;
+		std::cout << "Reordering cage (" << reorder_name << ") ... " << std::flush ;
+		M.reorder_cage(cage_ordering) ;
+		std::cout << "[OK]" << std::endl ;
+		std::cout << "Estimated cache misses per halfedge pass: " << cache_misses << " -> " << M.estimate_cache_misses() << std::endl ;
+	}
+	M.set_low_memory(low_memory) ;
+	M.set_level_fused(level_fused) ;
+	if (sparse_creases)
+		M.set_crease_storage(Mesh_Subdiv_CPU::CREASE_STORAGE_SPARSE) ;
+	M.set_limit_projection(limit) ;
+	M.set_uv_interpolation(uv_interpolation) ;
+	M.set_stencil_evaluation(stencil_evaluation) ;
+	if (soa)
+	{
+		M.set_vertex_storage(Mesh_Subdiv_CPU::VERTEX_STORAGE_SOA) ;
+		if (simd)
+			M.set_simd_isa(simd_isa) ;
+		std::cout << "Using SoA vertices with " << simd_isa_name(M.get_simd_isa()) << " kernels" << std::endl ;
+	}
+	if (gather)
+		M.set_vertex_refinement_mode(Mesh_Subdiv_CPU::VERTEX_REFINEMENT_GATHER) ;
+
+	if (!f_name_cage.empty())
+	{
+		std::cout << "Exporting cage " << f_name_cage << " ... " << std::flush ;
+		M.export_to_cage(f_name_cage) ;
+		std::cout << "[OK]" << std::endl ;
+	}
+
+	if (!M.fits_index_range())
+	{
+		std::cout << std::endl << "ERROR: Mesh indices overflow at depth " << D << ", rebuild with ENABLE_64BIT_INDICES" << std::endl ;
+		return 0 ;
+	}
 
 	if (M.V(D) > MAX_VERTICES)
 	{
@@ -44,7 +234,65 @@ int main(int argc, char* argv[])
 	M.export_to_obj("S0_input.obj") ;
 	std::cout << "[OK]" << std::endl ;
 
-	if (timing_reps)
+	if (adaptive)
+	{
+		Adaptive_patches patches ;
+		std::vector<double> times(std::max(timing_reps, 1u)) ;
+		std::cout << "Processing adaptive subdivision ... " << std::flush ;
+		for (double& time: times)
+		{
+			const auto start = std::chrono::high_resolution_clock::now() ;
+			M.subdivide_adaptive(patches) ;
+			time = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() ;
+		}
+		std::cout << "\t[OK]" << std::endl ;
+		if (timing_reps)
+		{
+			Timing_stats stats ;
+			Timing_stats::compute_stats(times, stats) ;
+			std::cout << "- Adaptive:\t"	<< stats << std::endl ;
+		}
+
+		std::vector<index_t> depth_patches(D + 1, 0) ;
+		for (const uint d: patches.patch_depths)
+			++depth_patches[d] ;
+		for (uint d = 0 ; d <= D ; ++d)
+			std::cout << "- Depth " << d << ":\t" << depth_patches[d] << " patches" << std::endl ;
+		std::cout << "- Depth " << D << ":\t" << patches.face_count() << " quads" << std::endl ;
+		std::cout << "Adaptive output: " << patches.memory_bytes() / 1e6 << " MB, uniform halfedges and vertices: "
+				  << (M.H(D) * sizeof(HalfEdge) + M.V(D) * sizeof(vec3)) / 1e6 << " MB" << std::endl ;
+
+		// patches are tessellated down to depth D
+		std::vector<vec3> vertices ;
+		std::vector<index_t> quads ;
+		patches.tessellate(D, vertices, quads) ;
+		std::cout << "Exporting tessellated output " << fname_out << " ... " << std::flush ;
+		if (format_out == "ply")
+			Mesh::export_quads_to_ply(fname_out, vertices, quads) ;
+		else
+			Mesh::export_quads_to_obj(fname_out, vertices, quads) ;
+		std::cout << "\t[OK]" << std::endl ;
+		return 0 ;
+	}
+
+	// intermediate depths are released while refining in low-memory mode: steps and depths cannot be timed apart
+	if (timing_reps && low_memory)
+	{
+		Timing_stats stats ;
+		M.subdivide_and_time_total(timing_reps, stats) ;
+		std::cout << "- Total:\t"	<< stats << std::endl ;
+	}
+	else if (timing_reps && level_fused)
+	{
+		std::vector<Timing_stats> stats_topology, stats_vertices ;
+		M.subdivide_and_time_levels(timing_reps, stats_topology, stats_vertices) ;
+		for (uint d = 0 ; d < stats_topology.size() ; ++d)
+		{
+			std::cout << "- Depth " << d << " topology:\t"	<< stats_topology[d] << std::endl ;
+			std::cout << "- Depth " << d << " vertices:\t"	<< stats_vertices[d] << std::endl ;
+		}
+	}
+	else if (timing_reps)
 	{
 		Timing_stats stats_he, stats_cr, stats_cl, stats_vx ;
 		M.subdivide_and_time(timing_reps, stats_he, stats_cr, stats_cl, stats_vx) ;
@@ -59,11 +307,37 @@ int main(int argc, char* argv[])
 		M.subdivide() ;
 		std::cout << "\t\t[OK]" << std::endl ;
 	}
+	if (M.get_border_crease_depth() <= D)
+		std::cout << "Border-only creases from depth " << M.get_border_crease_depth() << std::endl ;
+
+	// the cage is refined again, by the stencil tables
+	if (stencil_evaluation != Mesh_Subdiv_CPU::STENCIL_EVALUATION_NONE)
+	{
+		Timing_stats stats ;
+		std::cout << "Processing stencil evaluation ... " << std::flush ;
+		M.subdivide_vertices_and_time(timing_reps ? timing_reps : 1, stats) ;
+		std::cout << "\t[OK]" << std::endl ;
+		index_t stencil_weights = 0 ;
+		size_t stencil_bytes = 0 ;
+		for (const StencilTable& table: M.get_stencil_tables())
+		{
+			stencil_weights += table.entry_count() ;
+			stencil_bytes += table.memory_bytes() ;
+		}
+		std::cout << "Stencil tables: " << M.get_stencil_tables().size() << " tables, " << stencil_weights << " weights, " << stencil_bytes / 1e6 << " MB" << std::endl ;
+		if (timing_reps)
+			std::cout << "- Stencils:\t"	<< stats << std::endl ;
+	}
 
 	// Check & export output
 	M.check() ;
 	std::cout << "Exporting output " << fname_out << " ... " << std::flush ;
-	M.export_to_obj(fname_out) ;
+	if (format_out == "ply")
+		M.export_to_ply(fname_out) ;
+	else if (format_out == "dump")
+		M.export_to_dump(fname_out) ;
+	else
+		M.export_to_obj(fname_out) ;
 	std::cout << "\t[OK]" << std::endl ;
 
 	return 0 ;
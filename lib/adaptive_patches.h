@@ -0,0 +1,117 @@
+#ifndef __ADAPTIVE_PATCHES_H__
+#define __ADAPTIVE_PATCHES_H__
+
+#include <cstddef>
+#include <vector>
+
+#include "index_type.h"
+#include "vec3.h"
+#include "utils.h"
+
+/**
+ * @brief The Adaptive_patches struct stores the result of feature-adaptive Catmull-Clark subdivision (see Mesh_Subdiv_CatmullClark_CPU::subdivide_adaptive):
+ * the regular faces met at each depth, as bicubic B-spline patches, and the faces left at the target depth around extraordinary vertices and creases, as quads.
+ */
+struct Adaptive_patches
+{
+	static const int patch_size = 16 ; /*!< number of control points of a patch */
+
+	std::vector<vec3> patch_points ; /*!< 4x4 control points of each patch, in row-major order: the patch face spans the 4 central points, rows follow its first halfedge */
+	std::vector<uint> patch_depths ; /*!< depth of the face of each patch */
+	std::vector<vec3> face_points ; /*!< 4 vertices of each quad of the target depth, in face order */
+
+	/**
+	 * @brief patch_count gives the number of patches
+	 */
+	index_t patch_count() const { return patch_depths.size() ; }
+
+	/**
+	 * @brief face_count gives the number of quads of the target depth
+	 */
+	index_t face_count() const { return face_points.size() / 4 ; }
+
+	/**
+	 * @brief memory_bytes gives the size of the buffers
+	 */
+	size_t memory_bytes() const
+	{
+		return (patch_points.size() + face_points.size()) * sizeof(vec3) + patch_depths.size() * sizeof(uint) ;
+	}
+
+	/**
+	 * @brief clear empties the buffers
+	 */
+	void clear()
+	{
+		patch_points.clear() ;
+		patch_depths.clear() ;
+		face_points.clear() ;
+	}
+
+	/**
+	 * @brief refine_bspline subdivides a strided row of n uniform cubic B-spline control points into the 2n-3 control points of the same curve
+	 * (the vertex and edge point rules of Catmull-Clark subdivision on a regular grid, whose tensor product refines patches)
+	 * @param in n control points, stride apart
+	 * @param n number of control points, at least 3
+	 * @param stride distance between two control points of the row, in both buffers
+	 * @param out 2n-3 control points, stride apart
+	 */
+	static void refine_bspline(const vec3* in, int n, int stride, vec3* out)
+	{
+		// edge points of all spans, and vertex points of the inner control points
+		for (int i = 0 ; i < n - 1 ; ++i)
+			out[2 * i * stride] = 0.5f * (in[i * stride] + in[(i + 1) * stride]) ;
+		for (int i = 1 ; i < n - 1 ; ++i)
+			out[(2 * i - 1) * stride] = 0.125f * (in[(i - 1) * stride] + 6.0f * in[i * stride] + in[(i + 1) * stride]) ;
+	}
+
+	/**
+	 * @brief tessellate refines the patches down to the target depth, such that each patch gives the vertices of depth d_max that derive from its face,
+	 * and appends them with the quads of the target depth. Vertices shared by several patches or quads are duplicated.
+	 * @param d_max the target depth, at least the depth of each patch
+	 * @param vertices output vertex buffer
+	 * @param quads output vertex indices, 4 per quad
+	 */
+	void tessellate(uint d_max, std::vector<vec3>& vertices, std::vector<index_t>& quads) const
+	{
+		vertices.clear() ;
+		quads.clear() ;
+
+		// a grid of n control points per side refines into 2n-3: the face of a patch spans the 2^m+1 central points after m refinements
+		std::vector<vec3> grid, rows ;
+		const index_t P = patch_count() ;
+		for (index_t p = 0 ; p < P ; ++p)
+		{
+			grid.assign(patch_points.begin() + patch_size * p, patch_points.begin() + patch_size * (p + 1)) ;
+			int n = 4 ;
+			for (uint d = patch_depths[p] ; d < d_max ; ++d)
+			{
+				const int m = 2 * n - 3 ;
+				rows.resize(n * m) ;
+				for (int i = 0 ; i < n ; ++i)
+					refine_bspline(&grid[i * n], n, 1, &rows[i * m]) ;
+				grid.resize(m * m) ;
+				for (int j = 0 ; j < m ; ++j)
+					refine_bspline(&rows[j], n, m, &grid[j]) ;
+				n = m ;
+			}
+
+			const index_t v_first = vertices.size() ;
+			const int k = n - 2 ;
+			for (int i = 1 ; i < n - 1 ; ++i)
+				for (int j = 1 ; j < n - 1 ; ++j)
+					vertices.push_back(grid[i * n + j]) ;
+			for (int i = 0 ; i < k - 1 ; ++i)
+				for (int j = 0 ; j < k - 1 ; ++j)
+					for (const index_t v: {i * k + j, i * k + j + 1, (i + 1) * k + j + 1, (i + 1) * k + j})
+						quads.push_back(v_first + v) ;
+		}
+
+		const index_t v_first = vertices.size() ;
+		vertices.insert(vertices.end(), face_points.begin(), face_points.end()) ;
+		for (index_t v = 0 ; v < index_t(face_points.size()) ; ++v)
+			quads.push_back(v_first + v) ;
+	}
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef __CAGE_FILE__
+#define __CAGE_FILE__
+
+#include <cstdint>
+
+/**
+ * @brief The CageFileHeader struct starts a binary cage file, as written by Mesh::export_to_cage.
+ * It is followed by the raw halfedge, cage halfedge, vertex and crease buffers, in this order.
+ * The element sizes and endianness marker reject files written by a build with a different memory layout.
+ */
+struct CageFileHeader
+{
+	char Magic[8] ; /*!< File signature, equal to #CAGE_FILE_MAGIC */
+	uint32_t Version ; /*!< Format version, equal to #CAGE_FILE_VERSION */
+	uint32_t Endianness ; /*!< Equal to #CAGE_FILE_ENDIANNESS when read on a machine of the writer's endianness */
+	uint32_t Halfedge_size ; /*!< Size in bytes of a HalfEdge */
+	uint32_t Halfedge_cage_size ; /*!< Size in bytes of a HalfEdge_cage */
+	uint32_t Vertex_size ; /*!< Size in bytes of a vertex */
+	uint32_t Crease_size ; /*!< Size in bytes of a Crease */
+	int64_t H_count ; /*!< Number of halfedges */
+	int64_t V_count ; /*!< Number of vertices */
+	int64_t E_count ; /*!< Number of edges */
+	int64_t F_count ; /*!< Number of faces */
+	int64_t C_count ; /*!< Number of creases */
+};
+
+#define CAGE_FILE_MAGIC "PHSCAGE"
+#define CAGE_FILE_VERSION 1u
+#define CAGE_FILE_ENDIANNESS 0x01020304u
+
+#endif
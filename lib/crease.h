@@ -1,14 +1,16 @@
 #ifndef __CREASE__
 #define __CREASE__
 
+#include "index_type.h"
+
 /**
  * @brief The Crease struct stores the attributes of a crease
  */
 struct Crease
 {
 	float Sharpness ; /*!< Crease sharpness value */
-	int Next ; /*!< Index of the next crease */
-	int Prev ; /*!< Index of the previous crease */
+	index_t Next ; /*!< Index of the next crease */
+	index_t Prev ; /*!< Index of the previous crease */
 };
 
 #endif
@@ -0,0 +1,31 @@
+#ifndef __DUMP_FILE__
+#define __DUMP_FILE__
+
+#include <cstdint>
+
+/**
+ * @brief The DumpFileHeader struct starts a raw dump file, as written by Mesh::export_to_dump.
+ * It is followed by the raw HalfEdge, vertex (3 floats) and Crease buffers of the mesh, in this order.
+ * Next, Prev and Face are not stored: when Face_size is not 0, the halfedges of face f are Face_size*f to Face_size*f+Face_size-1.
+ */
+struct DumpFileHeader
+{
+	char Magic[8] ; /*!< File signature, equal to #DUMP_FILE_MAGIC */
+	uint32_t Version ; /*!< Format version, equal to #DUMP_FILE_VERSION */
+	uint32_t Endianness ; /*!< Equal to #DUMP_FILE_ENDIANNESS when read on a machine of the writer's endianness */
+	uint32_t Halfedge_size ; /*!< Size in bytes of a HalfEdge */
+	uint32_t Vertex_size ; /*!< Size in bytes of a vertex */
+	uint32_t Crease_size ; /*!< Size in bytes of a Crease */
+	uint32_t Face_size ; /*!< Number of vertices of all faces, or 0 if faces are not all of the same size */
+	int64_t H_count ; /*!< Number of halfedges */
+	int64_t V_count ; /*!< Number of vertices */
+	int64_t E_count ; /*!< Number of edges */
+	int64_t F_count ; /*!< Number of faces */
+	int64_t C_count ; /*!< Number of creases */
+};
+
+#define DUMP_FILE_MAGIC "PHSDUMP"
+#define DUMP_FILE_VERSION 1u
+#define DUMP_FILE_ENDIANNESS 0x01020304u
+
+#endif
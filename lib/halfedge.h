@@ -1,14 +1,16 @@
 #ifndef __HALFEDGE__
 #define __HALFEDGE__
 
+#include "index_type.h"
+
 /**
  * @brief The HalfEdge struct stores the (non-analytic) attributes of a halfedge
  */
 struct HalfEdge
 {
-	int Twin ; /*!< Index of the twin halfedge (or -1 if its a border) */
-	int Vert ; /*!< Index of the vertex the halfedge points out from */
-	int Edge ; /*!< Index of the edge that spans the halfedge */
+	index_t Twin ; /*!< Index of the twin halfedge (or -1 if its a border) */
+	index_t Vert ; /*!< Index of the vertex the halfedge points out from */
+	index_t Edge ; /*!< Index of the edge that spans the halfedge */
 };
 
 /**
@@ -18,9 +20,9 @@ struct HalfEdge
  */
 struct HalfEdge_cage
 {
-	int Next ; /*!< Index of the next halfedge within a face */
-	int Prev ; /*!< Index of the previous halfedge within a face */
-	int Face ; /*!< Index of the face the halfedge lives in */
+	index_t Next ; /*!< Index of the next halfedge within a face */
+	index_t Prev ; /*!< Index of the previous halfedge within a face */
+	index_t Face ; /*!< Index of the face the halfedge lives in */
 };
 
 #endif
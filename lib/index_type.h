@@ -0,0 +1,17 @@
+#ifndef __INDEX_TYPE__
+#define __INDEX_TYPE__
+
+#include <cstdint>
+
+/**
+ * @brief index_t is the integer type of all halfedge, vertex, edge, face and crease indices and counters.
+ * It is 32-bit by default, which is faster and lighter. Defining ENABLE_64BIT_INDICES (see the CMake option of the same name)
+ * makes it 64-bit, for meshes that exceed 2^31 halfedges once subdivided.
+ */
+#ifdef ENABLE_64BIT_INDICES
+	typedef int64_t index_t ;
+#else
+	typedef int32_t index_t ;
+#endif
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef __MAPPED_FILE__
+#define __MAPPED_FILE__
+
+#include <string>
+
+#if defined(_WIN32)
+#	include <fstream>
+#	include <vector>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+/**
+ * @brief The MappedFile class exposes the content of a file as a read-only contiguous range of characters.
+ * The file is memory-mapped on POSIX systems, and read at once into memory otherwise.
+ */
+class MappedFile
+{
+public:
+	/**
+	 * @brief MappedFile maps the content of a file
+	 * @param filename path of the file. If it cannot be opened, is_open() returns false.
+	 */
+	MappedFile(const std::string& filename)
+	{
+#if defined(_WIN32)
+		std::ifstream file(filename, std::ios::binary | std::ios::ate) ;
+		if (!file)
+			return ;
+		buffer.resize(size_t(file.tellg())) ;
+		file.seekg(0) ;
+		file.read(buffer.data(), buffer.size()) ;
+		content = buffer.data() ;
+		content_size = buffer.size() ;
+		opened = true ;
+#else
+		const int fd = ::open(filename.c_str(), O_RDONLY) ;
+		if (fd < 0)
+			return ;
+
+		struct stat st ;
+		if (::fstat(fd, &st) == 0)
+		{
+			content_size = size_t(st.st_size) ;
+			opened = true ;
+			if (content_size > 0)
+			{
+				void* ptr = ::mmap(nullptr, content_size, PROT_READ, MAP_PRIVATE, fd, 0) ;
+				if (ptr == MAP_FAILED)
+				{
+					content_size = 0 ;
+					opened = false ;
+				}
+				else
+				{
+					::madvise(ptr, content_size, MADV_SEQUENTIAL) ;
+					content = static_cast<const char*>(ptr) ;
+				}
+			}
+		}
+		::close(fd) ;
+#endif
+	}
+
+	~MappedFile()
+	{
+#if !defined(_WIN32)
+		if (content != nullptr)
+			::munmap(const_cast<char*>(content), content_size) ;
+#endif
+	}
+
+	MappedFile(const MappedFile&) = delete ;
+	MappedFile& operator=(const MappedFile&) = delete ;
+
+	bool is_open() const { return opened ; }
+	const char* begin() const { return content ; }
+	const char* end() const { return content + content_size ; }
+	size_t size() const { return content_size ; }
+
+private:
+	const char* content = nullptr ;	/*!< first character of the file */
+	size_t content_size = 0 ;		/*!< number of characters of the file */
+	bool opened = false ;			/*!< whether the file could be opened */
+#if defined(_WIN32)
+	std::vector<char> buffer ;		/*!< file content */
+#endif
+};
+
+#endif
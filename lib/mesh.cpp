@@ -1,41 +1,69 @@
 #include "mesh.h"
+#include "mapped_file.h"
+#include "cage_file.h"
+#include "dump_file.h"
+
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <type_traits>
 
 // ----------- Constructor/destructor -----------
-Mesh::Mesh(const std::string& filename)
+Mesh::Mesh(const std::string& filename):
+	H_count(0), V_count(0), E_count(0), F_count(0), C_count(0), loaded(false)
 {
-	read_from_obj(filename) ;
+	const MappedFile file(filename) ;
+	if (!file.is_open())
+	{
+		std::cerr << "ERROR Mesh: cannot open " << filename << std::endl ;
+		return ;
+	}
+
+	if (is_cage_file(file))
+	{
+		if (!read_from_cage(file))
+		{
+			std::cerr << "ERROR Mesh: " << filename << " is a truncated cage file, or was written by another version or build" << std::endl ;
+			return ;
+		}
+	}
+	else
+	{
+		read_from_obj(file) ;
+	}
+	loaded = true ;
 }
 
 // ----------- Accessors -----------
-int
+index_t
 Mesh::H(int depth) const
 {
 	assert(depth <= 0) ;
 	return H_count ;
 }
 
-int
+index_t
 Mesh::E(int depth) const
 {
 	assert(depth <= 0) ;
 	return E_count ;
 }
 
-int
+index_t
 Mesh::V(int depth) const
 {
 	assert(depth <= 0) ;
 	return V_count ;
 }
 
-int
+index_t
 Mesh::F(int depth) const
 {
 	assert(depth <= 0) ;
 	return F_count ;
 }
 
-int
+index_t
 Mesh::C(int depth) const
 {
 	assert(depth <= 0) ;
@@ -43,117 +71,81 @@ Mesh::C(int depth) const
 }
 
 // ----------- Accessors for halfedge and crease values from specified buffers -----------
-int
-Mesh::Twin(const halfedge_buffer& buffer, int idx) const
-{
-	return buffer[idx].Twin ;
-}
-
-int
-Mesh::Prev(const halfedge_buffer_cage& buffer, int idx) const
+index_t
+Mesh::Prev(const halfedge_buffer_cage& buffer, index_t idx) const
 {
 	return buffer[idx].Prev ;
 }
 
-int
-Mesh::Next(const halfedge_buffer_cage& buffer, int idx) const
+index_t
+Mesh::Next(const halfedge_buffer_cage& buffer, index_t idx) const
 {
 	return buffer[idx].Next ;
 }
 
-int
-Mesh::Vert(const halfedge_buffer& buffer, int idx) const
-{
-	return buffer[idx].Vert ;
-}
-
-int
-Mesh::Edge(const halfedge_buffer& buffer, int idx) const
-{
-	return buffer[idx].Edge ;
-}
-
-int
-Mesh::Face(const halfedge_buffer_cage& buffer, int idx) const
+index_t
+Mesh::Face(const halfedge_buffer_cage& buffer, index_t idx) const
 {
 	return buffer[idx].Face ;
 }
 
-float
-Mesh::Sharpness(const crease_buffer& buffer, int idx) const
-{
-	return idx > buffer.size() ? 0. : buffer[idx].Sharpness ;
-}
-
-int
-Mesh::NextC(const crease_buffer& buffer, int idx) const
-{
-	return buffer[idx].Next ;
-}
-
-int
-Mesh::PrevC(const crease_buffer& buffer, int idx) const
-{
-	return buffer[idx].Prev ;
-}
-
 // ----------- Accessors for halfedge and crease values from the base mesh buffers -----------
-int
-Mesh::Twin(int idx) const
+index_t
+Mesh::Twin(index_t idx) const
 {
 	return Twin(halfedges,idx) ;
 }
 
-int
-Mesh::Prev(int idx) const
+index_t
+Mesh::Prev(index_t idx) const
 {
 	return halfedges_cage[idx].Prev ;
 }
 
-int
-Mesh::Next(int idx) const
+index_t
+Mesh::Next(index_t idx) const
 {
 	return Next(halfedges_cage,idx) ;
 }
 
-int
-Mesh::Vert(int idx) const
+index_t
+Mesh::Vert(index_t idx) const
 {
 	return Vert(halfedges,idx) ;
 }
 
-int
-Mesh::Edge(int idx) const
+index_t
+Mesh::Edge(index_t idx) const
 {
 	return Edge(halfedges,idx) ;
 }
 
-int
-Mesh::Face(int idx) const
+index_t
+Mesh::Face(index_t idx) const
 {
 	return Face(halfedges_cage,idx) ;
 }
 
 float
-Mesh::Sharpness(int idx) const
+Mesh::Sharpness(index_t idx) const
 {
 	return Sharpness(creases, idx) ;
 }
 
-int
-Mesh::NextC(int idx) const
+index_t
+Mesh::NextC(index_t idx) const
 {
 	return NextC(creases,idx) ;
 }
 
-int
-Mesh::PrevC(int idx) const
+index_t
+Mesh::PrevC(index_t idx) const
 {
 	return PrevC(creases, idx) ;
 }
 
-int
-Mesh::Next_safe(int idx) const
+index_t
+Mesh::Next_safe(index_t idx) const
 {
 	return idx < 0 ? idx : Next(idx) ;
 }
@@ -161,24 +153,18 @@ Mesh::Next_safe(int idx) const
 
 // ----------- utility functions for evaluating local configurations -----------
 bool
-Mesh::is_border_halfedge(const halfedge_buffer& buffer, int h) const
-{
-	return Twin(buffer,h) < 0 ;
-}
-
-bool
-Mesh::is_crease_edge(const crease_buffer& buffer, int crease_id) const
+Mesh::is_crease_edge(const crease_buffer& buffer, index_t crease_id) const
 {
 	return Sharpness(buffer,crease_id) > _epsilon_ ;
 }
 
 int
-Mesh::vertex_halfedge_valence(const halfedge_buffer& h_buffer, int h) const
+Mesh::vertex_halfedge_valence(const halfedge_buffer& h_buffer, index_t h) const
 {
 	int n = 1 ;
 
-	int h_back_valid = h ;
-	int h_back = Twin(h_buffer,Prev(h)) ;
+	index_t h_back_valid = h ;
+	index_t h_back = Twin(h_buffer,Prev(h)) ;
 
 	// rewind to border (if any)
 	while ((h_back != h) && (h_back >= 0))
@@ -188,7 +174,7 @@ Mesh::vertex_halfedge_valence(const halfedge_buffer& h_buffer, int h) const
 	}
 
 	// fw to border or back to start and count
-	int h_fw = Next_safe(Twin(h_buffer,h_back_valid)) ;
+	index_t h_fw = Next_safe(Twin(h_buffer,h_back_valid)) ;
 	while ((h_fw != h_back_valid) && (h_fw >= 0))
 	{
 		n++ ;
@@ -199,12 +185,12 @@ Mesh::vertex_halfedge_valence(const halfedge_buffer& h_buffer, int h) const
 }
 
 int
-Mesh::vertex_edge_valence(const halfedge_buffer& buffer, int h) const
+Mesh::vertex_edge_valence(const halfedge_buffer& buffer, index_t h) const
 {
 	int n = 1 ;
 
-	int h_back_valid = h ;
-	int h_back = Twin(buffer,Prev(h)) ;
+	index_t h_back_valid = h ;
+	index_t h_back = Twin(buffer,Prev(h)) ;
 	
 	// rewind to border (if any)
 	while ((h_back != h) && (h_back >= 0))
@@ -214,7 +200,7 @@ Mesh::vertex_edge_valence(const halfedge_buffer& buffer, int h) const
 	}
 
 	// fw to border or back to start and count
-	int h_fw = Next_safe(Twin(buffer,h_back_valid)) ;
+	index_t h_fw = Next_safe(Twin(buffer,h_back_valid)) ;
 	while ((h_fw != h_back_valid) && (h_fw >= 0))
 	{
 		n++ ;
@@ -228,11 +214,11 @@ Mesh::vertex_edge_valence(const halfedge_buffer& buffer, int h) const
 }
 
 int
-Mesh::vertex_crease_valence(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, int h) const
+Mesh::vertex_crease_valence(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, index_t h) const
 {
 	int n = int(is_crease_halfedge(h_buffer, c_buffer, h)) ;
 
-	int h_it ;
+	index_t h_it ;
 	for (h_it = Twin(h_buffer,h) ; h_it >= 0 ; h_it = Twin(h_buffer, h_it))
 	{
 		h_it = Next(h_it) ;
@@ -258,15 +244,15 @@ Mesh::vertex_crease_valence(const halfedge_buffer& h_buffer, const crease_buffer
 }
 
 int
-Mesh::vertex_edge_valence_or_border(const halfedge_buffer& h_buffer, int h) const
+Mesh::vertex_edge_valence_or_border(const halfedge_buffer& h_buffer, index_t h) const
 {
 	int n = 0 ;
 
-	int hh = h ;
+	index_t hh = h ;
 	do
 	{
 		n++ ;
-		const int hh_twin = Twin(h_buffer, hh) ;
+		const index_t hh_twin = Twin(h_buffer, hh) ;
 
 		bool is_border = hh_twin < 0 ;
 		if (is_border)
@@ -280,17 +266,17 @@ Mesh::vertex_edge_valence_or_border(const halfedge_buffer& h_buffer, int h) cons
 }
 
 int
-Mesh::vertex_crease_valence_or_border(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, int h) const
+Mesh::vertex_crease_valence_or_border(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, index_t h) const
 {
 	int n = 0 ;
 
-	int hh = h ;
+	index_t hh = h ;
 	do
 	{
 		if (is_crease_halfedge(h_buffer, c_buffer, hh))
 			n++ ;
 
-		int hh_twin = Twin(h_buffer, hh) ;
+		index_t hh_twin = Twin(h_buffer, hh) ;
 		bool is_border = hh_twin < 0 ;
 		if (is_border)
 			return -1 ;
@@ -303,18 +289,18 @@ Mesh::vertex_crease_valence_or_border(const halfedge_buffer& h_buffer, const cre
 }
 
 float
-Mesh::vertex_sharpnesssum_or_border(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, int h) const
+Mesh::vertex_sharpnesssum_or_border(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, index_t h) const
 {
 	float edge_valence = 0.0 ;
 	float sharpness = 0 ;
 
-	int hh = h ;
+	index_t hh = h ;
 	do
 	{
 		sharpness += Sharpness(c_buffer, Edge(h_buffer, hh)) ;
 		++edge_valence ;
 
-		const int hh_twin = Twin(h_buffer, hh) ;
+		const index_t hh_twin = Twin(h_buffer, hh) ;
 		const bool is_border = hh_twin < 0 ;
 		if (is_border)
 			return -1.0f ;
@@ -327,12 +313,12 @@ Mesh::vertex_sharpnesssum_or_border(const halfedge_buffer& h_buffer, const creas
 }
 
 float
-Mesh::vertex_sharpness_sum(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, int h) const
+Mesh::vertex_sharpness_sum(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, index_t h) const
 {
 	float edge_valence = 1.0 ;
 	float sharpness = Sharpness(c_buffer, Edge(h_buffer, h)) ;
 
-	int h_it ;
+	index_t h_it ;
 	for (h_it = Twin(h_buffer, h) ; h_it >= 0 ; h_it = Twin(h_buffer, h_it))
 	{
 		h_it = Next(h_it) ;
@@ -356,17 +342,38 @@ Mesh::vertex_sharpness_sum(const halfedge_buffer& h_buffer, const crease_buffer&
 	return sharpness ;
 }
 
+void
+Mesh::compute_vertex_halfedges(const halfedge_buffer& h_buffer, std::vector<index_t>& vh_buffer) const
+{
+	std::fill(vh_buffer.begin(), vh_buffer.end(), -1) ;
+
+	const index_t Hd = h_buffer.size() ;
+	for (index_t h = 0 ; h < Hd ; ++h)
+	{
+		const index_t v = Vert(h_buffer, h) ;
+		const bool is_first_of_fan = Twin(h_buffer, Prev(h)) < 0 ;
+		if (vh_buffer[v] < 0 || is_first_of_fan)
+			vh_buffer[v] = h ;
+	}
+}
+
+int
+Mesh::constant_face_size() const
+{
+	return 0 ;
+}
+
 bool
-Mesh::is_crease_halfedge(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, int h) const
+Mesh::is_crease_halfedge(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, index_t h) const
 {
 	return Sharpness(c_buffer,Edge(h_buffer,h)) > _epsilon_ ;
 }
 
 int
-Mesh::n_vertex_of_polygon(int h) const
+Mesh::n_vertex_of_polygon(index_t h) const
 {
 	int n = 1 ;
-	for (int h_fw = Mesh::Next(h) ; h_fw != h ; h_fw = Mesh::Next(h_fw))
+	for (index_t h_fw = Mesh::Next(h) ; h_fw != h ; h_fw = Mesh::Next(h_fw))
 	{
 		++n ;
 	}
@@ -385,11 +392,11 @@ Mesh::check() const
 		return false ;
 	}
 
-	for (int h = 0; h < H_count ; ++h)
+	for (index_t h = 0; h < H_count ; ++h)
 	{
-		const int h_twin = Twin(h) ;
-		const int h_edge = Edge(h) ;
-		const int h_vert = Vert(h) ;
+		const index_t h_twin = Twin(h) ;
+		const index_t h_edge = Edge(h) ;
+		const index_t h_vert = Vert(h) ;
 
 		bool check_twin = (is_border_halfedge(halfedges,h) || h == Twin(h_twin)) ;
 		if (!check_twin)
@@ -421,6 +428,12 @@ Mesh::check() const
 	return valid ;
 }
 
+bool
+Mesh::is_loaded() const
+{
+	return loaded ;
+}
+
 bool
 Mesh::is_tri_only() const
 {
@@ -433,11 +446,11 @@ Mesh::is_quad_only() const
 	return all_faces_are_ngons(4);
 }
 
-int
+index_t
 Mesh::count_sharp_creases() const
 {
-	int counter = 0 ;
-	for (int c = 0; c < C_count ; ++c)
+	index_t counter = 0 ;
+	for (index_t c = 0; c < C_count ; ++c)
 	{
 		if (Sharpness(c) > _epsilon_)
 			counter ++ ;
@@ -446,11 +459,24 @@ Mesh::count_sharp_creases() const
 	return counter ;
 }
 
-int
+bool
+Mesh::has_border_creases_only() const
+{
+	for (index_t h = 0 ; h < H_count ; ++h)
+	{
+		const float expected = Twin(halfedges, h) < 0 ? border_sharpness : 0.0f ;
+		if (Sharpness(creases, Edge(halfedges, h)) != expected)
+			return false ;
+	}
+
+	return true ;
+}
+
+index_t
 Mesh::count_border_edges() const
 {
-	int counter = 0 ;
-	for (int h = 0; h < H_count ; ++h)
+	index_t counter = 0 ;
+	for (index_t h = 0; h < H_count ; ++h)
 	{
 		if (Twin(h) < 0)
 			counter ++ ;
@@ -462,7 +488,7 @@ Mesh::count_border_edges() const
 bool
 Mesh::all_faces_are_ngons(int n) const
 {
-	for (int h = 0; h < H_count ; ++h)
+	for (index_t h = 0; h < H_count ; ++h)
 	{
 		bool is_ngon = n_vertex_of_polygon(h) == n ;
 		if (!is_ngon)
@@ -472,372 +498,1199 @@ Mesh::all_faces_are_ngons(int n) const
 	return H_count > 0 ;
 }
 
-void Mesh::export_to_obj(const std::string& filename) const
+// ----------- OBJ formatting helpers -----------
+static inline void
+append_float(std::string& out, float value)
 {
-	std::ofstream file(filename) ;
+	// same output as the default formatting of std::ostream (i.e., "%g")
+	char buf[32] ;
+	const std::to_chars_result result = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::general, 6) ;
+	out.append(buf, result.ptr) ;
+}
 
-	file << "# Vertices" << std::endl ;
-	for (int v = 0 ; v < vertices.size() ; ++v)
-	{
-		file << "v " << vertices[v][0] << " " << vertices[v][1] << " " << vertices[v][2] << std::endl ;
-	}
+static inline void
+append_int(std::string& out, index_t value)
+{
+	char buf[24] ;
+	const std::to_chars_result result = std::to_chars(buf, buf + sizeof(buf), value) ;
+	out.append(buf, result.ptr) ;
+}
+
+static inline bool
+host_is_little_endian()
+{
+	const uint32_t one = 1 ;
+	char first_byte ;
+	std::memcpy(&first_byte, &one, 1) ;
+	return first_byte == 1 ;
+}
 
-	file << "# Topology" ;
-	int f_id_prev = -1 ;
-	for (int h = 0 ; h < halfedges.size() ; ++h)
+/**
+ * @brief append_little_endian appends the bytes of a value in little-endian order
+ */
+template <typename T>
+static inline void
+append_little_endian(std::string& out, T value, bool little_endian_host)
+{
+	char bytes[sizeof(T)] ;
+	std::memcpy(bytes, &value, sizeof(T)) ;
+	if (!little_endian_host)
+		std::reverse(bytes, bytes + sizeof(T)) ;
+	out.append(bytes, sizeof(T)) ;
+}
+
+/**
+ * @brief write_blocks formats the elements [0, count) into a file, block by block.
+ * Each round formats one block per thread in parallel, into a buffer per thread, then writes the buffers in order.
+ * @param format functor formatting the elements [begin, end) into a string
+ */
+template <typename FormatFunctor>
+static void
+write_blocks(std::ofstream& file, index_t count, index_t block_size, FormatFunctor format)
+{
+	const int thread_count = omp_get_max_threads() ;
+	std::vector<std::string> buffers(thread_count) ;
+	for (index_t round_begin = 0 ; round_begin < count ; round_begin += thread_count * block_size)
 	{
-		const int f_id = Face(h) ;
-		if (f_id != f_id_prev)
+		_PARALLEL_FOR
+		for (int t = 0 ; t < thread_count ; ++t)
 		{
-			file << std::endl << "f " ;
-			f_id_prev = f_id ;
+			const index_t begin = std::min(count, round_begin + t * block_size) ;
+			const index_t end = std::min(count, begin + block_size) ;
+			buffers[t].clear() ;
+			format(buffers[t], begin, end) ;
 		}
-		file << 1+Vert(h) << " " ;
-	}
+		_BARRIER
 
-	file.close() ;
+		for (const std::string& buffer: buffers)
+			file.write(buffer.data(), buffer.size()) ;
+	}
 }
 
-// ----------- Functions for loading and exporting from/to OBJ files. -----------
-void
-Mesh::read_obj_mesh_size(std::ifstream& file, int& h_count, int& v_count, int& f_count)
+/**
+ * @brief write_obj_vec3s writes an OBJ line per vec3, e.g. 'v x y z'
+ * @param keyword the OBJ keyword of the lines, followed by a space
+ */
+static void
+write_obj_vec3s(std::ofstream& file, const char* keyword, const std::vector<vec3>& values)
 {
-	v_count = 0 ;
-	f_count = 0 ;
-	h_count = 0 ;
-
-	// Read quantities
-	std::string line ;
-	while(std::getline(file,line))
+	write_blocks(file, values.size(), 1 << 16, [&](std::string& out, index_t begin, index_t end)
 	{
-		std::istringstream iss(line) ;
-		char c = '\0' ;
-		iss >> c ;
-		if (c == 'v' && iss.peek() == ' ')
-			v_count ++ ;
-		else if (c == 'f')
+		out.reserve(40 * (end - begin)) ;
+		for (index_t v = begin ; v < end ; ++v)
 		{
-			f_count ++ ;
-
-			int v_id ;
-			int count_n_vert_per_face = 0 ;
-			while (iss >> v_id)
-			{
-				count_n_vert_per_face++ ;
-				h_count ++ ;
-
-				if (iss.peek() == '/')  // if next is '/'
-					iss.ignore(999,' ') ;      // advance to next space
-			}
+			out += keyword ;
+			append_float(out, values[v][0]) ;
+			out += ' ' ;
+			append_float(out, values[v][1]) ;
+			out += ' ' ;
+			append_float(out, values[v][2]) ;
+			out += '\n' ;
 		}
-	}
+	}) ;
 }
 
-Mesh::crease_buffer
-Mesh::read_obj_data(std::ifstream& file)
+void Mesh::export_to_obj(const std::string& filename) const
 {
-	halfedge_buffer_cage& He_cage = this->halfedges_cage ;
-	halfedge_buffer& He = this->halfedges ;
-	vertex_buffer& Vx = this->vertices ;
+	std::ofstream file(filename) ;
 
-	crease_buffer Cr  ;
+	file << "# Vertices\n" ;
+	write_obj_vec3s(file, "v ", vertices) ;
 
-	// Read actual data
-	int v = 0 ;
-	int f = 0 ;
-	int h = 0 ;
+	// normals are numbered as vertices
+	const bool with_normals = has_normals() ;
+	if (with_normals)
+	{
+		file << "# Normals\n" ;
+		write_obj_vec3s(file, "vn ", normals) ;
+	}
 
-	std::string line ;
-	while(std::getline(file,line))
+	// UVs are face-varying: they are numbered as halfedges
+	const index_t h_count = halfedges.size() ;
+	const bool with_uvs = has_uvs() ;
+	if (with_uvs)
 	{
-		std::istringstream iss(line) ;
-		char c ;
-		iss >> c ;
-		if (c == 'v' && iss.peek() == ' ') // 'v x y z'
+		file << "# Texture coordinates\n" ;
+		write_blocks(file, h_count, 1 << 16, [&](std::string& out, index_t begin, index_t end)
 		{
-			for (int i = 0 ; i < 3 ; ++i)
+			out.reserve(30 * (end - begin)) ;
+			for (index_t h = begin ; h < end ; ++h)
 			{
-				float val ;
-				iss >> val ;
-				Vx[v][i] = val ;
+				out += "vt " ;
+				append_float(out, uvs[h][0]) ;
+				out += ' ' ;
+				append_float(out, uvs[h][1]) ;
+				out += '\n' ;
 			}
-			++v ;
-		}
-		else if (c == 'f' && iss.peek() == ' ') // 'f v1 v2 ... vn'
+		}) ;
+	}
+
+	file << "# Topology\n" ;
+	const int n = constant_face_size() ;
+	write_blocks(file, h_count, 1 << 18, [&](std::string& out, index_t begin, index_t end)
+	{
+		out.reserve((with_normals || with_uvs ? 20 : 10) * (end - begin)) ;
+		for (index_t h = begin ; h < end ; ++h)
 		{
-			int v_id ;
-			std::vector<int> v_ids ;
-			while (iss >> v_id)
+			// a new face starts whenever the face index changes
+			const bool is_face_start = n > 0 ? h % n == 0 : (h == 0 || Face(h) != Face(h - 1)) ;
+			const bool is_face_end = n > 0 ? (h + 1) % n == 0 : (h + 1 == h_count || Face(h + 1) != Face(h)) ;
+			out += is_face_start ? "f " : " " ;
+			append_int(out, 1 + Vert(h)) ;
+			if (with_uvs)
 			{
-				v_ids.push_back(v_id) ;
-
-				if (iss.peek() == '/')  // if next is '/'
-					iss.ignore(999,' ') ;      // advance to next space
+				out += '/' ;
+				append_int(out, 1 + h) ;
 			}
-			int n = v_ids.size() ;
-			for (int i = 0 ; i < n; ++i)
+			if (with_normals)
 			{
+				out += with_uvs ? "/" : "//" ;
+				append_int(out, 1 + Vert(h)) ;
+			}
+			if (is_face_end)
+				out += '\n' ;
+		}
+	}) ;
 
-				int twin = -1 ; // undetermined at this time
-
-				int next = h + 1 ;
-				if (i == n-1)
-					next -= n ;
-
-				int prev = h - 1 ;
-				if (i == 0)
-					prev += n ;
+	file.close() ;
+	if (!file)
+	{
+		std::cerr << "ERROR Mesh::export_to_obj: could not write " << filename << std::endl ;
+	}
+}
 
-				int vert = v_ids[i] - 1 ; // obj is 1-based.
-				int edge = -1 ; // undetermined at this time
-				int face = f ;
+void
+Mesh::export_to_ply(const std::string& filename) const
+{
+	const index_t v_count = vertices.size() ;
+	const index_t h_count = halfedges.size() ;
+	const int n = constant_face_size() ;
+	const bool little_endian = host_is_little_endian() ;
 
-				He[h].Twin = twin ;
-				He[h].Vert = vert ;
-				He[h].Edge = edge ;
-				He_cage[h].Next = next ;
-				He_cage[h].Prev = prev ;
-				He_cage[h].Face = face ;
+	// PLY has no standard 64-bit integer type for the vertex indices
+	if (int64_t(v_count) > std::numeric_limits<int32_t>::max())
+	{
+		std::cerr << "ERROR Mesh::export_to_ply: " << v_count << " vertices exceed the 32-bit indices of PLY files" << std::endl ;
+		return ;
+	}
 
-				++h ;
-			}
-			++f ;
+	const index_t f_count = F_count ;
+	std::ofstream file(filename, std::ios::binary) ;
+	file << "ply\n"
+		 << "format binary_little_endian 1.0\n"
+		 << "element vertex " << v_count << "\n"
+		 << "property float x\n"
+		 << "property float y\n"
+		 << "property float z\n" ;
+	const bool with_normals = has_normals() ;
+	if (with_normals)
+		file << "property float nx\n"
+			 << "property float ny\n"
+			 << "property float nz\n" ;
+	const int attribute_width = has_vertex_attributes() ? vertex_attribute_width() : 0 ;
+	for (const Vertex_attribute& attribute: vertex_attributes)
+	{
+		for (int i = 0 ; attribute_width > 0 && i < attribute.width ; ++i)
+		{
+			file << "property float " << attribute.name ;
+			if (attribute.width > 1)
+				file << "_" << i ;
+			file << "\n" ;
 		}
-		else if (c == 't' && iss.peek() == ' ') // 't '
+	}
+	// the usual uchar list count holds faces of up to 255 vertices: larger ones need a uint count
+	int max_face_size = n ;
+	if (n <= 0)
+	{
+_PARALLEL_FOR_REDUCTION(max, max_face_size)
+		for (index_t h = 0 ; h < h_count ; ++h)
 		{
-			std::string type ;
-			iss >> type ;
-			iss.ignore(999,' ') ;      // advance to next space
-			iss.ignore(999,' ') ;      // advance to next space
+			if (h == 0 || Face(h) != Face(h - 1))
+				max_face_size = std::max(max_face_size, n_vertex_of_polygon(h)) ;
+		}
+	}
+	const bool uint_face_size = max_face_size > std::numeric_limits<uint8_t>::max() ;
+	file << "element face " << f_count << "\n"
+		 << "property list " << (uint_face_size ? "uint" : "uchar") << " int vertex_indices\n"
+		 << "end_header\n" ;
 
-			float sharpness ;
-			if (type == "crease")
+	// vertices are written as is on little-endian machines, unless normals or attributes are interleaved with them
+	if (little_endian && sizeof(vec3) == 3 * sizeof(float) && !with_normals && attribute_width == 0)
+	{
+		file.write(reinterpret_cast<const char*>(vertices.data()), v_count * sizeof(vec3)) ;
+	}
+	else
+	{
+		write_blocks(file, v_count, 1 << 16, [&](std::string& out, index_t begin, index_t end)
+		{
+			for (index_t v = begin ; v < end ; ++v)
 			{
-				int v0, v1 ;
-				iss >> v0 >> v1 >> sharpness ;
-
-				// temporary storage
-				Crease cr ;
-				cr.Sharpness = sharpness ;
-				cr.Next = v0 ;
-				cr.Prev = v1 ;
-				Cr.push_back(cr) ;
+				for (int i = 0 ; i < 3 ; ++i)
+					append_little_endian(out, vertices[v][i], little_endian) ;
+				for (int i = 0 ; with_normals && i < 3 ; ++i)
+					append_little_endian(out, normals[v][i], little_endian) ;
+				for (int i = 0 ; i < attribute_width ; ++i)
+					append_little_endian(out, attributes[attribute_width * v + i], little_endian) ;
 			}
-//			else if (type == "corner")
-//			{
-//				int vert ;
-//				iss >> vert >> sharpness ;
-//			}
-		}
+		}) ;
 	}
 
-	return Cr ;
+	write_blocks(file, h_count, 1 << 18, [&](std::string& out, index_t begin, index_t end)
+	{
+		out.reserve(5 * (end - begin)) ;
+		for (index_t h = begin ; h < end ; ++h)
+		{
+			const bool is_face_start = n > 0 ? h % n == 0 : (h == 0 || Face(h) != Face(h - 1)) ;
+			if (is_face_start)
+			{
+				const int face_size = n > 0 ? n : n_vertex_of_polygon(h) ;
+				if (uint_face_size)
+					append_little_endian(out, uint32_t(face_size), little_endian) ;
+				else
+					out += char(uint8_t(face_size)) ;
+			}
+			append_little_endian(out, int32_t(Vert(h)), little_endian) ;
+		}
+	}) ;
+
+	file.close() ;
+	if (!file)
+	{
+		std::cerr << "ERROR Mesh::export_to_ply: could not write " << filename << std::endl ;
+	}
 }
 
 void
-Mesh::read_from_obj(const std::string& filename)
+Mesh::export_quads_to_obj(const std::string& filename, const std::vector<vec3>& vertices, const std::vector<index_t>& quads)
 {
-	std::ifstream file ;
-	file.open(filename) ;
-
-	int h_count, v_count, f_count ;
-	read_obj_mesh_size(file,h_count,v_count,f_count) ;
-
-	// set constants and alloc
-	this->H_count = h_count ;
-	this->V_count = v_count ;
-	this->F_count = f_count ;
-	halfedges.resize(H_count) ;
-	halfedges_cage.resize(H_count) ;
-	vertices.resize(V_count) ;
+	std::ofstream file(filename) ;
 
-	 // rewind
-	file.clear() ;
-	file.seekg(0) ;
+	file << "# Vertices\n" ;
+	write_obj_vec3s(file, "v ", vertices) ;
 
-	// set he and vx buffers
-	crease_buffer tmp_creases = read_obj_data(file) ;
+	file << "# Topology\n" ;
+	write_blocks(file, quads.size() / 4, 1 << 16, [&](std::string& out, index_t begin, index_t end)
+	{
+		out.reserve(40 * (end - begin)) ;
+		for (index_t q = begin ; q < end ; ++q)
+		{
+			out += 'f' ;
+			for (int i = 0 ; i < 4 ; ++i)
+			{
+				out += ' ' ;
+				append_int(out, 1 + quads[4 * q + i]) ;
+			}
+			out += '\n' ;
+		}
+	}) ;
 
 	file.close() ;
-
-	// Twins
-	compute_and_set_twins() ;
-
-	// Edge
-	this->E_count = compute_and_set_edges() ;
-
-	// Creases
-	this->C_count = this->E_count ;
-	creases.resize(C_count) ;
-	set_creases(tmp_creases) ;
-	set_boundaries_sharp() ;
-	compute_and_set_crease_neighbors() ;
+	if (!file)
+	{
+		std::cerr << "ERROR Mesh::export_quads_to_obj: could not write " << filename << std::endl ;
+	}
 }
 
 void
-Mesh::compute_and_set_twins()
+Mesh::export_quads_to_ply(const std::string& filename, const std::vector<vec3>& vertices, const std::vector<index_t>& quads)
 {
-	halfedge_buffer& He = this->halfedges ;
-
-	typedef std::pair<int,int> pi ;
-	typedef std::pair<int,pi> map_item ;
-	typedef std::multimap<int,pi >mmap ;
-	typedef std::pair <mmap::iterator, mmap::iterator> range ;
+	const index_t v_count = vertices.size() ;
+	const index_t q_count = quads.size() / 4 ;
+	const bool little_endian = host_is_little_endian() ;
 
-	mmap table ;
-
-	for (int h=0 ; h < H_count ; ++h)
+	if (int64_t(v_count) > std::numeric_limits<int32_t>::max())
 	{
-		const int nextID = Next(h) ;
-		const int vh = Vert(h) ;
-		const int vn = Vert(nextID) ;
-
-		table.insert(map_item(vh,pi(vn,h))) ;
+		std::cerr << "ERROR Mesh::export_quads_to_ply: " << v_count << " vertices exceed the 32-bit indices of PLY files" << std::endl ;
+		return ;
 	}
 
-	for (int vh=0 ; vh < V_count ; ++vh)
+	std::ofstream file(filename, std::ios::binary) ;
+	file << "ply\n"
+		 << "format binary_little_endian 1.0\n"
+		 << "element vertex " << v_count << "\n"
+		 << "property float x\n"
+		 << "property float y\n"
+		 << "property float z\n"
+		 << "element face " << q_count << "\n"
+		 << "property list uchar int vertex_indices\n"
+		 << "end_header\n" ;
+
+	if (little_endian && sizeof(vec3) == 3 * sizeof(float))
 	{
-		// for all elements <vh,vn> with key vh
-		range range_vh = table.equal_range(vh) ;
-		for (mmap::iterator it=range_vh.first; it != range_vh.second; ++it)
+		file.write(reinterpret_cast<const char*>(vertices.data()), v_count * sizeof(vec3)) ;
+	}
+	else
+	{
+		write_blocks(file, v_count, 1 << 16, [&](std::string& out, index_t begin, index_t end)
 		{
-			assert (it->first == vh) ;
-			const int vn = it->second.first ;
-			const int h = it->second.second ;
+			for (index_t v = begin ; v < end ; ++v)
+				for (int i = 0 ; i < 3 ; ++i)
+					append_little_endian(out, vertices[v][i], little_endian) ;
+		}) ;
+	}
 
-			// if twin <vn,vh> exist
-			range range_vn = table.equal_range(vn) ;
-			for (mmap::iterator it_vn=range_vn.first; it_vn != range_vn.second; ++it_vn)
-			{
-				assert (it_vn->first == vn) ;
-				const int vnn = it_vn->second.first;
-				const int h_twin = it_vn->second.second ;
-				if (vnn == vh)
-				{			// assign twin ids
-					He[h].Twin = h_twin ;
-					He[h_twin].Twin = h ;
-				}
-			}
+	write_blocks(file, q_count, 1 << 16, [&](std::string& out, index_t begin, index_t end)
+	{
+		out.reserve(17 * (end - begin)) ;
+		for (index_t q = begin ; q < end ; ++q)
+		{
+			out += char(4) ;
+			for (int i = 0 ; i < 4 ; ++i)
+				append_little_endian(out, int32_t(quads[4 * q + i]), little_endian) ;
 		}
+	}) ;
+
+	file.close() ;
+	if (!file)
+	{
+		std::cerr << "ERROR Mesh::export_quads_to_ply: could not write " << filename << std::endl ;
 	}
 }
 
-int
-Mesh::compute_and_set_edges()
+void
+Mesh::export_to_dump(const std::string& filename) const
 {
-	halfedge_buffer& He = this->halfedges;
+	DumpFileHeader header = {} ;
+	std::memcpy(header.Magic, DUMP_FILE_MAGIC, sizeof(header.Magic)) ;
+	header.Version = DUMP_FILE_VERSION ;
+	header.Endianness = DUMP_FILE_ENDIANNESS ;
+	header.Halfedge_size = sizeof(HalfEdge) ;
+	header.Vertex_size = sizeof(vec3) ;
+	header.Crease_size = sizeof(Crease) ;
+	header.Face_size = constant_face_size() ;
+	header.H_count = halfedges.size() ;
+	header.V_count = vertices.size() ;
+	header.E_count = E_count ;
+	header.F_count = F_count ;
+	header.C_count = creases.size() ;
+
+	std::ofstream file(filename, std::ios::binary) ;
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header)) ;
+	file.write(reinterpret_cast<const char*>(halfedges.data()), halfedges.size() * sizeof(HalfEdge)) ;
+	file.write(reinterpret_cast<const char*>(vertices.data()), vertices.size() * sizeof(vec3)) ;
+	file.write(reinterpret_cast<const char*>(creases.data()), creases.size() * sizeof(Crease)) ;
+	file.close() ;
 
-	int edge_count = 0 ;
-	for (int h_id=0 ; h_id < H_count ; ++h_id)
+	if (!file)
 	{
-		HalfEdge& h = He[h_id] ;
-		if (h.Edge < 0) // if not yet set
-		{
-			// if border (no twin)
-			if (Twin(h_id) < 0)
-			{
-				h.Edge = edge_count ;
-				++edge_count ;
-			}
-			else // twin exists
-			{
-				const int twin_edge = Edge(Twin(h_id)) ;
-				if (twin_edge < 0)
-				{
-					h.Edge = edge_count++ ;
-				}
-				else
-				{
-					h.Edge = twin_edge ;
-				}
-			}
-		}
+		std::cerr << "ERROR Mesh::export_to_dump: could not write " << filename << std::endl ;
 	}
-
-	return edge_count ;
 }
 
 void
-Mesh::set_creases(const Mesh::crease_buffer& list_of_creases)
+Mesh::export_to_cage(const std::string& filename) const
 {
-	crease_buffer& Cr = this->creases ;
-	for (const Crease& C: list_of_creases)
+	// subdivided and triangle-only meshes may not store their cage halfedges: they are analytic
+	halfedge_buffer_cage analytic_halfedges_cage ;
+	const bool has_cage_halfedges = halfedges_cage.size() == size_t(H_count) ;
+	if (!has_cage_halfedges)
 	{
-		const int v0 = C.Prev ;
-		const int v1 = C.Next ;
-		const float sharpness = C.Sharpness ;
-
-		for (int h_id=0 ; h_id < H_count ; ++h_id)
+		analytic_halfedges_cage.resize(H_count) ;
+		_PARALLEL_FOR
+		for (index_t h = 0 ; h < H_count ; ++h)
 		{
-			if (Vert(h_id) == v0)
-			{
-				// forward
-				int h ;
-				for (h = Next_safe(Twin(h_id)) ;
-					 (h >= 0 && Vert(Next(h)) != v1 && h != h_id);
-					 h = Next_safe(Twin(h)))
-				{}
-
-				if (h < 0)
-				{
-					// backward
-					for (h = Twin(Prev(h_id)) ;
-						 (h >= 0 && Vert(Next(h)) != v1 && h != h_id);
-						 h = Twin(Prev(h)))
-					{}
-				}
-
-				if (h >= 0 && Vert(Next(h)) == v1)
-				{
-					const int e_id = Edge(h) ;
-
-					Crease& cr = Cr[e_id] ;
-					cr.Sharpness = sharpness ;
-					cr.Next = e_id ;
-					cr.Prev = e_id ;
-				}
-			}
+			analytic_halfedges_cage[h].Next = Next(h) ;
+			analytic_halfedges_cage[h].Prev = Prev(h) ;
+			analytic_halfedges_cage[h].Face = Face(h) ;
 		}
+		_BARRIER
 	}
-}
+	const halfedge_buffer_cage& He_cage = has_cage_halfedges ? halfedges_cage : analytic_halfedges_cage ;
+
+	CageFileHeader header = {} ;
+	std::memcpy(header.Magic, CAGE_FILE_MAGIC, sizeof(header.Magic)) ;
+	header.Version = CAGE_FILE_VERSION ;
+	header.Endianness = CAGE_FILE_ENDIANNESS ;
+	header.Halfedge_size = sizeof(HalfEdge) ;
+	header.Halfedge_cage_size = sizeof(HalfEdge_cage) ;
+	header.Vertex_size = sizeof(vec3) ;
+	header.Crease_size = sizeof(Crease) ;
+	header.H_count = H_count ;
+	header.V_count = V_count ;
+	header.E_count = E_count ;
+	header.F_count = F_count ;
+	header.C_count = C_count ;
+
+	std::ofstream file(filename, std::ios::binary) ;
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header)) ;
+	file.write(reinterpret_cast<const char*>(halfedges.data()), H_count * sizeof(HalfEdge)) ;
+	file.write(reinterpret_cast<const char*>(He_cage.data()), H_count * sizeof(HalfEdge_cage)) ;
+	file.write(reinterpret_cast<const char*>(vertices.data()), V_count * sizeof(vec3)) ;
+	file.write(reinterpret_cast<const char*>(creases.data()), C_count * sizeof(Crease)) ;
+	file.close() ;
 
-int
-Mesh::find_second_crease(int h) const
-{
-	int c_second = Edge(h) ;
-	for (int h_vx_it = Twin(Next(h)) ;
-		 h_vx_it != h ;
-		 h_vx_it = Twin(Next(h_vx_it)))
+	if (!file)
 	{
-		c_second = Edge(h_vx_it) ;
-		const int sharpness_second = creases[c_second].Sharpness ;
-		if (sharpness_second > _epsilon_)
-			return c_second ;
+		std::cerr << "ERROR Mesh::export_to_cage: could not write " << filename << std::endl ;
 	}
+}
 
-	assert(false || !"Mesh::find_second_crease: preconditions not satisfied.") ;
-	return -1 ;
+bool
+Mesh::is_cage_file(const MappedFile& file)
+{
+	return file.size() >= sizeof(CageFileHeader)
+			&& std::memcmp(file.begin(), CAGE_FILE_MAGIC, sizeof(CageFileHeader::Magic)) == 0 ;
 }
 
-void
-Mesh::compute_and_set_crease_neighbors()
+bool
+Mesh::read_from_cage(const MappedFile& file)
 {
-	crease_buffer& Cr = creases ;
-	for (int h = 0 ; h < H_count ; ++h)
-	{
-		const int c = Edge(h) ;
-		const float sharpness = Cr[c].Sharpness ;
-		int h_vx_it ;
+	static_assert(std::is_trivially_copyable<HalfEdge>::value && std::is_trivially_copyable<HalfEdge_cage>::value
+				  && std::is_trivially_copyable<vec3>::value && std::is_trivially_copyable<Crease>::value,
+				  "cage files store raw buffers") ;
 
-		// only treat creases through their biggest halfedge_id
-		if (h < Twin(h) || sharpness < _epsilon_)
-			continue ;
+	timer::time_point start = timer::now() ;
+	H_count = V_count = E_count = F_count = C_count = 0 ;
 
-		// Compute prev
-		int prev_creases = 0 ;
-		int c_prev = c ;
-		for (h_vx_it = Next_safe(Twin(h));
-		     h_vx_it >= 0 && h_vx_it != h;
+	if (!is_cage_file(file))
+		return false ;
+
+	CageFileHeader header ;
+	std::memcpy(&header, file.begin(), sizeof(header)) ;
+	const bool same_layout = header.Version == CAGE_FILE_VERSION
+			&& header.Endianness == CAGE_FILE_ENDIANNESS
+			&& header.Halfedge_size == sizeof(HalfEdge)
+			&& header.Halfedge_cage_size == sizeof(HalfEdge_cage)
+			&& header.Vertex_size == sizeof(vec3)
+			&& header.Crease_size == sizeof(Crease) ;
+	const int64_t index_max = std::numeric_limits<index_t>::max() ;
+	const bool fits_index = header.H_count >= 0 && header.H_count <= index_max
+			&& header.V_count >= 0 && header.V_count <= index_max
+			&& header.E_count >= 0 && header.E_count <= index_max
+			&& header.F_count >= 0 && header.F_count <= index_max
+			&& header.C_count >= 0 && header.C_count <= index_max ;
+	if (!same_layout || !fits_index)
+		return false ;
+
+	const size_t expected_size = sizeof(header)
+			+ header.H_count * (sizeof(HalfEdge) + sizeof(HalfEdge_cage))
+			+ header.V_count * sizeof(vec3)
+			+ header.C_count * sizeof(Crease) ;
+	if (file.size() != expected_size)
+		return false ;
+
+	H_count = header.H_count ;
+	V_count = header.V_count ;
+	E_count = header.E_count ;
+	F_count = header.F_count ;
+	C_count = header.C_count ;
+
+	halfedges.resize(H_count) ;
+	halfedges_cage.resize(H_count) ;
+	vertices.resize(V_count) ;
+	creases.resize(C_count) ;
+
+	const char* data = file.begin() + sizeof(header) ;
+	std::memcpy(halfedges.data(), data, H_count * sizeof(HalfEdge)) ;
+	data += H_count * sizeof(HalfEdge) ;
+	std::memcpy(halfedges_cage.data(), data, H_count * sizeof(HalfEdge_cage)) ;
+	data += H_count * sizeof(HalfEdge_cage) ;
+	std::memcpy(vertices.data(), data, V_count * sizeof(vec3)) ;
+	data += V_count * sizeof(vec3) ;
+	std::memcpy(creases.data(), data, C_count * sizeof(Crease)) ;
+
+	record_load_timing("Cage", start) ;
+	return true ;
+}
+
+// ----------- Functions for loading and exporting from/to OBJ files. -----------
+// ----------- OBJ parsing helpers -----------
+static inline bool
+is_blank(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' ;
+}
+
+static inline const char*
+skip_blanks(const char* p, const char* end)
+{
+	while (p < end && is_blank(*p))
+		++p ;
+	return p ;
+}
+
+static inline const char*
+skip_token(const char* p, const char* end)
+{
+	while (p < end && !is_blank(*p))
+		++p ;
+	return p ;
+}
+
+/**
+ * @brief parse_int reads a signed decimal integer after optional blanks, advancing p past it.
+ * @return false if no integer starts at p, in which case p is unchanged
+ */
+static inline bool
+parse_int(const char*& p, const char* end, index_t& value)
+{
+	const char* q = skip_blanks(p, end) ;
+	const bool negative = q < end && *q == '-' ;
+	if (q < end && (*q == '-' || *q == '+'))
+		++q ;
+
+	const char* digits = q ;
+	index_t v = 0 ;
+	while (q < end && *q >= '0' && *q <= '9')
+	{
+		v = 10 * v + (*q - '0') ;
+		++q ;
+	}
+	if (q == digits)
+		return false ;
+
+	value = negative ? -v : v ;
+	p = q ;
+	return true ;
+}
+
+/**
+ * @brief parse_float reads a floating point number after optional blanks, advancing p past it.
+ * @return the number, or 0 if the token at p is not a number (or is out of the float range), in which case p is advanced past that token
+ */
+static inline float
+parse_float(const char*& p, const char* end)
+{
+	const char* q = skip_blanks(p, end) ;
+	if (q < end && *q == '+')
+		++q ;
+
+	float value = 0.0f ;
+	const std::from_chars_result result = std::from_chars(q, end, value) ;
+	if (result.ec == std::errc())
+		p = result.ptr ;
+	else
+	{
+		// the following numbers must not read the same token again
+		value = 0.0f ;
+		p = skip_token(q, end) ;
+	}
+	return value ;
+}
+
+/**
+ * @brief parse_obj_lines walks the lines of an OBJ range and forwards vertex, texture coordinate, face and crease declarations to the given functors.
+ * Faces are given as their (1-based) vertex and texture coordinate indices, the latter being 0 where a face corner has none, and crease tags as their two vertices and sharpness.
+ */
+template <typename VertexFunctor, typename TexcoordFunctor, typename FaceFunctor, typename CreaseFunctor>
+static void
+parse_obj_lines(const char* p, const char* end, VertexFunctor on_vertex, TexcoordFunctor on_texcoord, FaceFunctor on_face, CreaseFunctor on_crease)
+{
+	std::vector<index_t> v_ids, vt_ids ;
+	while (p < end)
+	{
+		const char* line_end = static_cast<const char*>(std::memchr(p, '\n', end - p)) ;
+		if (line_end == nullptr)
+			line_end = end ;
+
+		const char* q = skip_blanks(p, line_end) ;
+		if (q + 2 < line_end && q[0] == 'v' && q[1] == 't' && is_blank(q[2])) // 'vt u v [w]'
+		{
+			on_texcoord(q + 3, line_end) ;
+		}
+		else if (q + 1 < line_end && (q[1] == ' ' || q[1] == '\t'))
+		{
+			const char c = q[0] ;
+			q += 2 ;
+			if (c == 'v') // 'v x y z'
+			{
+				on_vertex(q, line_end) ;
+			}
+			else if (c == 'f') // 'f v1 v2 ... vn', possibly with texture and normal indices ('v/vt', 'v//vn' or 'v/vt/vn')
+			{
+				v_ids.clear() ;
+				vt_ids.clear() ;
+				index_t v_id ;
+				while (parse_int(q, line_end, v_id))
+				{
+					index_t vt_id = 0 ;
+					if (q < line_end && *q == '/')
+					{
+						++q ;
+						if (q < line_end && *q != '/' && !is_blank(*q))
+							parse_int(q, line_end, vt_id) ;
+						q = skip_token(q, line_end) ;
+					}
+					v_ids.push_back(v_id) ;
+					vt_ids.push_back(vt_id) ;
+				}
+				on_face(v_ids.data(), vt_ids.data(), int(v_ids.size())) ;
+			}
+			else if (c == 't') // 't crease 2/1/0 v0 v1 sharpness'
+			{
+				q = skip_blanks(q, line_end) ;
+				const char* type_end = skip_token(q, line_end) ;
+				if (type_end - q == 6 && std::memcmp(q, "crease", 6) == 0)
+				{
+					q = skip_token(skip_blanks(type_end, line_end), line_end) ;
+					index_t v0 = 0, v1 = 0 ;
+					parse_int(q, line_end, v0) ;
+					parse_int(q, line_end, v1) ;
+					const float sharpness = parse_float(q, line_end) ;
+					on_crease(v0, v1, sharpness) ;
+				}
+			}
+		}
+		p = line_end + 1 ;
+	}
+}
+
+std::vector<Mesh::ObjChunk>
+Mesh::split_obj_chunks(const char* begin, const char* end)
+{
+	// a few chunks per thread for load balancing, but not too small
+	const size_t size = end - begin ;
+	const size_t min_chunk_size = 1 << 16 ;
+	const size_t chunk_count = std::max(size_t(1), std::min(size_t(8 * omp_get_max_threads()), size / min_chunk_size)) ;
+
+	std::vector<ObjChunk> chunks ;
+	const char* chunk_begin = begin ;
+	for (size_t i = 1 ; i <= chunk_count && chunk_begin < end ; ++i)
+	{
+		const char* chunk_end = end ;
+		if (i < chunk_count)
+		{
+			// align on the next line
+			chunk_end = std::max(chunk_begin, begin + size * i / chunk_count) ;
+			const void* newline = std::memchr(chunk_end, '\n', end - chunk_end) ;
+			chunk_end = newline ? static_cast<const char*>(newline) + 1 : end ;
+		}
+
+		ObjChunk chunk ;
+		chunk.begin = chunk_begin ;
+		chunk.end = chunk_end ;
+		chunks.push_back(chunk) ;
+		chunk_begin = chunk_end ;
+	}
+	return chunks ;
+}
+
+void
+Mesh::read_obj_chunk_size(ObjChunk& chunk)
+{
+	parse_obj_lines(chunk.begin, chunk.end,
+					[&](const char*, const char*) { chunk.v_count++ ; },
+					[&](const char*, const char*) { chunk.t_count++ ; },
+					[&](const index_t*, const index_t*, int n) { chunk.f_count++ ; chunk.h_count += n ; },
+					[&](index_t, index_t, float) { chunk.c_count++ ; }) ;
+}
+
+void
+Mesh::read_obj_chunk_data(const ObjChunk& chunk, crease_buffer& crease_tags, uv_buffer& texcoords, std::vector<index_t>& texcoord_ids)
+{
+	halfedge_buffer_cage& He_cage = this->halfedges_cage ;
+	halfedge_buffer& He = this->halfedges ;
+	vertex_buffer& Vx = this->vertices ;
+
+	index_t v = chunk.v_first ;
+	index_t f = chunk.f_first ;
+	index_t h = chunk.h_first ;
+	index_t c = chunk.c_first ;
+	index_t t = chunk.t_first ;
+
+	auto on_vertex = [&](const char* p, const char* end)
+	{
+		for (int i = 0 ; i < 3 ; ++i)
+		{
+			Vx[v][i] = parse_float(p, end) ;
+		}
+		++v ;
+	} ;
+
+	auto on_texcoord = [&](const char* p, const char* end)
+	{
+		for (int i = 0 ; i < 2 ; ++i)
+		{
+			texcoords[t][i] = parse_float(p, end) ;
+		}
+		++t ;
+	} ;
+
+	auto on_face = [&](const index_t* v_ids, const index_t* vt_ids, int n)
+	{
+		for (int i = 0 ; i < n; ++i)
+		{
+			index_t next = h + 1 ;
+			if (i == n-1)
+				next -= n ;
+
+			index_t prev = h - 1 ;
+			if (i == 0)
+				prev += n ;
+
+			He[h].Twin = -1 ; // undetermined at this time
+			He[h].Vert = v_ids[i] - 1 ; // obj is 1-based.
+			He[h].Edge = -1 ; // undetermined at this time
+			He_cage[h].Next = next ;
+			He_cage[h].Prev = prev ;
+			He_cage[h].Face = f ;
+			if (!texcoord_ids.empty())
+				texcoord_ids[h] = vt_ids[i] ;
+
+			++h ;
+		}
+		++f ;
+	} ;
+
+	auto on_crease = [&](index_t v0, index_t v1, float sharpness)
+	{
+		// temporary storage
+		Crease& cr = crease_tags[c] ;
+		cr.Sharpness = sharpness ;
+		cr.Next = v0 ;
+		cr.Prev = v1 ;
+		++c ;
+	} ;
+
+	parse_obj_lines(chunk.begin, chunk.end, on_vertex, on_texcoord, on_face, on_crease) ;
+}
+
+const std::vector<std::pair<std::string, double>>&
+Mesh::get_load_timings() const
+{
+	return load_timings ;
+}
+
+bool
+Mesh::has_normals() const
+{
+	return !vertices.empty() && normals.size() == vertices.size() ;
+}
+
+const std::vector<vec3>&
+Mesh::get_vertices() const
+{
+	return vertices ;
+}
+
+const std::vector<vec3>&
+Mesh::get_normals() const
+{
+	return normals ;
+}
+
+const std::vector<vec3>&
+Mesh::get_tangents() const
+{
+	return tangents ;
+}
+
+bool
+Mesh::has_uvs() const
+{
+	return !halfedges.empty() && uvs.size() == halfedges.size() ;
+}
+
+const std::vector<vec2>&
+Mesh::get_uvs() const
+{
+	return uvs ;
+}
+
+bool
+Mesh::add_vertex_attribute(const std::string& name, int width, const std::vector<float>& values)
+{
+	const int width_old = vertex_attribute_width() ;
+	if (width <= 0 || width_old + width > max_vertex_attribute_width)
+	{
+		std::cerr << "ERROR Mesh::add_vertex_attribute: " << name << " would take the vertex attributes to " << width_old + width << " floats per vertex, out of [1, " << max_vertex_attribute_width << "]" << std::endl ;
+		return false ;
+	}
+
+	if (values.size() != size_t(width) * vertices.size())
+	{
+		std::cerr << "ERROR Mesh::add_vertex_attribute: " << name << " has " << values.size() << " values instead of " << width << " per vertex" << std::endl ;
+		return false ;
+	}
+
+	for (const Vertex_attribute& attribute: vertex_attributes)
+	{
+		if (attribute.name == name)
+		{
+			std::cerr << "ERROR Mesh::add_vertex_attribute: the mesh already has an attribute " << name << std::endl ;
+			return false ;
+		}
+	}
+
+	// the floats of the new attribute follow those of the previous ones, for each vertex
+	const index_t v_count = vertices.size() ;
+	const int width_new = width_old + width ;
+	std::vector<float> attributes_new(size_t(width_new) * v_count) ;
+	_PARALLEL_FOR
+	for (index_t v = 0 ; v < v_count ; ++v)
+	{
+		for (int i = 0 ; i < width_old ; ++i)
+			attributes_new[width_new * v + i] = attributes[width_old * v + i] ;
+		for (int i = 0 ; i < width ; ++i)
+			attributes_new[width_new * v + width_old + i] = values[width * v + i] ;
+	}
+	_BARRIER
+
+	attributes.swap(attributes_new) ;
+	vertex_attributes.push_back({name, width_old, width}) ;
+	return true ;
+}
+
+bool
+Mesh::get_vertex_attribute(const std::string& name, std::vector<float>& values) const
+{
+	const auto attribute = std::find_if(vertex_attributes.begin(), vertex_attributes.end(), [&](const Vertex_attribute& a) { return a.name == name ; }) ;
+	if (attribute == vertex_attributes.end() || !has_vertex_attributes())
+	{
+		std::cerr << "ERROR Mesh::get_vertex_attribute: the mesh has no attribute " << name << std::endl ;
+		return false ;
+	}
+
+	const index_t v_count = vertices.size() ;
+	const int stride = vertex_attribute_width() ;
+	const int offset = attribute->offset ;
+	const int width = attribute->width ;
+	values.resize(size_t(width) * v_count) ;
+	_PARALLEL_FOR
+	for (index_t v = 0 ; v < v_count ; ++v)
+	{
+		for (int i = 0 ; i < width ; ++i)
+			values[width * v + i] = attributes[stride * v + offset + i] ;
+	}
+	_BARRIER
+
+	return true ;
+}
+
+bool
+Mesh::has_vertex_attributes() const
+{
+	return !vertex_attributes.empty() && attributes.size() == size_t(vertex_attribute_width()) * vertices.size() ;
+}
+
+int
+Mesh::vertex_attribute_width() const
+{
+	return vertex_attributes.empty() ? 0 : vertex_attributes.back().offset + vertex_attributes.back().width ;
+}
+
+const std::vector<Mesh::Vertex_attribute>&
+Mesh::get_vertex_attributes() const
+{
+	return vertex_attributes ;
+}
+
+void
+Mesh::set_uvs(const uv_buffer& texcoords, const std::vector<index_t>& texcoord_ids)
+{
+	const index_t t_count = texcoords.size() ;
+	if (t_count == 0)
+		return ;
+
+	bool valid = true ;
+	_PARALLEL_FOR_REDUCTION(&&, valid)
+	for (index_t h = 0 ; h < H_count ; ++h)
+	{
+		valid = valid && texcoord_ids[h] > 0 && texcoord_ids[h] <= t_count ;
+	}
+	_BARRIER
+
+	if (!valid)
+	{
+		std::cerr << "ERROR Mesh::set_uvs: some face corners have no valid texture coordinate, UVs are ignored" << std::endl ;
+		return ;
+	}
+
+	uvs.resize(H_count) ;
+	_PARALLEL_FOR
+	for (index_t h = 0 ; h < H_count ; ++h)
+	{
+		uvs[h] = texcoords[texcoord_ids[h] - 1] ; // obj is 1-based.
+	}
+	_BARRIER
+}
+
+void
+Mesh::record_load_timing(const std::string& step, timer::time_point& start)
+{
+	const timer::time_point stop = timer::now() ;
+	const duration elapsed = stop - start ;
+	load_timings.push_back(std::make_pair(step, elapsed.count())) ;
+	start = stop ;
+}
+
+void
+Mesh::read_from_obj(const MappedFile& file)
+{
+	timer::time_point start = timer::now() ;
+
+	// count elements of each chunk, in parallel
+	std::vector<ObjChunk> chunks = split_obj_chunks(file.begin(), file.end()) ;
+	const index_t chunk_count = chunks.size() ;
+	_PARALLEL_FOR
+	for (int i = 0 ; i < chunk_count ; ++i)
+	{
+		read_obj_chunk_size(chunks[i]) ;
+	}
+	_BARRIER
+
+	// position chunks in the buffers
+	index_t h_count = 0, v_count = 0, f_count = 0, c_count = 0, t_count = 0 ;
+	for (ObjChunk& chunk: chunks)
+	{
+		chunk.h_first = h_count ;
+		chunk.v_first = v_count ;
+		chunk.f_first = f_count ;
+		chunk.c_first = c_count ;
+		chunk.t_first = t_count ;
+		h_count += chunk.h_count ;
+		v_count += chunk.v_count ;
+		f_count += chunk.f_count ;
+		c_count += chunk.c_count ;
+		t_count += chunk.t_count ;
+	}
+
+	// set constants and alloc
+	this->H_count = h_count ;
+	this->V_count = v_count ;
+	this->F_count = f_count ;
+	halfedges.resize(H_count) ;
+	halfedges_cage.resize(H_count) ;
+	vertices.resize(V_count) ;
+	crease_buffer tmp_creases(c_count) ;
+	uv_buffer tmp_texcoords(t_count) ;
+	std::vector<index_t> tmp_texcoord_ids(t_count > 0 ? h_count : 0) ;
+
+	// set he and vx buffers, in parallel (texture coordinate indices are only stored if the file declares some)
+	_PARALLEL_FOR
+	for (int i = 0 ; i < chunk_count ; ++i)
+	{
+		read_obj_chunk_data(chunks[i], tmp_creases, tmp_texcoords, tmp_texcoord_ids) ;
+	}
+	_BARRIER
+	set_uvs(tmp_texcoords, tmp_texcoord_ids) ;
+	record_load_timing("Parsing", start) ;
+
+	// Twins
+	compute_and_set_twins() ;
+	record_load_timing("Twins", start) ;
+
+	// Edge
+	this->E_count = compute_and_set_edges() ;
+	record_load_timing("Edges", start) ;
+
+	// Creases
+	this->C_count = this->E_count ;
+	creases.resize(C_count) ;
+	set_creases(tmp_creases) ;
+	set_boundaries_sharp() ;
+	compute_and_set_crease_neighbors() ;
+	record_load_timing("Creases", start) ;
+}
+
+void
+Mesh::compute_and_set_twins()
+{
+	halfedge_buffer& He = this->halfedges ;
+
+	// count halfedges per bucket, a bucket being the smallest vertex of an edge
+	std::vector<index_t> bucket_offsets(V_count + 1, 0) ;
+	_PARALLEL_FOR
+	for (index_t h = 0 ; h < H_count ; ++h)
+	{
+		const index_t v_min = std::min(Vert(h), Vert(Next(h))) ;
+_ATOMIC
+		bucket_offsets[v_min]++ ;
+	}
+	_BARRIER
+	exclusive_scan_parallel(bucket_offsets) ;
+
+	// fill buckets with keys <2 * v_max + orientation, h>
+	typedef std::pair<index_t,index_t> twin_key ;
+	std::vector<twin_key> buckets(H_count) ;
+	std::vector<index_t> bucket_cursors(bucket_offsets) ;
+	_PARALLEL_FOR
+	for (index_t h = 0 ; h < H_count ; ++h)
+	{
+		const index_t vh = Vert(h) ;
+		const index_t vn = Vert(Next(h)) ;
+		const index_t v_min = std::min(vh, vn) ;
+		const index_t v_max = std::max(vh, vn) ;
+
+		index_t slot ;
+_ATOMIC_CAPTURE
+		slot = bucket_cursors[v_min]++ ;
+
+		buckets[slot] = twin_key(2 * v_max + (vh == v_min ? 0 : 1), h) ;
+	}
+	_BARRIER
+
+	// sort buckets, for the matching to be deterministic
+	_PARALLEL_FOR
+	for (index_t v = 0 ; v < V_count ; ++v)
+	{
+		std::sort(buckets.begin() + bucket_offsets[v], buckets.begin() + bucket_offsets[v + 1]) ;
+	}
+	_BARRIER
+
+	// the k-th halfedge <vh,vn> is the twin of the k-th halfedge <vn,vh>
+	_PARALLEL_FOR
+	for (index_t h = 0 ; h < H_count ; ++h)
+	{
+		const index_t vh = Vert(h) ;
+		const index_t vn = Vert(Next(h)) ;
+		const index_t v_min = std::min(vh, vn) ;
+		const index_t v_max = std::max(vh, vn) ;
+		const index_t key = 2 * v_max + (vh == v_min ? 0 : 1) ;
+		const index_t key_twin = key ^ 1 ;
+
+		// binary searches in the sorted bucket: halfedge ids are >= 0, so <key, -1> precedes the range of key
+		const auto begin = buckets.cbegin() + bucket_offsets[v_min] ;
+		const auto end = buckets.cbegin() + bucket_offsets[v_min + 1] ;
+		const auto key_begin = std::lower_bound(begin, end, twin_key(key, -1)) ;
+		const index_t rank = std::lower_bound(key_begin, end, twin_key(key, h)) - key_begin ;
+		const auto twin_begin = std::lower_bound(begin, end, twin_key(key_twin, -1)) ;
+
+		index_t h_twin = -1 ;
+		if (rank < end - twin_begin && twin_begin[rank].first == key_twin)
+			h_twin = twin_begin[rank].second ;
+
+		He[h].Twin = h_twin ;
+	}
+	_BARRIER
+}
+
+index_t
+Mesh::compute_and_set_edges()
+{
+	halfedge_buffer& He = this->halfedges;
+
+	// a halfedge owns its edge if it has no twin or a bigger twin:
+	// edges are numbered in the order of their owner halfedge
+	std::vector<index_t> edge_ids(H_count) ;
+	_PARALLEL_FOR
+	for (index_t h_id=0 ; h_id < H_count ; ++h_id)
+	{
+		const index_t twin_id = Twin(h_id) ;
+		edge_ids[h_id] = int(twin_id < 0 || twin_id > h_id) ;
+	}
+	_BARRIER
+
+	const index_t edge_count = exclusive_scan_parallel(edge_ids) ;
+
+	_PARALLEL_FOR
+	for (index_t h_id=0 ; h_id < H_count ; ++h_id)
+	{
+		const index_t twin_id = Twin(h_id) ;
+		const bool is_owner = twin_id < 0 || twin_id > h_id ;
+		He[h_id].Edge = is_owner ? edge_ids[h_id] : edge_ids[twin_id] ;
+	}
+	_BARRIER
+
+	return edge_count ;
+}
+
+void
+Mesh::set_creases(const Mesh::crease_buffer& list_of_creases)
+{
+	// index outgoing halfedges by vertex: the halfedges leaving v are
+	// vertex_halfedges[vertex_offsets[v]] to vertex_halfedges[vertex_offsets[v+1]-1]
+	std::vector<index_t> vertex_offsets(V_count + 1, 0) ;
+	_PARALLEL_FOR
+	for (index_t h = 0 ; h < H_count ; ++h)
+	{
+_ATOMIC
+		vertex_offsets[Vert(h)]++ ;
+	}
+	_BARRIER
+	exclusive_scan_parallel(vertex_offsets) ;
+
+	std::vector<index_t> vertex_halfedges(H_count) ;
+	std::vector<index_t> vertex_cursors(vertex_offsets) ;
+	_PARALLEL_FOR
+	for (index_t h = 0 ; h < H_count ; ++h)
+	{
+		index_t slot ;
+_ATOMIC_CAPTURE
+		slot = vertex_cursors[Vert(h)]++ ;
+
+		vertex_halfedges[slot] = h ;
+	}
+	_BARRIER
+
+	// resolve the edge of each crease tag from the one-ring of its first vertex
+	const index_t tag_count = list_of_creases.size() ;
+	std::vector<index_t> tag_edges(tag_count, -1) ;
+	_PARALLEL_FOR
+	for (index_t tag = 0 ; tag < tag_count ; ++tag)
+	{
+		const index_t v0 = list_of_creases[tag].Prev ;
+		const index_t v1 = list_of_creases[tag].Next ;
+		if (v0 < 0 || v0 >= V_count)
+			continue ;
+
+		for (index_t i = vertex_offsets[v0] ; i < vertex_offsets[v0 + 1] ; ++i)
+		{
+			const index_t h = vertex_halfedges[i] ;
+			if (Vert(Next(h)) == v1)
+			{
+				tag_edges[tag] = Edge(h) ;
+				break ;
+			}
+		}
+	}
+	_BARRIER
+
+	// apply tags in file order, such that the last tag of an edge prevails
+	crease_buffer& Cr = this->creases ;
+	for (index_t tag = 0 ; tag < tag_count ; ++tag)
+	{
+		const index_t e_id = tag_edges[tag] ;
+		if (e_id < 0)
+			continue ;
+
+		Crease& cr = Cr[e_id] ;
+		cr.Sharpness = list_of_creases[tag].Sharpness ;
+		cr.Next = e_id ;
+		cr.Prev = e_id ;
+	}
+}
+
+index_t
+Mesh::find_second_crease(index_t h) const
+{
+	index_t c_second = Edge(h) ;
+	for (index_t h_vx_it = Twin(Next(h)) ;
+		 h_vx_it != h ;
+		 h_vx_it = Twin(Next(h_vx_it)))
+	{
+		c_second = Edge(h_vx_it) ;
+		const int sharpness_second = creases[c_second].Sharpness ;
+		if (sharpness_second > _epsilon_)
+			return c_second ;
+	}
+
+	assert(false || !"Mesh::find_second_crease: preconditions not satisfied.") ;
+	return -1 ;
+}
+
+void
+Mesh::compute_and_set_crease_neighbors()
+{
+	crease_buffer& Cr = creases ;
+
+	// each crease is treated by a single halfedge and only writes its own neighbors
+	_PARALLEL_FOR
+	for (index_t h = 0 ; h < H_count ; ++h)
+	{
+		const index_t c = Edge(h) ;
+		const float sharpness = Cr[c].Sharpness ;
+		index_t h_vx_it ;
+
+		// only treat creases through their biggest halfedge_id
+		if (h < Twin(h) || sharpness < _epsilon_)
+			continue ;
+
+		// Compute prev
+		int prev_creases = 0 ;
+		index_t c_prev = c ;
+		for (h_vx_it = Next_safe(Twin(h));
+		     h_vx_it >= 0 && h_vx_it != h;
 		     h_vx_it = Next_safe(Twin(h_vx_it)))
 		{
 			float c_prev_sharpness = Cr[Edge(h_vx_it)].Sharpness ;
@@ -852,11 +1705,11 @@ Mesh::compute_and_set_crease_neighbors()
 			h_vx_it = Prev(h) ;
 			while(true)
 			{
-				int h_vx_it_twin = Twin(h_vx_it) ;
+				index_t h_vx_it_twin = Twin(h_vx_it) ;
 				if (h_vx_it_twin == h)
 					break ;
 
-				int c_id = Edge(h_vx_it) ;
+				index_t c_id = Edge(h_vx_it) ;
 				float c_prev_sharpness = Cr[c_id].Sharpness ;
 				if (c_prev_sharpness > _epsilon_)
 				{
@@ -876,14 +1729,14 @@ Mesh::compute_and_set_crease_neighbors()
 		}
 
 		// Compute next
-		int h_next = Next(h) ;
+		index_t h_next = Next(h) ;
 		int next_creases = 0 ;
-		int c_next = c ;
+		index_t c_next = c ;
 		for (h_vx_it = h_next;
 			 h_vx_it >= 0 && h_vx_it != Twin(h);
 		     h_vx_it = Next_safe(Twin(h_vx_it)))
 		{
-			int c_id = Edge(h_vx_it) ;
+			index_t c_id = Edge(h_vx_it) ;
 			float c_next_sharpness = Cr[c_id].Sharpness ;
 			if (c_next_sharpness > _epsilon_)
 			{
@@ -893,7 +1746,7 @@ Mesh::compute_and_set_crease_neighbors()
 		}
 		if (h_vx_it < 0) // go backwards
 		{
-			int h_vx_it_twin = Twin(h) ;
+			index_t h_vx_it_twin = Twin(h) ;
 			if (h_vx_it_twin >= 0)
 			{
 				h_vx_it = Prev(h_vx_it_twin) ;
@@ -902,7 +1755,7 @@ Mesh::compute_and_set_crease_neighbors()
 					if (h_vx_it == h)
 						break ;
 
-					int c_id = Edge(h_vx_it) ;
+					index_t c_id = Edge(h_vx_it) ;
 					float c_next_sharpness = Cr[c_id].Sharpness ;
 					if (c_next_sharpness > _epsilon_)
 					{
@@ -922,21 +1775,330 @@ Mesh::compute_and_set_crease_neighbors()
 			Cr[c].Next = c_next ;
 		}
 	}
+	_BARRIER
 }
 
 void
 Mesh::set_boundaries_sharp()
 {
-	for (int h = 0 ; h < H_count ; ++h)
+	_PARALLEL_FOR
+	for (index_t h = 0 ; h < H_count ; ++h)
 	{
 		if (Twin(h) < 0)
 		{
-			const int e = Edge(h) ;
+			const index_t e = Edge(h) ;
 			Crease& c = creases[e] ;
-			c.Sharpness = 16.0 ;
+			c.Sharpness = border_sharpness ;
 			c.Next = e ;
 			c.Prev = e ;
 		}
 	}
+	_BARRIER
 }
 
+
+// ----------- Cage reordering -----------
+void
+Mesh::reorder_cage(Cage_ordering ordering)
+{
+	if (C_count != E_count)
+	{
+		std::cerr << "ERROR Mesh::reorder_cage: the crease buffer does not span the edges" << std::endl ;
+		return ;
+	}
+
+	timer::time_point start = timer::now() ;
+
+	// first halfedge of each face
+	std::vector<index_t> face_halfedges(F_count, H_count) ;
+	for (index_t h = 0 ; h < H_count ; ++h)
+	{
+		index_t& h_first = face_halfedges[Face(h)] ;
+		h_first = std::min(h_first, h) ;
+	}
+
+	const std::vector<index_t> face_order = ordering == CAGE_ORDERING_RCM ? order_faces_rcm(face_halfedges) : order_faces_morton(face_halfedges) ;
+
+	// the halfedges of the new face i follow the ones of the faces before it
+	std::vector<index_t> face_offsets(F_count) ;
+	_PARALLEL_FOR
+	for (index_t i = 0 ; i < F_count ; ++i)
+	{
+		face_offsets[i] = n_vertex_of_polygon(face_halfedges[face_order[i]]) ;
+	}
+	_BARRIER
+	exclusive_scan_parallel(face_offsets) ;
+
+	std::vector<index_t> halfedge_map(H_count) ;
+	_PARALLEL_FOR
+	for (index_t i = 0 ; i < F_count ; ++i)
+	{
+		const index_t h_first = face_halfedges[face_order[i]] ;
+		index_t h_new = face_offsets[i] ;
+		index_t h = h_first ;
+		do
+		{
+			halfedge_map[h] = h_new++ ;
+			h = Next(h) ;
+		} while (h != h_first) ;
+	}
+	_BARRIER
+
+	// vertices are numbered in order of first use, then isolated ones
+	std::vector<index_t> halfedge_order(H_count) ;
+	_PARALLEL_FOR
+	for (index_t h = 0 ; h < H_count ; ++h)
+	{
+		halfedge_order[halfedge_map[h]] = h ;
+	}
+	_BARRIER
+
+	std::vector<index_t> vertex_map(V_count, -1) ;
+	index_t v_count = 0 ;
+	for (index_t h_new = 0 ; h_new < H_count ; ++h_new)
+	{
+		index_t& v_new = vertex_map[halfedges[halfedge_order[h_new]].Vert] ;
+		if (v_new < 0)
+			v_new = v_count++ ;
+	}
+	for (index_t v = 0 ; v < V_count ; ++v)
+	{
+		if (vertex_map[v] < 0)
+			vertex_map[v] = v_count++ ;
+	}
+
+	std::vector<index_t> face_map(F_count) ;
+	_PARALLEL_FOR
+	for (index_t i = 0 ; i < F_count ; ++i)
+	{
+		face_map[face_order[i]] = i ;
+	}
+	_BARRIER
+
+	// permute buffers (meshes of uniform faces have no cage halfedge buffer)
+	halfedge_buffer halfedges_old(H_count) ;
+	halfedge_buffer_cage halfedges_cage_old(halfedges_cage.size()) ;
+	vertex_buffer vertices_old(V_count) ;
+	uv_buffer uvs_old(uvs.size()) ;
+	halfedges_old.swap(halfedges) ;
+	halfedges_cage_old.swap(halfedges_cage) ;
+	vertices_old.swap(vertices) ;
+	uvs_old.swap(uvs) ;
+
+	const bool with_uvs = !uvs.empty() ;
+	_PARALLEL_FOR
+	for (index_t h = 0 ; h < H_count ; ++h)
+	{
+		const HalfEdge& he = halfedges_old[h] ;
+		const index_t h_new = halfedge_map[h] ;
+
+		halfedges[h_new].Twin = he.Twin < 0 ? -1 : halfedge_map[he.Twin] ;
+		halfedges[h_new].Vert = vertex_map[he.Vert] ;
+		if (with_uvs)
+			uvs[h_new] = uvs_old[h] ;
+	}
+	_BARRIER
+
+	const index_t h_cage_count = halfedges_cage.size() ;
+	_PARALLEL_FOR
+	for (index_t h = 0 ; h < h_cage_count ; ++h)
+	{
+		const HalfEdge_cage& he_cage = halfedges_cage_old[h] ;
+		const index_t h_new = halfedge_map[h] ;
+
+		halfedges_cage[h_new].Next = halfedge_map[he_cage.Next] ;
+		halfedges_cage[h_new].Prev = halfedge_map[he_cage.Prev] ;
+		halfedges_cage[h_new].Face = face_map[he_cage.Face] ;
+	}
+	_BARRIER
+
+	const int attribute_width = has_vertex_attributes() ? vertex_attribute_width() : 0 ;
+	std::vector<float> attributes_old(attributes.size()) ;
+	attributes_old.swap(attributes) ;
+	_PARALLEL_FOR
+	for (index_t v = 0 ; v < V_count ; ++v)
+	{
+		vertices[vertex_map[v]] = vertices_old[v] ;
+		for (int i = 0 ; i < attribute_width ; ++i)
+			attributes[attribute_width * vertex_map[v] + i] = attributes_old[attribute_width * v + i] ;
+	}
+	_BARRIER
+
+	// edges, and creases along them
+	compute_and_set_edges() ;
+
+	std::vector<index_t> edge_map(E_count) ;
+	_PARALLEL_FOR
+	for (index_t h = 0 ; h < H_count ; ++h)
+	{
+		edge_map[halfedges_old[h].Edge] = halfedges[halfedge_map[h]].Edge ;
+	}
+	_BARRIER
+
+	crease_buffer creases_old(C_count) ;
+	creases_old.swap(creases) ;
+	_PARALLEL_FOR
+	for (index_t c = 0 ; c < C_count ; ++c)
+	{
+		Crease& crease = creases[edge_map[c]] ;
+		crease.Sharpness = creases_old[c].Sharpness ;
+		crease.Next = edge_map[creases_old[c].Next] ;
+		crease.Prev = edge_map[creases_old[c].Prev] ;
+	}
+	_BARRIER
+
+	record_load_timing("Reordering", start) ;
+}
+
+std::vector<index_t>
+Mesh::order_faces_morton(const std::vector<index_t>& face_halfedges) const
+{
+	vec3 p_min = vertices.empty() ? vec3() : vertices[0] ;
+	vec3 p_max = p_min ;
+	for (const vec3& p: vertices)
+	{
+		for (int k = 0 ; k < 3 ; ++k)
+		{
+			p_min[k] = std::min(p_min[k], p[k]) ;
+			p_max[k] = std::max(p_max[k], p[k]) ;
+		}
+	}
+
+	// 21 bits per coordinate, interleaved
+	typedef std::pair<uint64_t,index_t> face_key ;
+	std::vector<face_key> keys(F_count) ;
+	_PARALLEL_FOR
+	for (index_t f = 0 ; f < F_count ; ++f)
+	{
+		vec3 centroid ;
+		int n = 0 ;
+		index_t h = face_halfedges[f] ;
+		do
+		{
+			centroid = centroid + vertices[halfedges[h].Vert] ;
+			++n ;
+			h = Next(h) ;
+		} while (h != face_halfedges[f]) ;
+		centroid = centroid / float(n) ;
+
+		uint64_t code = 0 ;
+		for (int k = 0 ; k < 3 ; ++k)
+		{
+			const float extent = p_max[k] - p_min[k] ;
+			const float t = extent > 0.f ? (centroid[k] - p_min[k]) / extent : 0.f ;
+			const uint64_t q = std::min(uint64_t(t * float(1 << 21)), (uint64_t(1) << 21) - 1) ;
+			for (int b = 0 ; b < 21 ; ++b)
+				code |= ((q >> b) & 1) << (3 * b + k) ;
+		}
+		keys[f] = face_key(code, f) ;
+	}
+	_BARRIER
+
+	std::sort(keys.begin(), keys.end()) ;
+
+	std::vector<index_t> face_order(F_count) ;
+	for (index_t i = 0 ; i < F_count ; ++i)
+		face_order[i] = keys[i].second ;
+	return face_order ;
+}
+
+std::vector<index_t>
+Mesh::order_faces_rcm(const std::vector<index_t>& face_halfedges) const
+{
+	// degree of each face in the graph of faces sharing an edge
+	std::vector<int> degrees(F_count, 0) ;
+	_PARALLEL_FOR
+	for (index_t f = 0 ; f < F_count ; ++f)
+	{
+		index_t h = face_halfedges[f] ;
+		do
+		{
+			degrees[f] += int(halfedges[h].Twin >= 0) ;
+			h = Next(h) ;
+		} while (h != face_halfedges[f]) ;
+	}
+	_BARRIER
+
+	const auto by_degree = [&degrees](index_t f0, index_t f1) { return degrees[f0] < degrees[f1] || (degrees[f0] == degrees[f1] && f0 < f1) ; } ;
+
+	// each connected component is traversed breadth-first from one of its faces of minimal degree
+	std::vector<index_t> roots(F_count) ;
+	for (index_t f = 0 ; f < F_count ; ++f)
+		roots[f] = f ;
+	std::sort(roots.begin(), roots.end(), by_degree) ;
+
+	std::vector<index_t> face_order ;
+	face_order.reserve(F_count) ;
+	std::vector<bool> visited(F_count, false) ;
+	std::vector<index_t> neighbors ;
+	for (index_t root: roots)
+	{
+		if (visited[root])
+			continue ;
+
+		visited[root] = true ;
+		face_order.push_back(root) ;
+		for (size_t i = face_order.size() - 1 ; i < face_order.size() ; ++i)
+		{
+			// visit unvisited neighbors by increasing degree
+			const index_t f = face_order[i] ;
+			neighbors.clear() ;
+			index_t h = face_halfedges[f] ;
+			do
+			{
+				const index_t h_twin = halfedges[h].Twin ;
+				if (h_twin >= 0 && !visited[Face(h_twin)])
+				{
+					visited[Face(h_twin)] = true ;
+					neighbors.push_back(Face(h_twin)) ;
+				}
+				h = Next(h) ;
+			} while (h != face_halfedges[f]) ;
+
+			std::sort(neighbors.begin(), neighbors.end(), by_degree) ;
+			face_order.insert(face_order.end(), neighbors.begin(), neighbors.end()) ;
+		}
+	}
+
+	std::reverse(face_order.begin(), face_order.end()) ;
+	return face_order ;
+}
+
+index_t
+Mesh::estimate_cache_misses() const
+{
+	const int line_bits = 6 ;
+	const int set_count = 64 ;
+	const int way_count = 8 ;
+
+	// each set lists the lines it holds, most recently used first
+	std::vector<uintptr_t> sets(set_count * way_count, ~uintptr_t(0)) ;
+	index_t miss_count = 0 ;
+	const auto access = [&](const void* address)
+	{
+		const uintptr_t line = reinterpret_cast<uintptr_t>(address) >> line_bits ;
+		uintptr_t* ways = &sets[(line % set_count) * way_count] ;
+		int w = 0 ;
+		while (w < way_count - 1 && ways[w] != line)
+			++w ;
+		miss_count += int(ways[w] != line) ;
+		for ( ; w > 0 ; --w)
+			ways[w] = ways[w - 1] ;
+		ways[0] = line ;
+	} ;
+
+	for (index_t h = 0 ; h < H_count ; ++h)
+	{
+		const HalfEdge& he = halfedges[h] ;
+		access(&he) ;
+		if (size_t(h) < halfedges_cage.size())
+			access(&halfedges_cage[h]) ;
+		if (he.Twin >= 0)
+			access(&halfedges[he.Twin]) ;
+		access(&vertices[he.Vert]) ;
+		if (he.Edge < C_count)
+			access(&creases[he.Edge]) ;
+	}
+
+	return miss_count ;
+}
@@ -2,16 +2,19 @@
 #define __MESH_H__
 
 #include <vector>
-#include <map>
+#include <algorithm>
 #include <cmath>
 #include <assert.h>
 #include <iostream>
 #include <fstream>
-#include <sstream>
 
+#include "vec2.h"
 #include "vec3.h"
 #include "halfedge.h"
+#include "topology.h"
 #include "crease.h"
+#include "sharpness.h"
+#include "vertex_config.h"
 #include "utils.h"
 #include <array>
 #include <cmath>
@@ -24,31 +27,67 @@
  * - the mesh topology as a buffer of HalfEdge (and HalfEdge_cage)
  * - the mesh geometry as a buffer of vec3 coordinates
  * - the mesh creases as a buffer of Crease
+ * - optionally, a normal and a tangent per vertex, as buffers of vec3
+ * - optionally, face-varying UV coordinates, as a buffer of vec2 indexed by halfedge (the UV of its face at its vertex)
+ * - optionally, vertex attributes (e.g., colors, skin weights), as a buffer of floats with the same number of floats per vertex
  */
+class MappedFile ;
+
 class Mesh
 {
 protected:
 	typedef std::vector<HalfEdge_cage> halfedge_buffer_cage ;	/*!< defines type for a buffer of HalfEdge_cage */
 	typedef std::vector<HalfEdge> halfedge_buffer ;				/*!< defines type for a buffer of HalfEdge */
 	typedef std::vector<vec3> vertex_buffer ;					/*!< defines type for a buffer of vec3 */
+	typedef std::vector<vec2> uv_buffer ;						/*!< defines type for a buffer of vec2 */
 	typedef std::vector<Crease> crease_buffer ;					/*!< defines type for a buffer of Crease */
+	typedef std::vector<VertexConfig> vertex_config_buffer ;	/*!< defines type for a buffer of VertexConfig */
+
+	typedef std::chrono::high_resolution_clock timer;
+	typedef std::chrono::duration<double, std::milli> duration;
 
-	int H_count ; /*!< halfedge counter represents the number of halfedges of the Mesh */
-	int V_count ; /*!< vertex counter represents the number of vertices of the Mesh */
-	int E_count ; /*!< edge counter represents the number of edges of the Mesh */
-	int F_count ; /*!< face counter represents the number of faces of the Mesh */
-	int C_count ; /*!< crease counter represents the number of creases of the Mesh */
+	index_t H_count ; /*!< halfedge counter represents the number of halfedges of the Mesh */
+	index_t V_count ; /*!< vertex counter represents the number of vertices of the Mesh */
+	index_t E_count ; /*!< edge counter represents the number of edges of the Mesh */
+	index_t F_count ; /*!< face counter represents the number of faces of the Mesh */
+	index_t C_count ; /*!< crease counter represents the number of creases of the Mesh */
+	bool loaded ; /*!< true if the mesh was read from its file (see #is_loaded) */
 
 	halfedge_buffer_cage halfedges_cage ; /*!< HalfEdge_cage buffer */
 	halfedge_buffer halfedges ; /*!< HalfEdge buffer */
 	vertex_buffer vertices ; /*!< vec3 buffer */
 	crease_buffer creases ; /*!< Crease buffer */
+	vertex_buffer normals ; /*!< vec3 buffer of unit normals, one per vertex, or empty if the mesh has none (see Mesh_Subdiv_CPU::set_limit_projection) */
+	vertex_buffer tangents ; /*!< vec3 buffer of unit tangents, one per vertex, or empty if the mesh has none */
+	uv_buffer uvs ; /*!< vec2 buffer of UV coordinates, one per halfedge (i.e., per face corner), or empty if the mesh has none */
+	std::vector<float> attributes ; /*!< float buffer of the vertex attributes, #vertex_attribute_width floats per vertex (the floats of each attribute, one attribute after the other), or empty if the mesh has none */
+
+	static constexpr float border_sharpness = 16.0f ; /*!< sharpness given to border edges at load */
+
+	std::vector<std::pair<std::string, double>> load_timings ; /*!< runtime (in ms) of each step of the mesh construction */
+
+public:
+	/**
+	 * @brief The Vertex_attribute struct describes a vertex attribute: a named group of floats within the floats of each vertex in the attribute buffer
+	 */
+	struct Vertex_attribute
+	{
+		std::string name ; /*!< name of the attribute */
+		int offset ; /*!< index of its first float among the floats of a vertex */
+		int width ; /*!< number of floats of the attribute */
+	};
+
+	static const int max_vertex_attribute_width = 13 ; /*!< maximum number of floats of all the vertex attributes of a vertex, such that subdivision refines them with the positions as 16 floats per vertex (see Mesh_Subdiv_CPU::packed_vertex_width) */
+
+protected:
+	std::vector<Vertex_attribute> vertex_attributes ; /*!< the vertex attributes, in the order of their floats */
 
 public:
 	// ----------- Constructor/destructor -----------
 	/**
-	 * @brief Mesh constructor from OBJ file
-	 * @param filename path to an OBJ file
+	 * @brief Mesh constructor from file
+	 * @param filename path to an OBJ file, or to a binary cage file written by export_to_cage (detected from its header)
+	 * @post If the file cannot be read, the mesh is empty and #is_loaded is false.
 	 */
 	Mesh(const std::string& filename) ;
 	virtual ~Mesh() = default ;
@@ -60,7 +99,7 @@ public:
 	 * @pre depth should be <= 0 when called on base Mesh class.
 	 * @return the number of halfedges if the mesh gets subdivided to depth.
 	 */
-	virtual int H(int depth = -1) const ;
+	virtual index_t H(int depth = -1) const ;
 
 	/**
 	 * @brief V counts the number of vertices at a given subdivision depth.
@@ -68,7 +107,7 @@ public:
 	 * @pre depth should be <= 0 when called on base Mesh class.
 	 * @return the number of vertices if the mesh gets subdivided to depth.
 	 */
-	virtual int V(int depth = -1) const ;
+	virtual index_t V(int depth = -1) const ;
 
 	/**
 	 * @brief F counts the number of faces at a given subdivision depth.
@@ -76,7 +115,7 @@ public:
 	 * @pre depth should be <= 0 when called on base Mesh class.
 	 * @return the number of faces if the mesh gets subdivided to depth.
 	 */
-	virtual int F(int depth = -1) const ;
+	virtual index_t F(int depth = -1) const ;
 
 	/**
 	 * @brief E counts the number of edges at a given subdivision depth.
@@ -84,7 +123,7 @@ public:
 	 * @pre depth should be <= 0 when called on base Mesh class.
 	 * @return the number of edges if the mesh gets subdivided to depth.
 	 */
-	virtual int E(int depth = -1) const ;
+	virtual index_t E(int depth = -1) const ;
 
 	/**
 	 * @brief C counts the number of creases at a given subdivision depth.
@@ -92,7 +131,7 @@ public:
 	 * @pre depth should be <= 0 when called on base Mesh class.
 	 * @return the number of creases if the mesh gets subdivided to depth.
 	 */
-	virtual int C(int depth = -1) const ;
+	virtual index_t C(int depth = -1) const ;
 
 	// ----------- Public member functions for mesh inspection -----------
 	/**
@@ -107,7 +146,7 @@ public:
 	 * @brief count_border_edges counts the amount of border edges (thus halfedges) in the mesh.
 	 * @return the border edge counter.
 	 */
-	int count_border_edges() const ;
+	index_t count_border_edges() const ;
 
 	/**
 	 * @brief count_sharp_creases counts the amount of edges that are sharp creases.
@@ -115,7 +154,20 @@ public:
 	 * and is sharp (i.e., its sharpness value is >0).
 	 * @return the sharp crease counter.
 	 */
-	int count_sharp_creases() const ;
+	index_t count_sharp_creases() const ;
+
+	/**
+	 * @brief has_border_creases_only determines if the only sharp edges of the mesh are its borders, with the sharpness given at load.
+	 * Such meshes need no crease buffer: their edge sharpnesses follow from the topology down to depth #border_sharpness.
+	 * @return true if and only if border edges have sharpness #border_sharpness and all other edges are smooth.
+	 */
+	bool has_border_creases_only() const ;
+
+	/**
+	 * @brief is_loaded verifies if the constructor read the mesh from its file
+	 * @return false if the file could not be opened, or is a cage file this build cannot read, in which case the mesh is empty
+	 */
+	bool is_loaded() const ;
 
 	/**
 	 * @brief is_tri_only verifies if all polygons are triangles
@@ -132,10 +184,144 @@ public:
 	/**
 	 * @brief export_to_obj writes the current mesh to an OBJ file
 	 * @param filename path to a file (that will be overwritten).
-	 * @post Only topology and geometry is written to file: creases are not!
+	 * @post Only topology, geometry and normals (if any) are written to file: creases are not!
 	 */
 	void export_to_obj(const std::string& filename) const ;
 
+	/**
+	 * @brief export_to_cage writes the mesh buffers as-is to a binary cage file, which loads without any parsing nor topology computation
+	 * @param filename path to a file (that will be overwritten).
+	 * If the mesh is subdivided, its current (i.e., finest) level is written.
+	 * @post The file is only readable by builds sharing the same memory layout (index width, endianness): others reject it.
+	 */
+	void export_to_cage(const std::string& filename) const ;
+
+	/**
+	 * @brief export_to_ply writes the current mesh to a binary little-endian PLY file
+	 * @param filename path to a file (that will be overwritten).
+	 * @post Only topology, geometry, normals (if any, as nx, ny and nz vertex properties) and vertex attributes (if any, as float vertex properties named after them, suffixed with the index of the float if they have several) are written to file: creases are not!
+	 * Face vertex counts are written as uchar, or as uint if a face has more than 255 vertices.
+	 */
+	void export_to_ply(const std::string& filename) const ;
+
+	/**
+	 * @brief export_to_dump writes the halfedge, vertex and crease buffers of the current mesh as-is to a raw dump file (see DumpFileHeader)
+	 * @param filename path to a file (that will be overwritten).
+	 */
+	void export_to_dump(const std::string& filename) const ;
+
+	/**
+	 * @brief export_quads_to_obj writes quads given by their vertices to an OBJ file, as export_to_obj writes a mesh
+	 * @param filename path to a file (that will be overwritten).
+	 * @param vertices vertex buffer
+	 * @param quads vertex indices, 4 per quad
+	 */
+	static void export_quads_to_obj(const std::string& filename, const std::vector<vec3>& vertices, const std::vector<index_t>& quads) ;
+
+	/**
+	 * @brief export_quads_to_ply writes quads given by their vertices to a binary little-endian PLY file, as export_to_ply writes a mesh
+	 * @param filename path to a file (that will be overwritten).
+	 * @param vertices vertex buffer
+	 * @param quads vertex indices, 4 per quad
+	 */
+	static void export_quads_to_ply(const std::string& filename, const std::vector<vec3>& vertices, const std::vector<index_t>& quads) ;
+
+	/**
+	 * @brief get_load_timings gives the runtime of each step of the mesh construction (e.g., parsing, twin computation)
+	 * @return a list of (step name, runtime in milliseconds) pairs, in order of execution
+	 */
+	const std::vector<std::pair<std::string, double>>& get_load_timings() const ;
+
+	/**
+	 * @brief get_vertices gives the position of each vertex: those of the cage, or of depth d_max once subdivided (e.g., by Mesh_Subdiv_CPU::subdivide_vertices)
+	 */
+	const std::vector<vec3>& get_vertices() const ;
+
+	/**
+	 * @brief has_normals tells if the mesh stores a normal and a tangent per vertex (e.g., limit normals, see Mesh_Subdiv_CPU::set_limit_projection)
+	 */
+	bool has_normals() const ;
+
+	/**
+	 * @brief get_normals gives the unit normal of each vertex, or an empty buffer (see #has_normals)
+	 */
+	const std::vector<vec3>& get_normals() const ;
+
+	/**
+	 * @brief get_tangents gives a unit tangent of each vertex, orthogonal to its normal, or an empty buffer (see #has_normals)
+	 */
+	const std::vector<vec3>& get_tangents() const ;
+
+	/**
+	 * @brief has_uvs tells if the mesh stores a UV coordinate per halfedge (read from the 'vt' records of OBJ files)
+	 */
+	bool has_uvs() const ;
+
+	/**
+	 * @brief get_uvs gives the UV coordinate of each halfedge, at its vertex, or an empty buffer (see #has_uvs)
+	 */
+	const std::vector<vec2>& get_uvs() const ;
+
+	/**
+	 * @brief add_vertex_attribute appends an attribute to the vertices of the mesh, which subdivision then refines with the vertex rules, along with the positions.
+	 * Values interpolate as positions do: they are smoothed, and sharp creases and borders interpolate them along the creases.
+	 * @pre the mesh is not subdivided
+	 * @param name the name of the attribute, unique to the mesh
+	 * @param width the number of floats of the attribute (e.g., 3 for RGB colors)
+	 * @param values width floats per vertex, in vertex order
+	 * @return false (with error notification) if the attribute cannot be added
+	 */
+	bool add_vertex_attribute(const std::string& name, int width, const std::vector<float>& values) ;
+
+	/**
+	 * @brief get_vertex_attribute gives the values of a vertex attribute
+	 * @param name the name of the attribute
+	 * @param values output width floats per vertex, in vertex order
+	 * @return false (with error notification) if the mesh has no such attribute
+	 */
+	bool get_vertex_attribute(const std::string& name, std::vector<float>& values) const ;
+
+	/**
+	 * @brief has_vertex_attributes tells if the mesh stores vertex attributes (see #add_vertex_attribute)
+	 */
+	bool has_vertex_attributes() const ;
+
+	/**
+	 * @brief vertex_attribute_width gives the number of floats of all the vertex attributes of a vertex
+	 */
+	int vertex_attribute_width() const ;
+
+	/**
+	 * @brief get_vertex_attributes describes the vertex attributes of the mesh
+	 */
+	const std::vector<Vertex_attribute>& get_vertex_attributes() const ;
+
+	// ----------- Cage reordering -----------
+	/**
+	 * @brief The Cage_ordering enum lists the face orders available to #reorder_cage.
+	 */
+	enum Cage_ordering
+	{
+		CAGE_ORDERING_MORTON,	/*!< faces sorted along a Morton (Z-order) curve through their centroids */
+		CAGE_ORDERING_RCM		/*!< faces in reverse Cuthill-McKee order of their adjacency graph, which reduces its bandwidth */
+	};
+
+	/**
+	 * @brief reorder_cage renumbers the faces of the mesh in the given order, and its vertices in the order in which these faces first use them.
+	 * All depths derive their indices from the ones of the cage, so a cage with good locality gives subdivision kernels good locality at all depths.
+	 * The halfedges of each face remain contiguous and in the same cyclic order, and edges (hence creases) are renumbered in the order of their owner halfedge, as at load.
+	 * @pre the mesh is not subdivided, and has a crease per edge (as after loading)
+	 * @param ordering the face order
+	 */
+	virtual void reorder_cage(Cage_ordering ordering) ;
+
+	/**
+	 * @brief estimate_cache_misses counts the misses of a simulated cache (32 KiB, 8-way, 64-byte lines, LRU, as an L1 data cache)
+	 * on the accesses of a pass over the halfedges that reads, for each halfedge, its attributes, its twin, its vertex and its crease, as the refinement kernels do.
+	 * @return the number of cache misses
+	 */
+	index_t estimate_cache_misses() const ;
+
 	// ----------- Accessors for halfedge and crease values from specified buffers -----------
 protected:
 	/**
@@ -144,7 +330,7 @@ protected:
 	 * @param h index to access
 	 * @return index to the twin halfedge (which can be negative in case there is no Twin)
 	 */
-	virtual int Twin(const halfedge_buffer& buffer, int h) const final ;
+	virtual index_t Twin(const halfedge_buffer& buffer, index_t h) const final ;
 
 	/**
 	 * @brief Vert accessor for the vertex attribute of the vertex buffer
@@ -152,7 +338,7 @@ protected:
 	 * @param h index to access
 	 * @return index to the vertex the halfedge departs from
 	 */
-	virtual int Vert(const halfedge_buffer& buffer, int h) const final ;
+	virtual index_t Vert(const halfedge_buffer& buffer, index_t h) const final ;
 
 	/**
 	 * @brief Edge accessor for the edge attribute
@@ -160,7 +346,7 @@ protected:
 	 * @param h index to access
 	 * @return the index of the edge spanning the halfedge
 	 */
-	virtual int Edge(const halfedge_buffer& buffer, int h) const final ;
+	virtual index_t Edge(const halfedge_buffer& buffer, index_t h) const final ;
 
 	/**
 	 * @brief Prev accessor for the previous halfedge attribute
@@ -168,7 +354,7 @@ protected:
 	 * @param h index to access
 	 * @return the index of the previous halfedge within the face
 	 */
-	virtual int Prev(const halfedge_buffer_cage& buffer, int h) const ;
+	virtual index_t Prev(const halfedge_buffer_cage& buffer, index_t h) const ;
 
 	/**
 	 * @brief Next accessor for the next halfedge attribute
@@ -176,7 +362,7 @@ protected:
 	 * @param h index to access
 	 * @return the index of the next halfedge within the face
 	 */
-	virtual int Next(const halfedge_buffer_cage& buffer, int h) const ;
+	virtual index_t Next(const halfedge_buffer_cage& buffer, index_t h) const ;
 
 	/**
 	 * @brief Face accessor for the face index of the halfedge
@@ -184,7 +370,7 @@ protected:
 	 * @param h index of a halfedge to access
 	 * @return the index of the face the halfedge lives in
 	 */
-	virtual int Face(const halfedge_buffer_cage& buffer, int h) const ;
+	virtual index_t Face(const halfedge_buffer_cage& buffer, index_t h) const ;
 
 	/**
 	 * @brief Sharpness accessor for the sharpness value of a crease
@@ -192,7 +378,7 @@ protected:
 	 * @param c index into the crease buffer (or higher)
 	 * @return the sharpness value, or 0 if index c is not a crease.
 	 */
-	virtual float Sharpness(const crease_buffer& buffer, int c) const final ;
+	virtual float Sharpness(const crease_buffer& buffer, index_t c) const final ;
 
 	/**
 	 * @brief NextC accessor for a crease's next crease.
@@ -200,7 +386,7 @@ protected:
 	 * @param c index into the crease buffer (or higher)
 	 * @return the next crease index
 	 */
-	virtual int NextC(const crease_buffer& buffer, int c) const final ;
+	virtual index_t NextC(const crease_buffer& buffer, index_t c) const final ;
 
 	/**
 	 * @brief PrevC accessor for a crease's previous crease.
@@ -208,7 +394,7 @@ protected:
 	 * @param c index into the crease buffer (or higher)
 	 * @return the previous crease index
 	 */
-	virtual int PrevC(const crease_buffer& buffer, int c) const final ;
+	virtual index_t PrevC(const crease_buffer& buffer, index_t c) const final ;
 
 	// ----------- utility functions for evaluating local configurations -----------
 protected:
@@ -217,7 +403,13 @@ protected:
 	 * @param h the index of a halfedge of the polygon
 	 * @return the number of vertices of the polygon
 	 */
-	virtual int n_vertex_of_polygon(int h) const ;
+	virtual int n_vertex_of_polygon(index_t h) const ;
+
+	/**
+	 * @brief constant_face_size tells if all polygons of the current mesh have the same number of vertices, and that the halfedges of face f are n*f to n*f+n-1
+	 * @return that number of vertices n, or 0 if it is not known to be constant
+	 */
+	virtual int constant_face_size() const ;
 
 	/**
 	 * @brief is_border_halfedge determines if a halfedge lies at a border.
@@ -226,7 +418,7 @@ protected:
 	 * @param h a halfedge index
 	 * @return true if and only if h has no twin in buffer.
 	 */
-	bool is_border_halfedge(const halfedge_buffer& h_buffer, int h) const ;
+	bool is_border_halfedge(const halfedge_buffer& h_buffer, index_t h) const ;
 
 	/**
 	 * @brief is_border_vertex determines if a vertex lies at a border of the mesh
@@ -234,7 +426,7 @@ protected:
 	 * @param h index of a halfedge that points outward of the target vertex
 	 * @return true if and only if the vertex from which h departs lies at a border.
 	 */
-	bool is_border_vertex(const halfedge_buffer& h_buffer, int h) const ;
+	bool is_border_vertex(const halfedge_buffer& h_buffer, index_t h) const ;
 
 	/**
 	 * @brief is_crease_edge determines if an edge is a sharp crease
@@ -242,7 +434,7 @@ protected:
 	 * @param crease_id an id in the c_buffer, or beyond its limits
 	 * @return false if the index does not point to a valid crease, or if the crease is not sharp (sharpness = 0).
 	 */
-	bool is_crease_edge(const crease_buffer& c_buffer, int crease_id) const ;
+	bool is_crease_edge(const crease_buffer& c_buffer, index_t crease_id) const ;
 
 	/**
 	 * @brief is_crease_halfedge determines if a halfedge spans a sharp crease edge
@@ -251,7 +443,7 @@ protected:
 	 * @param h an index into the h_buffer
 	 * @return false if the edge along h is not a crease.
 	 */
-	bool is_crease_halfedge(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, int h) const ;
+	bool is_crease_halfedge(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, index_t h) const ;
 
 	/**
 	 * @brief vertex_sharpness_sum computes the sum of sharpnesses of the edges around vertex Vert(h)
@@ -260,7 +452,7 @@ protected:
 	 * @param h index into h_buffer of a halfedge outgoing from the target vertex
 	 * @return a scalar that represents the sum of sharpnesses of the edges adjacent to the current vertex
 	 */
-	float vertex_sharpness_sum(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, int h) const ;
+	float vertex_sharpness_sum(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, index_t h) const ;
 
 	/**
 	 * @brief vertex_sharpnesssum_or_border is similar to #vertex_sharpness_sum but returns a negative number instead of the vertex sharpness if the vertex is at the mesh border.
@@ -270,7 +462,7 @@ protected:
 	 * @param h index into h_buffer of a halfedge outgoing from the target vertex
 	 * @return a scalar that represents the sum of sharpnesses of edges adjacent to the current vertex, or -1 if the vertex lies at a mesh border.
 	 */
-	float vertex_sharpnesssum_or_border(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, int h) const ;
+	float vertex_sharpnesssum_or_border(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, index_t h) const ;
 
 	/**
 	 * @brief vertex_edge_valence_or_border returns the valence of Vert(h), or -1 if Vert(h) is a border vertex.
@@ -279,7 +471,7 @@ protected:
 	 * @param h index into h_buffer of a halfedge outgoing from the target vertex
 	 * @return valence of the vertex Vert(h), or -1 if it is along a mesh border
 	 */
-	int vertex_edge_valence_or_border(const halfedge_buffer& h_buffer, int h) const ;
+	int vertex_edge_valence_or_border(const halfedge_buffer& h_buffer, index_t h) const ;
 
 	/**
 	 * @brief vertex_edge_valence returns the valence of Vert(h), robust wrt borders.
@@ -288,7 +480,7 @@ protected:
 	 * @param h index into h_buffer of a halfedge outgoing from the target vertex
 	 * @return valence of the vertex Vert(h)
 	 */
-	int vertex_edge_valence(const halfedge_buffer& h_buffer, int h) const ;
+	int vertex_edge_valence(const halfedge_buffer& h_buffer, index_t h) const ;
 
 	/**
 	 * @brief vertex_halfedge_valence computes vertex valence in terms of adjacent halfedges (as opposed to edges, which is usually targeted).
@@ -297,7 +489,7 @@ protected:
 	 * @param h index into h_buffer of a halfedge outgoing from the target vertex
 	 * @return the vertex valence in terms of halfedges
 	 */
-	int vertex_halfedge_valence(const halfedge_buffer& h_buffer, int h) const ;
+	int vertex_halfedge_valence(const halfedge_buffer& h_buffer, index_t h) const ;
 
 	/**
 	 * @brief vertex_crease_valence_or_border returns similar to #vertex_crease_valence, or -1 if Vert(h) is a border vertex.
@@ -306,7 +498,7 @@ protected:
 	 * @param h index into h_buffer of a halfedge outgoing from the target vertex
 	 * @return
 	 */
-	int vertex_crease_valence_or_border(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, int h) const ;
+	int vertex_crease_valence_or_border(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, index_t h) const ;
 
 	/**
 	 * @brief vertex_crease_valence returns the number of sharp creases among the edges around Vert(h).
@@ -315,51 +507,207 @@ protected:
 	 * @param h index into h_buffer of a halfedge outgoing from the target vertex
 	 * @return
 	 */
-	int vertex_crease_valence(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, int h) const ;
+	int vertex_crease_valence(const halfedge_buffer& h_buffer, const crease_buffer& c_buffer, index_t h) const ;
+
+	/**
+	 * @brief vertex_config computes the configuration of vertex Vert(h) within a single iteration over its one-ring.
+	 * @note this is equivalent to calling #vertex_edge_valence, #vertex_crease_valence and #vertex_sharpness_sum, and searching the border neighbor, which each iterate over the one-ring.
+	 * @param topology the face connectivity of h_buffer (see topology.h)
+	 * @param sharpness the edge sharpnesses of h_buffer (see sharpness.h)
+	 * @param h_buffer a halfedge buffer
+	 * @param h index into h_buffer of a halfedge outgoing from the target vertex
+	 * @return the configuration of the vertex
+	 */
+	template <typename Topology, typename SharpnessPolicy>
+	VertexConfig vertex_config(const Topology& topology, const SharpnessPolicy& sharpness, const halfedge_buffer& h_buffer, index_t h) const ;
+
+	/**
+	 * @brief compute_vertex_halfedges stores, for each vertex, the index of one of its outgoing halfedges.
+	 * For border vertices, it is the first halfedge of the fan (i.e., Twin(Prev(h)) < 0), such that forward iteration visits the full one-ring.
+	 * @param h_buffer a halfedge buffer
+	 * @param vh_buffer output buffer, sized to the number of vertices. Isolated vertices get index -1.
+	 */
+	void compute_vertex_halfedges(const halfedge_buffer& h_buffer, std::vector<index_t>& vh_buffer) const ;
 
 	// ----------- Accessors for halfedge and crease values from the base mesh buffers -----------
 private:
-	virtual int Twin(int h) const final ;
-	virtual int Vert(int h) const final ;
-	virtual int Edge(int h) const final ;
+	virtual index_t Twin(index_t h) const final ;
+	virtual index_t Vert(index_t h) const final ;
+	virtual index_t Edge(index_t h) const final ;
 
-	virtual int Prev(int h) const ;
-	virtual int Next(int h) const ;
+	virtual index_t Prev(index_t h) const ;
+	virtual index_t Next(index_t h) const ;
 	/**
 	 * @brief Next_safe accessor for the next halfedge attribute supporting invalid indices.
 	 * Note: this accesses the current Mesh halfedge_buffer by default.
 	 * @param h index to access
 	 * @return the next halfedge index within the face, or a negative number.
 	 */
-	virtual int Next_safe(int h) const final ;
+	virtual index_t Next_safe(index_t h) const final ;
 
-	virtual int Face(int h) const ;
+	virtual index_t Face(index_t h) const ;
 
-	virtual float Sharpness(int c) const final ;
-	virtual int NextC(int c) const final ;
-	virtual int PrevC(int c) const final ;
+	virtual float Sharpness(index_t c) const final ;
+	virtual index_t NextC(index_t c) const final ;
+	virtual index_t PrevC(index_t c) const final ;
 
-	// ----------- Functions for loading and exporting from/to OBJ files. -----------
-	void read_from_obj(const std::string& filename) ;
-	static void read_obj_mesh_size(std::ifstream& open_file, int& h_count, int& v_count, int& f_count) ;
-	crease_buffer read_obj_data(std::ifstream& open_file) ;
+	// ----------- Functions for loading and exporting from/to OBJ and cage files. -----------
+	void read_from_obj(const MappedFile& file) ;
+	/**
+	 * @brief read_from_cage copies the mesh buffers from a binary cage file
+	 * @return false if the file is not a cage file, or if it was written with an incompatible memory layout
+	 */
+	bool read_from_cage(const MappedFile& file) ;
+	static bool is_cage_file(const MappedFile& file) ;
+	/**
+	 * @brief The ObjChunk struct describes a range of whole lines of an OBJ file, parsed independently of the other chunks.
+	 */
+	struct ObjChunk
+	{
+		const char* begin ; /*!< first character of the chunk */
+		const char* end ; /*!< character following the last line of the chunk */
+		index_t h_count = 0, v_count = 0, f_count = 0, c_count = 0, t_count = 0 ; /*!< number of halfedges, vertices, faces, crease tags and texture coordinates declared in the chunk */
+		index_t h_first = 0, v_first = 0, f_first = 0, c_first = 0, t_first = 0 ; /*!< index of the first halfedge, vertex, face, crease tag and texture coordinate of the chunk in the mesh buffers */
+	};
+	static std::vector<ObjChunk> split_obj_chunks(const char* begin, const char* end) ;
+	static void read_obj_chunk_size(ObjChunk& chunk) ;
+	void read_obj_chunk_data(const ObjChunk& chunk, crease_buffer& crease_tags, uv_buffer& texcoords, std::vector<index_t>& texcoord_ids) ;
+	/**
+	 * @brief set_uvs gives each halfedge the texture coordinate of its face corner, if all face corners refer to one
+	 * @param texcoords the texture coordinates read from the OBJ file
+	 * @param texcoord_ids the (1-based) texture coordinate of each halfedge, or 0 if its face corner has none
+	 */
+	void set_uvs(const uv_buffer& texcoords, const std::vector<index_t>& texcoord_ids) ;
 
+	/**
+	 * @brief record_load_timing appends the runtime of a mesh construction step to #load_timings
+	 * @param step name of the step
+	 * @param start time at which the step started. It is reset to the current time.
+	 */
+	void record_load_timing(const std::string& step, timer::time_point& start) ;
+
+	/**
+	 * @brief compute_and_set_twins matches halfedges spanning the same edge in opposite directions, in parallel.
+	 * Halfedges are bucketed by the smallest vertex of their edge, so that twins are searched within small contiguous buckets.
+	 */
 	void compute_and_set_twins() ;
-	int compute_and_set_edges() ;
+	index_t compute_and_set_edges() ;
+	/**
+	 * @brief set_creases applies the crease tags read from the OBJ file to the crease buffer.
+	 * Outgoing halfedges are first indexed by vertex, so that each tag only visits the one-ring of its first vertex.
+	 * @param list_of_creases crease tags, whose Prev and Next attributes are the two vertices of the edge
+	 */
 	void set_creases(const crease_buffer&) ;
 	void compute_and_set_crease_neighbors() ;
 	void set_boundaries_sharp() ;
 
 	bool all_faces_are_ngons(int n) const ;
 
+	/**
+	 * @brief order_faces_morton sorts faces along a Morton curve through their centroids
+	 * @param face_halfedges a halfedge of each face
+	 * @return the old index of each face, in the new order
+	 */
+	std::vector<index_t> order_faces_morton(const std::vector<index_t>& face_halfedges) const ;
+	/**
+	 * @brief order_faces_rcm orders faces with a reverse Cuthill-McKee traversal of the graph connecting faces that share an edge
+	 * @param face_halfedges a halfedge of each face
+	 * @return the old index of each face, in the new order
+	 */
+	std::vector<index_t> order_faces_rcm(const std::vector<index_t>& face_halfedges) const ;
+
 	/**
 	 * @brief find_second_crease
 	 * @pre h is the halfedge of a crease and a non-border vertex with exactly two adjacent creases.
 	 * @param h a halfedge whose crease at Edge(h) has a sharpness value superior to 0.
 	 * @return the crease id of a second crease
 	 */
-	int find_second_crease(int h) const ;
+	index_t find_second_crease(index_t h) const ;
 };
 
+// ----------- Inline definitions of the accessors used by refinement kernels -----------
+inline index_t
+Mesh::Twin(const halfedge_buffer& buffer, index_t idx) const
+{
+	return buffer[idx].Twin ;
+}
+
+inline index_t
+Mesh::Vert(const halfedge_buffer& buffer, index_t idx) const
+{
+	return buffer[idx].Vert ;
+}
+
+inline index_t
+Mesh::Edge(const halfedge_buffer& buffer, index_t idx) const
+{
+	return buffer[idx].Edge ;
+}
+
+inline float
+Mesh::Sharpness(const crease_buffer& buffer, index_t idx) const
+{
+	return idx >= index_t(buffer.size()) ? 0. : buffer[idx].Sharpness ;
+}
+
+inline index_t
+Mesh::NextC(const crease_buffer& buffer, index_t idx) const
+{
+	return buffer[idx].Next ;
+}
+
+inline index_t
+Mesh::PrevC(const crease_buffer& buffer, index_t idx) const
+{
+	return buffer[idx].Prev ;
+}
+
+inline bool
+Mesh::is_border_halfedge(const halfedge_buffer& buffer, index_t h) const
+{
+	return Twin(buffer,h) < 0 ;
+}
+
+template <typename Topology, typename SharpnessPolicy>
+VertexConfig
+Mesh::vertex_config(const Topology& topology, const SharpnessPolicy& sharpness, const halfedge_buffer& h_buffer, index_t h) const
+{
+	const float s_first = sharpness.Sharpness(h) ;
+
+	VertexConfig config ;
+	config.Edge_valence = 1 ;
+	config.Crease_valence = int(s_first > _epsilon_) ;
+	config.Sharpness_sum = s_first ;
+	config.Border_neighbor = -1 ;
+
+	index_t h_it ;
+	for (h_it = Twin(h_buffer, h) ; h_it >= 0 ; h_it = Twin(h_buffer, h_it))
+	{
+		h_it = topology.Next(h_it) ;
+		if (h_it == h)
+			break ;
+
+		const float s = sharpness.Sharpness(h_it) ;
+		config.Edge_valence++ ;
+		config.Crease_valence += int(s > _epsilon_) ;
+		config.Sharpness_sum += s ;
+	}
+
+	if (h_it < 0)
+	{	// do backward iteration too, up to the incoming border halfedge
+		for (h_it = h ; h_it >= 0 ; h_it = Twin(h_buffer, h_it))
+		{
+			h_it = topology.Prev(h_it) ;
+
+			const float s = sharpness.Sharpness(h_it) ;
+			config.Edge_valence++ ;
+			config.Crease_valence += int(s > _epsilon_) ;
+			config.Sharpness_sum += s ;
+			config.Border_neighbor = Vert(h_buffer, h_it) ;
+		}
+	}
+
+	return config ;
+}
 
 #endif
@@ -1,13 +1,49 @@
 #include "mesh_subdiv.h"
 
+#include <limits>
+
 Mesh_Subdiv::Mesh_Subdiv(const std::string &filename, uint max_depth):
-	Mesh(filename), d_max(max_depth), subdivided(false), finalized(false) {}
+	Mesh(filename), d_max(max_depth), subdivided(false), finalized(false),
+	H_count_cage(H_count), V_count_cage(V_count), E_count_cage(E_count), F_count_cage(F_count), C_count_cage(C_count)
+{}
 
-int
+index_t
 Mesh_Subdiv::C(int depth) const
 {
 	const int& d = depth < 0 ? d_cur : depth ;
-	return std::pow(2,d) * C_count ;
+	return int64_t(C_count) << d ;
+}
+
+bool
+Mesh_Subdiv::fits_index_range() const
+{
+	// both schemes multiply the number of halfedges by 4 at each depth
+	int64_t Hd = H_count_cage ;
+	for (uint d = 0 ; d < d_max ; ++d)
+	{
+		if (Hd > std::numeric_limits<index_t>::max() / 4)
+			return false ;
+		Hd *= 4 ;
+	}
+	return true ;
+}
+
+void
+Mesh_Subdiv::reorder_cage(Cage_ordering ordering)
+{
+	if (finalized)
+	{
+		std::cerr << "ERROR Mesh_Subdiv::reorder_cage: the mesh is already subdivided" << std::endl ;
+		return ;
+	}
+
+	Mesh::reorder_cage(ordering) ;
+}
+
+index_t
+Mesh_Subdiv::cage_vertex_count() const
+{
+	return V_count_cage ;
 }
 
 void
@@ -18,9 +54,7 @@ Mesh_Subdiv::subdivide()
 
 	allocate_subdiv_buffers() ;
 
-	refine_halfedges() ;
-	refine_creases() ;
-	refine_vertices() ;
+	refine() ;
 	set_current_depth(d_max) ;
 
 	readback_from_subdiv_buffers() ;
@@ -50,6 +84,14 @@ Mesh_Subdiv::subdivide_and_time(int n_repetitions, Timing_stats& stats_he, Timin
 	Timing_stats::compute_stats(t_vx, stats_vx) ;
 }
 
+void
+Mesh_Subdiv::refine()
+{
+	refine_halfedges() ;
+	refine_creases() ;
+	refine_vertices() ;
+}
+
 void
 Mesh_Subdiv::set_current_depth(int depth)
 {
@@ -57,14 +99,27 @@ Mesh_Subdiv::set_current_depth(int depth)
 	subdivided = d_cur > 0 ;
 }
 
+void
+Mesh_Subdiv::restore_cage_counters()
+{
+	H_count = H_count_cage ;
+	E_count = E_count_cage ;
+	F_count = F_count_cage ;
+	V_count = V_count_cage ;
+	C_count = C_count_cage ;
+
+	d_cur = 0 ;
+	finalized = false ;
+}
+
 void
 Mesh_Subdiv::finalize_subdivision()
 {
-	const int Hd = H() ;
-	const int Ed = E() ;
-	const int Fd = F() ;
-	const int Vd = V() ;
-	const int Cd = C() ;
+	const index_t Hd = H() ;
+	const index_t Ed = E() ;
+	const index_t Fd = F() ;
+	const index_t Vd = V() ;
+	const index_t Cd = C() ;
 
 	H_count = Hd ;
 	E_count = Ed ;
@@ -25,22 +25,42 @@ public:
 
 	virtual void subdivide_and_time(int n_repetitions, Timing_stats& stats_he, Timing_stats& stats_cr, Timing_stats& stats_cl, Timing_stats& stats_vx) ;
 
+	/**
+	 * @brief fits_index_range checks that the halfedges at depth d_max can be indexed by #index_t.
+	 * @return false if subdividing would overflow the indices, in which case the library must be built with ENABLE_64BIT_INDICES.
+	 */
+	bool fits_index_range() const ;
+
+	/**
+	 * @brief reorder_cage renumbers the cage (see Mesh::reorder_cage), which is only allowed before subdivision
+	 * @param ordering the face order
+	 */
+	void reorder_cage(Cage_ordering ordering) ;
+
+	/**
+	 * @brief cage_vertex_count gives the number of vertices of the cage, which stays valid once subdivided (unlike V(), see #finalize_subdivision)
+	 */
+	index_t cage_vertex_count() const ;
+
 	// ----------- Internal state of subdivision -----------
 protected:
-	typedef std::chrono::high_resolution_clock timer;
-	typedef std::chrono::duration<double, std::milli> duration;
-
 	const uint d_max ; /*!< the target (maximal) subdivision depth */
 	uint d_cur ; /*!< the current subdivision depth */
 	bool subdivided ; /*!< true if subdivision has started (i.e., at least achieved one level of subdivision) */
 	bool finalized ; /*!< true if subdivision has finished (i.e., achieved subdivision level d_max) */
 
+	index_t H_count_cage ; /*!< number of halfedges of the cage (i.e., before finalization overrides H_count) */
+	index_t V_count_cage ; /*!< number of vertices of the cage (i.e., before finalization overrides V_count) */
+	index_t E_count_cage ; /*!< number of edges of the cage (i.e., before finalization overrides E_count) */
+	index_t F_count_cage ; /*!< number of faces of the cage (i.e., before finalization overrides F_count) */
+	index_t C_count_cage ; /*!< number of creases of the cage (i.e., before finalization overrides C_count) */
+
 	/**
 	 * @brief C counts the number of creases at a given subdivision depth.
 	 * @param depth subdivision depth or -1
 	 * @return the number of creases at subdivision level depth, or at level d_cur (if depth = -1).
 	 */
-	virtual int C(int depth = -1) const final ;
+	virtual index_t C(int depth = -1) const final ;
 
 	/**
 	 * @brief set_current_depth sets an internal state with the current depth.
@@ -50,6 +70,17 @@ protected:
 	 */
 	void set_current_depth(int depth) ;
 
+	/**
+	 * @brief restore_cage_counters sets the counters back to those of the cage, as they were before #finalize_subdivision.
+	 * This allows to run subdivision routines again on a finalized mesh, e.g., to refine new vertex positions.
+	 */
+	void restore_cage_counters() ;
+
+	/**
+	 * @brief finalize_subdivision sets the counters to those of depth d_max and locks the class.
+	 */
+	void finalize_subdivision() ;
+
 	// ----------- Mandatory overrides for derived classes -----------
 	/**
 	 * @brief allocate_subdiv_buffers (pure virtual) should allocate and initialize the buffers in which subdivision will be computed. It is called at the start of call to subdivision.
@@ -61,6 +92,11 @@ protected:
 	 */
 	virtual void readback_from_subdiv_buffers() = 0 ;
 
+	/**
+	 * @brief refine operates halfedge, crease and vertex refinement, in this order, down to depth d_max.
+	 */
+	virtual void refine() ;
+
 	/**
 	 * @brief refine_halfedges (pure virtual) should operate the halfedge refinement in the halfedge subdivision buffers.
 	 */
@@ -76,10 +112,7 @@ protected:
 	 */
 	virtual void refine_vertices() = 0 ;
 
-	// ----------- Finalize and lock the class -----------
 private:
-	void finalize_subdivision() ;
-
 	virtual std::vector<double> measure_time(void (Mesh_Subdiv::*fptr)(), Mesh_Subdiv& c, int n_repetitions) = 0 ;
 
 	Timing_stats compute_stats(std::vector<double>& times) const ;
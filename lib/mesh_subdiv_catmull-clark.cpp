@@ -4,28 +4,28 @@ Mesh_Subdiv_CatmullClark::Mesh_Subdiv_CatmullClark(const std::string &filename,
 	Mesh_Subdiv(filename, maxd_cur)
 {}
 
-int
+index_t
 Mesh_Subdiv_CatmullClark::H(int depth) const
 {
 	const int& d = depth < 0 ? d_cur : depth ;
-	return std::pow(4,d) * H_count ;
+	return int64_t(H_count) << (2 * d) ;
 }
 
-int
+index_t
 Mesh_Subdiv_CatmullClark::F(int depth) const
 {
 	const int& d = depth < 0 ? d_cur : depth ;
-	return d == 0 ? F_count : std::pow(4,d - 1) * H_count ;
+	return d == 0 ? F_count : int64_t(H_count) << (2 * (d - 1)) ;
 }
 
-int
+index_t
 Mesh_Subdiv_CatmullClark::E(int depth) const
 {
 	const int& d = depth < 0 ? d_cur : depth ;
-	return d == 0 ? E_count : std::pow(2,d-1) * (2*E_count + (std::pow(2,d) - 1)*H_count) ;
+	return d == 0 ? E_count : (2 * int64_t(E_count) + ((int64_t(1) << d) - 1) * H_count) << (d - 1) ;
 }
 
-int
+index_t
 Mesh_Subdiv_CatmullClark::V(int depth) const
 {
 	const int& d = depth < 0 ? d_cur : depth ;
@@ -38,43 +38,52 @@ Mesh_Subdiv_CatmullClark::V(int depth) const
 			return V(0) + F(0) + E(0) ;
 			break;
 		default:
-			const float tmp_pow = pow(2,d - 1) - 1 ;
+			const int64_t tmp_pow = (int64_t(1) << (d - 1)) - 1 ;
 			return V(1) + tmp_pow * (E(1) + tmp_pow * F(1)) ;
 	}
 }
 
-int
-Mesh_Subdiv_CatmullClark::Next(int h) const
+index_t
+Mesh_Subdiv_CatmullClark::Next(index_t h) const
 {
 	if (!subdivided) // not quad-only
 		return Mesh::Next(halfedges_cage,h) ;
 
-	return h % 4 == 3 ? h - 3 : h + 1 ;
+	return QuadTopology::Next(h) ;
 }
 
-int
-Mesh_Subdiv_CatmullClark::Prev(int h) const
+index_t
+Mesh_Subdiv_CatmullClark::Prev(index_t h) const
 {
 	if (!subdivided) // not quad-only
 		return Mesh::Prev(halfedges_cage,h) ;
 
-	return h % 4 == 0 ? h + 3 : h - 1 ;
+	return QuadTopology::Prev(h) ;
 }
 
-int
-Mesh_Subdiv_CatmullClark::Face(int h) const
+index_t
+Mesh_Subdiv_CatmullClark::Face(index_t h) const
 {
 	if (!subdivided) // not quad-only
 		return Mesh::Face(halfedges_cage, h) ;
 
-	return h / 4 ;
+	return QuadTopology::Face(h) ;
 }
 
 int
-Mesh_Subdiv_CatmullClark::n_vertex_of_polygon(int h) const
+Mesh_Subdiv_CatmullClark::n_vertex_of_polygon(index_t h) const
 {
 	if (!subdivided) // not quad-only
 		return Mesh::n_vertex_of_polygon(h) ;
 
 	return 4 ;
 }
+
+int
+Mesh_Subdiv_CatmullClark::constant_face_size() const
+{
+	if (!subdivided) // not quad-only
+		return Mesh::constant_face_size() ;
+
+	return 4 ;
+}
@@ -1,236 +1,829 @@
 #include "mesh_subdiv_catmull-clark_cpu.h"
 
+#include <cmath>
+#include <memory>
+#include <numeric>
+
 Mesh_Subdiv_CatmullClark_CPU::Mesh_Subdiv_CatmullClark_CPU(const std::string &filename, uint depth):
 	Mesh_Subdiv_CatmullClark(filename, depth),
 	Mesh_Subdiv_CPU(filename, depth),
 	Mesh_Subdiv(filename, depth)
 {}
 
+// ----------- Dispatch to the kernels instantiated for the topology of each depth -----------
+void
+Mesh_Subdiv_CatmullClark_CPU::refine_halfedges_level(uint d)
+{
+	if (d == 0)
+		refine_halfedges_level(d, CageTopology(halfedges_cage)) ;
+	else
+		refine_halfedges_level(d, QuadTopology()) ;
+}
+
+void
+Mesh_Subdiv_CatmullClark_CPU::refine_vertices_level(uint d)
+{
+	if (d == 0)
+		refine_vertices_level(d, CageTopology(halfedges_cage)) ;
+	else
+		refine_vertices_level(d, QuadTopology()) ;
+}
+
+void
+Mesh_Subdiv_CatmullClark_CPU::refine_vertex_halfedges_level(uint d)
+{
+	if (d == 0)
+		refine_vertex_halfedges_level(d, CageTopology(halfedges_cage)) ;
+	else
+		refine_vertex_halfedges_level(d, QuadTopology()) ;
+}
+
+void
+Mesh_Subdiv_CatmullClark_CPU::refine_topology_level(uint d)
+{
+	if (d == 0)
+		refine_topology_level(d, CageTopology(halfedges_cage)) ;
+	else
+		refine_topology_level(d, QuadTopology()) ;
+}
+
+void
+Mesh_Subdiv_CatmullClark_CPU::refine_uvs_level(uint d)
+{
+	if (d == 0)
+		refine_uvs_level(d, CageTopology(halfedges_cage)) ;
+	else
+		refine_uvs_level(d, QuadTopology()) ;
+}
+
 // ----------- Member functions that do the actual subdivision: halfedges -----------
+template <typename Topology>
 void
-Mesh_Subdiv_CatmullClark_CPU::refine_halfedges()
+Mesh_Subdiv_CatmullClark_CPU::refine_halfedges_level(uint d, const Topology& topology)
 {
-	for (uint d = 0 ; d < d_max; ++d)
+	const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
+	halfedge_buffer& H_new = halfedge_subdiv_buffers[d+1] ;
+	const index_t Hd = H(d) ;
+	const index_t Vd = V(d) ;
+	const index_t Fd = F(d) ;
+	const index_t _2Ed = 2 * E(d) ;
+
+	_PARALLEL_FOR
+	for (index_t h_id = 0; h_id < Hd ; ++h_id)
+		refine_halfedge(topology, H_old, H_new, Vd, Fd, _2Ed, h_id) ;
+	_BARRIER
+}
+
+template <typename Topology>
+void
+Mesh_Subdiv_CatmullClark_CPU::refine_topology_level(uint d, const Topology& topology)
+{
+	const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
+	halfedge_buffer& H_new = halfedge_subdiv_buffers[d+1] ;
+	const crease_buffer& C_old = crease_subdiv_buffers[d] ;
+	crease_buffer& C_new = crease_subdiv_buffers[d+1] ;
+	const index_t Hd = H(d) ;
+	const index_t Vd = V(d) ;
+	const index_t Fd = F(d) ;
+	const index_t Cd = uses_dense_creases() && !border_creases_only(d) ? C(d) : 0 ; // sparse creases are refined after this pass, and border-only depths compute depth d_max only (see compute_border_creases)
+	const index_t _2Ed = 2 * E(d) ;
+
+	// vertex halfedge buffers are only allocated when vertex refinement reads them
+	const bool vertex_halfedges = uses_vertex_halfedges() ;
+	const std::vector<index_t>* VH_old = nullptr ;
+	std::vector<index_t>* VH_new = nullptr ;
+	if (vertex_halfedges)
 	{
-		set_current_depth(d) ;
-		halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
-		halfedge_buffer& H_new = halfedge_subdiv_buffers[d+1] ;
-		const int Hd = H(d) ;
-		const int Vd = V(d) ;
-		const int Fd = F(d) ;
-		const int _2Ed = 2 * E(d) ;
+		VH_old = &vertex_halfedge_subdiv_buffers[d] ;
+		VH_new = &vertex_halfedge_subdiv_buffers[d+1] ;
+		VH_new->assign(V(d+1), -1) ;
+	}
 
-		_PARALLEL_FOR
-		for (int h_id = 0; h_id < Hd ; ++h_id)
+	// a single pass reads each halfedge once (there are fewer creases than halfedges)
+	float max_sharpness = 0.0f ;
+	_PARALLEL_FOR_REDUCTION(max, max_sharpness)
+	for (index_t h_id = 0; h_id < Hd ; ++h_id)
+	{
+		refine_halfedge(topology, H_old, H_new, Vd, Fd, _2Ed, h_id) ;
+		if (vertex_halfedges)
+			refine_vertex_halfedge(topology, H_old, *VH_old, *VH_new, Vd, Fd, h_id) ;
+		if (h_id < Cd)
 		{
-			const int _4h_id = 4 * h_id ;
+			refine_crease(C_old, C_new, h_id) ;
+			max_sharpness = std::max(max_sharpness, decaying_sharpness(C_new, h_id, d)) ;
+		}
+	}
+	_BARRIER
+
+	if (Cd > 0)
+		update_border_crease_depth(d + 1, max_sharpness) ;
 
-			HalfEdge& h0 = H_new[_4h_id + 0] ;
-			HalfEdge& h1 = H_new[_4h_id + 1] ;
-			HalfEdge& h2 = H_new[_4h_id + 2] ;
-			HalfEdge& h3 = H_new[_4h_id + 3] ;
+	if (!uses_dense_creases())
+		refine_creases_level(d) ;
+}
+
+// ----------- Member functions that do the actual subdivision: face-varying UVs -----------
+template <typename Topology>
+void
+Mesh_Subdiv_CatmullClark_CPU::refine_uvs_level(uint d, const Topology& topology)
+{
+	const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
+	const uv_buffer& UV_old = uv_subdiv_buffers[d] ;
+	uv_buffer& UV_new = uv_subdiv_buffers[d+1] ;
+	const index_t Hd = H(d) ;
+
+	// face points first: edge and vertex points read them back from depth d+1 rather than averaging each face again
+	_PARALLEL_FOR
+	for (index_t h_id = 0; h_id < Hd ; ++h_id)
+		UV_new[4 * h_id + 2] = uv_face_point(topology, UV_old, h_id) ;
+	_BARRIER
 
-			const int twin_id = Twin(H_old,h_id) ;
-			const int edge_id = Edge(H_old,h_id) ;
-			const int next_id_safe = twin_id < 0 ? twin_id : Next(twin_id) ;
+	_PARALLEL_FOR
+	for (index_t h_id = 0; h_id < Hd ; ++h_id)
+	{
+		refine_uv_edge_point(topology, H_old, UV_old, UV_new, h_id) ;
+		refine_uv_vertex_point(topology, H_old, UV_old, UV_new, h_id) ;
+	}
+	_BARRIER
+}
 
-			const int prev_id = Prev(h_id) ;
-			const int prev_twin_id = Twin(H_old,prev_id) ;
-			const int prev_edge_id = Edge(H_old,prev_id) ;
+template <typename Topology>
+void
+Mesh_Subdiv_CatmullClark_CPU::refine_uv_edge_point(const Topology& topology, const halfedge_buffer& H_old, const uv_buffer& UV_old, uv_buffer& UV_new, index_t h) const
+{
+	const index_t next_id = topology.Next(h) ;
+	if (uv_interpolation == UV_INTERPOLATION_LINEAR || is_uv_seam(topology, H_old, UV_old, h))
+	{
+		UV_new[4 * h + 1] = UV_new[4 * next_id + 3] = 0.5f * (UV_old[h] + UV_old[next_id]) ;
+		return ;
+	}
 
+	// the smaller halfedge of the edge computes it for both sides
+	const index_t twin_id = Twin(H_old, h) ;
+	if (twin_id < h)
+		return ;
 
-			h0.Twin = 4 * next_id_safe + 3 ;
-			h1.Twin = 4 * Next(h_id) + 2 ;
-			h2.Twin = 4 * prev_id + 1 ;
-			h3.Twin = 4 * prev_twin_id + 0 ;
+	const vec2 uv = 0.25f * (UV_old[h] + UV_old[next_id] + UV_new[4 * h + 2] + UV_new[4 * twin_id + 2]) ;
+	UV_new[4 * h + 1] = UV_new[4 * next_id + 3] = uv ;
+	UV_new[4 * twin_id + 1] = UV_new[4 * topology.Next(twin_id) + 3] = uv ;
+}
 
-			h0.Vert = Vert(H_old,h_id) ;
-			h1.Vert = Vd + Fd + edge_id ;
-			h2.Vert = Vd + Face(h_id) ;
-			h3.Vert = Vd + Fd + prev_edge_id ;
+template <typename Topology>
+void
+Mesh_Subdiv_CatmullClark_CPU::refine_uv_vertex_point(const Topology& topology, const halfedge_buffer& H_old, const uv_buffer& UV_old, uv_buffer& UV_new, index_t h) const
+{
+	if (uv_interpolation == UV_INTERPOLATION_LINEAR)
+	{
+		UV_new[4 * h] = UV_old[h] ;
+		return ;
+	}
 
-			h0.Edge = 2 * edge_id + (int(h_id) > twin_id ? 0 : 1) ;
-			h1.Edge = _2Ed + h_id ;
-			h2.Edge = _2Ed + prev_id ;
-			h3.Edge = 2 * prev_edge_id + (int(prev_id) > prev_twin_id ? 1 : 0) ;
+	// the first halfedge of the fan computes it for all its face corners
+	bool is_boundary ;
+	if (!is_uv_fan_first(topology, H_old, UV_old, h, is_boundary))
+		return ;
+
+	vec2 uv ;
+	if (is_boundary)
+		uv = uv_boundary_vertex_point(topology, H_old, UV_old, h) ;
+	else
+	{
+		// (n-2)/n v + 1/n^2 (sum of the neighbors + sum of the face points), as the smooth vertex rule
+		int n = 0 ;
+		vec2 sum ;
+		index_t h_it = h ;
+		do
+		{
+			sum = sum + UV_old[topology.Next(h_it)] + UV_new[4 * h_it + 2] ;
+			++n ;
+			h_it = topology.Next(Twin(H_old, h_it)) ;
 		}
-		_BARRIER
+		while (h_it != h) ;
+
+		const float n_ = 1.0f / float(n) ;
+		uv = (float(n - 2) * n_) * UV_old[h] + (n_ * n_) * sum ;
+	}
+
+	index_t h_it = h ;
+	do
+	{
+		UV_new[4 * h_it] = uv ;
+		if (is_uv_seam(topology, H_old, UV_old, h_it))
+			break ;
+		h_it = topology.Next(Twin(H_old, h_it)) ;
 	}
+	while (h_it != h) ;
+}
+
+template <typename Topology>
+void
+Mesh_Subdiv_CatmullClark_CPU::refine_halfedge(const Topology& topology, const halfedge_buffer& H_old, halfedge_buffer& H_new, index_t Vd, index_t Fd, index_t _2Ed, index_t h_id) const
+{
+	const index_t _4h_id = 4 * h_id ;
+
+	HalfEdge& h0 = H_new[_4h_id + 0] ;
+	HalfEdge& h1 = H_new[_4h_id + 1] ;
+	HalfEdge& h2 = H_new[_4h_id + 2] ;
+	HalfEdge& h3 = H_new[_4h_id + 3] ;
+
+	const index_t twin_id = Twin(H_old,h_id) ;
+	const index_t edge_id = Edge(H_old,h_id) ;
+	const index_t next_id_safe = twin_id < 0 ? twin_id : topology.Next(twin_id) ;
+
+	const index_t prev_id = topology.Prev(h_id) ;
+	const index_t prev_twin_id = Twin(H_old,prev_id) ;
+	const index_t prev_edge_id = Edge(H_old,prev_id) ;
+
+
+	h0.Twin = 4 * next_id_safe + 3 ;
+	h1.Twin = 4 * topology.Next(h_id) + 2 ;
+	h2.Twin = 4 * prev_id + 1 ;
+	h3.Twin = 4 * prev_twin_id + 0 ;
+
+	h0.Vert = Vert(H_old,h_id) ;
+	h1.Vert = Vd + Fd + edge_id ;
+	h2.Vert = Vd + topology.Face(h_id) ;
+	h3.Vert = Vd + Fd + prev_edge_id ;
+
+	h0.Edge = 2 * edge_id + (h_id > twin_id ? 0 : 1) ;
+	h1.Edge = _2Ed + h_id ;
+	h2.Edge = _2Ed + prev_id ;
+	h3.Edge = 2 * prev_edge_id + (prev_id > prev_twin_id ? 1 : 0) ;
 }
 
 
 // ----------- Member functions that do the actual subdivision: vertices -----------
+template <typename Topology>
 void
-Mesh_Subdiv_CatmullClark_CPU::refine_vertices()
+Mesh_Subdiv_CatmullClark_CPU::refine_vertices_level(uint d, const Topology& topology)
 {
-	for (uint d = 0 ; d < d_max; ++d)
+	const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
+	if (border_creases_only(d))
+		refine_vertices_level(d, topology, BorderSharpness(H_old)) ;
+	else if (!uses_dense_creases())
+		refine_vertices_level(d, topology, SparseCreaseSharpness(H_old, sparse_crease_subdiv_buffers[d])) ;
+	else
+		refine_vertices_level(d, topology, CreaseSharpness(H_old, crease_subdiv_buffers[d])) ;
+}
+
+template <typename Topology, typename SharpnessPolicy>
+void
+Mesh_Subdiv_CatmullClark_CPU::refine_vertices_level(uint d, const Topology& topology, const SharpnessPolicy& sharpness)
+{
+	// see compute_stencil_tables: stencils are gathered, as their increments cannot be atomic
+	if (refining_stencils)
+	{
+		refine_vertices_facepoints_gather<Stencil>(d, topology) ;
+		refine_vertices_edgepoints_gather<Stencil>(d, topology, sharpness) ;
+		refine_vertices_vertexpoints_gather<Stencil>(d, topology, sharpness) ;
+		return ;
+	}
+
+	switch (packed_vertex_width)
 	{
-		set_current_depth(d) ;
-		refine_vertices_facepoints(d) ;
-		refine_vertices_edgepoints(d) ;
-		refine_vertices_vertexpoints(d) ;
+		case 4:		refine_vertices_level<vecN<4>>(d, topology, sharpness) ; break ;
+		case 8:		refine_vertices_level<vecN<8>>(d, topology, sharpness) ; break ;
+		case 16:	refine_vertices_level<vecN<16>>(d, topology, sharpness) ; break ;
+		default:	refine_vertices_level<vec3>(d, topology, sharpness) ;
 	}
-	set_current_depth(d_max) ;
 }
 
+template <typename Vertex, typename Topology, typename SharpnessPolicy>
 void
-Mesh_Subdiv_CatmullClark_CPU::refine_vertices_facepoints(uint d)
+Mesh_Subdiv_CatmullClark_CPU::refine_vertices_level(uint d, const Topology& topology, const SharpnessPolicy& sharpness)
+{
+	if (vertex_refinement_mode == VERTEX_REFINEMENT_GATHER)
+	{
+		refine_vertices_facepoints_gather<Vertex>(d, topology) ;
+		refine_vertices_edgepoints_gather<Vertex>(d, topology, sharpness) ;
+		refine_vertices_vertexpoints_gather<Vertex>(d, topology, sharpness) ;
+	}
+	else
+	{
+		refine_vertices_facepoints<Vertex>(d, topology) ;
+		refine_vertices_edgepoints<Vertex>(d, topology, sharpness) ;
+		refine_vertices_vertexpoints<Vertex>(d, topology, sharpness) ;
+	}
+}
+
+bool
+Mesh_Subdiv_CatmullClark_CPU::uses_vertex_halfedges() const
+{
+	return vertex_refinement_mode == VERTEX_REFINEMENT_GATHER || vertex_storage == VERTEX_STORAGE_SOA ;
+}
+
+uint
+Mesh_Subdiv_CatmullClark_CPU::soa_first_depth() const
+{
+	return 1 ;
+}
+
+void
+Mesh_Subdiv_CatmullClark_CPU::refine_vertices_level_soa(uint d)
+{
+	refine_vertices_catmull_clark_soa(soa_refinement_level(d), simd_isa) ;
+}
+
+template <typename Vertex, typename Topology>
+void
+Mesh_Subdiv_CatmullClark_CPU::refine_vertices_facepoints(uint d, const Topology& topology)
 {
 	const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
-	const vertex_buffer& V_old = vertex_subdiv_buffers[d] ;
-	vertex_buffer& V_new = vertex_subdiv_buffers[d+1] ;
+	const Vertex* V_old = vertex_data<Vertex>(d) ;
+	Vertex* V_new = vertex_data<Vertex>(d+1) ;
 
-	const int Vd = V(d) ;
-	const int Hd = H(d) ;
+	const index_t Vd = V(d) ;
+	const index_t Hd = H(d) ;
 
 _PARALLEL_FOR
-	for (int h_id = 0; h_id < Hd ; ++h_id)
+	for (index_t h_id = 0; h_id < Hd ; ++h_id)
 	{
-		const int vert_id = Vert(H_old, h_id) ;
-		const int new_face_pt_id = Vd + Face(h_id) ;
-		vec3& new_face_pt = V_new[new_face_pt_id] ;
+		const index_t vert_id = Vert(H_old, h_id) ;
+		const index_t new_face_pt_id = Vd + topology.Face(h_id) ;
+		Vertex& new_face_pt = V_new[new_face_pt_id] ;
 
-		const int m = n_vertex_of_polygon(h_id) ;
-		const vec3 increm = V_old[vert_id] / m ;
+		const int m = topology.n_vertex_of_polygon(h_id) ;
+		const Vertex increm = V_old[vert_id] / m ;
 
-		apply_atomic_vec3_increment(new_face_pt, increm) ;
+		apply_atomic_increment(new_face_pt, increm) ;
 	}
 _BARRIER
 }
 
+template <typename Vertex, typename Topology, typename SharpnessPolicy>
 void
-Mesh_Subdiv_CatmullClark_CPU::refine_vertices_edgepoints(uint d)
+Mesh_Subdiv_CatmullClark_CPU::refine_vertices_edgepoints(uint d, const Topology& topology, const SharpnessPolicy& sharpness)
 {
 	const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
-	const crease_buffer& C_old = crease_subdiv_buffers[d] ;
-	const vertex_buffer& V_old = vertex_subdiv_buffers[d] ;
-	vertex_buffer& V_new = vertex_subdiv_buffers[d+1] ;
+	const Vertex* V_old = vertex_data<Vertex>(d) ;
+	Vertex* V_new = vertex_data<Vertex>(d+1) ;
 
-	const int Vd = V(d) ;
-	const int Hd = H(d) ;
-	const int Fd = F(d) ;
+	const index_t Vd = V(d) ;
+	const index_t Hd = H(d) ;
+	const index_t Fd = F(d) ;
 
 _PARALLEL_FOR
-	for (int h_id = 0; h_id < Hd ; ++h_id)
+	for (index_t h_id = 0; h_id < Hd ; ++h_id)
 	{
-		const int vert_id = Vert(H_old,h_id) ;
-		const int edge_id = Edge(H_old, h_id) ;
-		const int& crease_id = edge_id ;
-		const int vert_next_id = Vert(H_old, Next(h_id)) ;
+		const index_t new_edge_pt_id = Vd + Fd + Edge(H_old, h_id) ;
+		Vertex& new_edge_pt = V_new[new_edge_pt_id] ;
+
+		const Vertex increm = edgepoint_increment(topology, sharpness, H_old, V_old, V_new, Vd, h_id) ;
+
+		apply_atomic_increment(new_edge_pt, increm) ;
+	}
+_BARRIER
+}
+
+template <typename Vertex, typename Topology, typename SharpnessPolicy>
+void
+Mesh_Subdiv_CatmullClark_CPU::refine_vertices_vertexpoints(uint d, const Topology& topology, const SharpnessPolicy& sharpness)
+{
+	const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
+	const Vertex* V_old = vertex_data<Vertex>(d) ;
+	Vertex* V_new = vertex_data<Vertex>(d+1) ;
 
-		const int new_edge_pt_id = Vd + Fd + edge_id ;
-		const int new_face_pt_id = Vd + Face(h_id) ;
+	const index_t Vd = V(d) ;
+	const index_t Hd = H(d) ;
+	const index_t Fd = F(d) ;
 
-		vec3& new_edge_pt = V_new[new_edge_pt_id] ;
-		const vec3& v_old = V_old[vert_id] ;
-		const vec3& new_face_pt = V_new[new_face_pt_id] ;
-		const vec3& v_next_old = V_old[vert_next_id] ;
+	_PARALLEL_FOR
+	for (index_t h_id = 0; h_id < Hd ; ++h_id)
+	{
+		const index_t vert_id = Vert(H_old, h_id) ;
+		Vertex& new_vx_pt = V_new[vert_id] ;
 
-		const bool is_border = is_border_halfedge(H_old, h_id) ;
-		const vec3 increm_smooth = 0.25f * (v_old + new_face_pt) ; // Smooth rule B.2
-		const vec3 increm_sharp = (is_border ? 1.0f : 0.5f) * lerp(v_old, v_next_old, 0.5f) ; // Crease rule: B.3
+		// determine local vertex configuration
+		const VertexConfig config = vertex_config(topology, sharpness, H_old, h_id) ;
 
-		const float sharpness = Sharpness(C_old, crease_id) ;
-		const float lerp_alpha = std::clamp(sharpness,0.0f,1.0f) ;
-		vec3 increm = lerp(increm_smooth,increm_sharp,lerp_alpha) ; // Blending crease rule: B.4
+		const Vertex increm = vertexpoint_increment(topology, sharpness, H_old, V_old, V_new, Vd, Fd, h_id, config) ;
 
-		apply_atomic_vec3_increment(new_edge_pt, increm) ;
+		apply_atomic_increment(new_vx_pt, increm) ;
+	}
+	_BARRIER
+}
+
+// ----------- Gathering variants of the vertex refinement (no atomics) -----------
+template <typename Vertex, typename Topology>
+void
+Mesh_Subdiv_CatmullClark_CPU::refine_vertices_facepoints_gather(uint d, const Topology& topology)
+{
+	const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
+	const Vertex* V_old = vertex_data<Vertex>(d) ;
+	Vertex* V_new = vertex_data<Vertex>(d+1) ;
+
+	const index_t Vd = V(d) ;
+	const index_t Hd = H(d) ;
+
+_PARALLEL_FOR
+	for (index_t h_id = 0; h_id < Hd ; ++h_id)
+	{
+		// halfedges of a face are contiguous: the face is treated by its lowest halfedge id
+		if (topology.Prev(h_id) < h_id)
+			continue ;
+
+		Vertex new_face_pt ;
+		int m = 0 ;
+		index_t h_it = h_id ;
+		do
+		{
+			new_face_pt = new_face_pt + V_old[Vert(H_old, h_it)] ;
+			++m ;
+			h_it = topology.Next(h_it) ;
+		}
+		while (h_it != h_id) ;
+
+		V_new[Vd + topology.Face(h_id)] = new_face_pt / m ;
 	}
 _BARRIER
 }
 
+template <typename Vertex, typename Topology, typename SharpnessPolicy>
 void
-Mesh_Subdiv_CatmullClark_CPU::refine_vertices_vertexpoints(uint d)
+Mesh_Subdiv_CatmullClark_CPU::refine_vertices_edgepoints_gather(uint d, const Topology& topology, const SharpnessPolicy& sharpness)
 {
 	const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
-	const crease_buffer& C_old = crease_subdiv_buffers[d] ;
-	const vertex_buffer& V_old = vertex_subdiv_buffers[d] ;
-	vertex_buffer& V_new = vertex_subdiv_buffers[d+1] ;
+	const Vertex* V_old = vertex_data<Vertex>(d) ;
+	Vertex* V_new = vertex_data<Vertex>(d+1) ;
 
-	const int Vd = V(d) ;
-	const int Hd = H(d) ;
-	const int Fd = F(d) ;
+	const index_t Vd = V(d) ;
+	const index_t Hd = H(d) ;
+	const index_t Fd = F(d) ;
 
-	_PARALLEL_FOR
-	for (int h_id = 0; h_id < Hd ; ++h_id)
+_PARALLEL_FOR
+	for (index_t h_id = 0; h_id < Hd ; ++h_id)
 	{
-		const int vert_id = Vert(H_old, h_id) ;
-		const int prev_id = Prev(h_id) ;
-		const int new_face_pt_id = Vd + Face(h_id) ;
-		const int new_edge_pt_id = Vd + Fd + Edge(H_old, h_id) ;
-		const int new_prev_edge_pt_id = Vd + Fd + Edge(H_old, prev_id) ;
-		const int crease_id = Edge(H_old, h_id) ;
-		const int crease_prev_id = Edge(H_old, prev_id) ;
+		// an edge is treated by its biggest halfedge id (twin_id is negative at borders)
+		const index_t twin_id = Twin(H_old, h_id) ;
+		if (twin_id > h_id)
+			continue ;
 
-		vec3& new_vx_pt = V_new[vert_id] ;
-		const vec3& v_old = V_old[vert_id] ;
-		const vec3& new_face_pt = V_new[new_face_pt_id] ;
-		const vec3& new_edge_pt = V_new[new_edge_pt_id] ;
-		const vec3& new_prev_edge_pt = V_new[new_prev_edge_pt_id] ;
+		Vertex new_edge_pt = edgepoint_increment(topology, sharpness, H_old, V_old, V_new, Vd, h_id) ;
+		if (twin_id >= 0)
+			new_edge_pt = new_edge_pt + edgepoint_increment(topology, sharpness, H_old, V_old, V_new, Vd, twin_id) ;
 
-		const float& c_sharpness = Sharpness(C_old, crease_id) ;
-		const float& prev_sharpness = Sharpness(C_old, crease_prev_id) ;
-		const float c_sharpness_sgn = sgn(c_sharpness) ;
+		V_new[Vd + Fd + Edge(H_old, h_id)] = new_edge_pt ;
+	}
+_BARRIER
+}
 
-		const int twin_id = Twin(H_old, h_id) ;
+template <typename Vertex, typename Topology, typename SharpnessPolicy>
+void
+Mesh_Subdiv_CatmullClark_CPU::refine_vertices_vertexpoints_gather(uint d, const Topology& topology, const SharpnessPolicy& sharpness)
+{
+	const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
+	const Vertex* V_old = vertex_data<Vertex>(d) ;
+	const std::vector<index_t>& VH_old = vertex_halfedge_subdiv_buffers[d] ;
+	Vertex* V_new = vertex_data<Vertex>(d+1) ;
 
-		// determine local vertex configuration
-		int vx_n_creases = int(c_sharpness_sgn) ;
-		int vx_edge_valence = 1 ;
-		float vx_sharpness = c_sharpness ;
+	const index_t Vd = V(d) ;
+	const index_t Fd = F(d) ;
 
-		// loop around vx
-		int h_id_it ;
-		for (h_id_it = twin_id ; h_id_it >= 0 ; h_id_it = Twin(H_old, h_id_it))
+	_PARALLEL_FOR
+	for (index_t v_id = 0; v_id < Vd ; ++v_id)
+	{
+		const index_t h_first = VH_old[v_id] ;
+		Vertex new_vx_pt ;
+
+		if (h_first >= 0) // not an isolated vertex
 		{
-			h_id_it = Next(h_id_it) ;
-			if (h_id_it == h_id)
-				break ;
+			const VertexConfig config = vertex_config(topology, sharpness, H_old, h_first) ;
 
-			vx_edge_valence++ ;
+			// h_first starts the fan: forward iteration visits all outgoing halfedges
+			index_t h_it = h_first ;
+			do
+			{
+				new_vx_pt = new_vx_pt + vertexpoint_increment(topology, sharpness, H_old, V_old, V_new, Vd, Fd, h_it, config) ;
 
-			const float s = Sharpness(C_old, Edge(H_old, h_id_it)) ;
-			vx_sharpness += s ;
-			vx_n_creases += sgn(s) ;
+				const index_t twin_id = Twin(H_old, h_it) ;
+				if (twin_id < 0)
+					break ;
+				h_it = topology.Next(twin_id) ;
+			}
+			while (h_it != h_first) ;
 		}
-		// if border, loop backward
-		if (h_id_it < 0)
+
+		V_new[v_id] = new_vx_pt ;
+	}
+	_BARRIER
+}
+
+template <typename Topology>
+void
+Mesh_Subdiv_CatmullClark_CPU::refine_vertex_halfedges_level(uint d, const Topology& topology)
+{
+	const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
+	const std::vector<index_t>& VH_old = vertex_halfedge_subdiv_buffers[d] ;
+	std::vector<index_t>& VH_new = vertex_halfedge_subdiv_buffers[d+1] ;
+
+	const index_t Hd = H(d) ;
+	const index_t Vd = V(d) ;
+	const index_t Fd = F(d) ;
+	VH_new.assign(V(d+1), -1) ;
+
+	_PARALLEL_FOR
+	for (index_t h_id = 0; h_id < Hd ; ++h_id)
+		refine_vertex_halfedge(topology, H_old, VH_old, VH_new, Vd, Fd, h_id) ;
+	_BARRIER
+}
+
+template <typename Topology>
+void
+Mesh_Subdiv_CatmullClark_CPU::refine_vertex_halfedge(const Topology& topology, const halfedge_buffer& H_old, const std::vector<index_t>& VH_old, std::vector<index_t>& VH_new, index_t Vd, index_t Fd, index_t h_id) const
+{
+	const index_t _4h_id = 4 * h_id ;
+
+	if (VH_old[Vert(H_old, h_id)] == h_id) // vertex point
+		VH_new[Vert(H_old, h_id)] = _4h_id + 0 ;
+
+	if (topology.Prev(h_id) > h_id) // face point
+		VH_new[Vd + topology.Face(h_id)] = _4h_id + 2 ;
+
+	if (Twin(H_old, h_id) < h_id) // edge point
+		VH_new[Vd + Fd + Edge(H_old, h_id)] = _4h_id + 1 ;
+}
+
+// ----------- Refinement rules -----------
+template <typename Vertex, typename Topology, typename SharpnessPolicy>
+Vertex
+Mesh_Subdiv_CatmullClark_CPU::edgepoint_increment(const Topology& topology, const SharpnessPolicy& sharpness, const halfedge_buffer& H_old, const Vertex* V_old, const Vertex* V_new, index_t Vd, index_t h_id) const
+{
+	const index_t vert_id = Vert(H_old,h_id) ;
+	const index_t vert_next_id = Vert(H_old, topology.Next(h_id)) ;
+
+	const index_t new_face_pt_id = Vd + topology.Face(h_id) ;
+
+	const Vertex& v_old = V_old[vert_id] ;
+	const Vertex& new_face_pt = V_new[new_face_pt_id] ;
+	const Vertex& v_next_old = V_old[vert_next_id] ;
+
+	const bool is_border = is_border_halfedge(H_old, h_id) ;
+	const Vertex increm_smooth = 0.25f * (v_old + new_face_pt) ; // Smooth rule B.2
+	const Vertex increm_sharp = (is_border ? 1.0f : 0.5f) * lerp(v_old, v_next_old, 0.5f) ; // Crease rule: B.3
+
+	const float lerp_alpha = std::clamp(sharpness.Sharpness(h_id),0.0f,1.0f) ;
+	return lerp(increm_smooth,increm_sharp,lerp_alpha) ; // Blending crease rule: B.4
+}
+
+template <typename Vertex, typename Topology, typename SharpnessPolicy>
+Vertex
+Mesh_Subdiv_CatmullClark_CPU::vertexpoint_increment(const Topology& topology, const SharpnessPolicy& sharpness, const halfedge_buffer& H_old, const Vertex* V_old, const Vertex* V_new, index_t Vd, index_t Fd, index_t h_id, const VertexConfig& config) const
+{
+	const index_t vert_id = Vert(H_old, h_id) ;
+	const index_t prev_id = topology.Prev(h_id) ;
+	const index_t new_face_pt_id = Vd + topology.Face(h_id) ;
+	const index_t new_edge_pt_id = Vd + Fd + Edge(H_old, h_id) ;
+	const index_t new_prev_edge_pt_id = Vd + Fd + Edge(H_old, prev_id) ;
+
+	const Vertex& v_old = V_old[vert_id] ;
+	const Vertex& new_face_pt = V_new[new_face_pt_id] ;
+	const Vertex& new_edge_pt = V_new[new_edge_pt_id] ;
+	const Vertex& new_prev_edge_pt = V_new[new_prev_edge_pt_id] ;
+
+	const float c_sharpness = sharpness.Sharpness(h_id) ;
+	const float prev_sharpness = sharpness.Sharpness(prev_id) ;
+	const float c_sharpness_sgn = sgn(c_sharpness) ;
+
+	const int vx_edge_valence = config.Edge_valence ;
+	const int vx_n_creases = config.Crease_valence ;
+	const float vx_sharpness = 0.5f * config.Sharpness_sum ; // used only iff 2 adjacent crease edges.
+	const bool vx_is_border = config.Border_neighbor >= 0 ;
+	const int vx_halfedge_valence = vx_edge_valence + (vx_is_border ? -1 : 0) ;
+	const float lerp_alpha = std::clamp(vx_sharpness,0.0f,1.0f) ;
+
+	const Vertex increm_corner = v_old / float(vx_halfedge_valence) ; // corner vertex rule: C.3
+	const Vertex increm_smooth = (4.0f * new_edge_pt - new_face_pt + (float(vx_edge_valence) - 3.0f) * v_old) / float (vx_edge_valence*vx_edge_valence) ; // Smooth rule: C.2
+	Vertex increm_creased = c_sharpness_sgn * 0.25f * (new_edge_pt + v_old) ; // Creased vertex rule: C.5
+	if (vx_is_border)
+	{
+		increm_creased = increm_creased + 0.25f * sgn(prev_sharpness) * (new_prev_edge_pt + v_old) ;
+	}
+
+	// apply the right incrementation
+	if ((vx_edge_valence == 2) || (vx_n_creases > 2))
+		return increm_corner ;
+	else if (vx_n_creases < 2)
+		return increm_smooth ;
+	else // vx_n_creases = 2
+		return lerp(increm_corner, increm_creased, lerp_alpha) ;
+}
+
+// ----------- Limit surface -----------
+bool
+Mesh_Subdiv_CatmullClark_CPU::project_vertices_to_limit(const std::vector<index_t>& vertex_halfedges, vertex_buffer& limits)
+{
+	if (subdivided)
+	{
+		project_vertices_to_limit(QuadTopology(), vertex_halfedges, limits) ;
+		return true ;
+	}
+
+	if (!is_quad_only())
+	{
+		std::cerr << "ERROR Mesh_Subdiv_CatmullClark_CPU::project_vertices_to_limit: the limit masks require quads only (subdivide at least once)" << std::endl ;
+		return false ;
+	}
+
+	project_vertices_to_limit(CageTopology(halfedges_cage), vertex_halfedges, limits) ;
+	return true ;
+}
+
+template <typename Topology>
+void
+Mesh_Subdiv_CatmullClark_CPU::project_vertices_to_limit(const Topology& topology, const std::vector<index_t>& vertex_halfedges, vertex_buffer& limits)
+{
+	const index_t Vd = V() ;
+
+	_PARALLEL_FOR
+	for (index_t v_id = 0 ; v_id < Vd ; ++v_id)
+	{
+		const index_t h_first = vertex_halfedges[v_id] ;
+		vec3 limit = vertices[v_id] ;
+		vec3 tangent, normal ;
+		int n ;
+
+		if (h_first >= 0 && !limit_sharp_vertex(topology, h_first, n, limit, tangent, normal))
 		{
-			for (h_id_it = h_id ; h_id_it >= 0 ; h_id_it = Twin(H_old, h_id_it))
+			// interior vertex: the fan of its n edges is closed
+			index_t h_it = h_first ;
+
+			// halfedge i reaches edge neighbor i, and the face neighbor of its face lies between edge neighbors i-1 and i
+			const float theta = _2pi / float(n) ;
+			const float cos_theta = std::cos(theta), sin_theta = std::sin(theta) ;
+			const float a = 1.0f + cos_theta + std::cos(0.5f * theta) * std::sqrt(2.0f * (9.0f + cos_theta)) ;
+			vec3 edge_sum, face_sum, tangent_cos, tangent_sin ;
+			// cosine and sine of the angles i and i-1 are rotated from one neighbor to the next
+			float c = 1.0f, s = 0.0f, c_prev = cos_theta, s_prev = -sin_theta ;
+			for (int i = 0 ; i < n ; ++i)
 			{
-				h_id_it = Prev(h_id_it) ;
+				const index_t h_next = topology.Next(h_it) ;
+				const vec3& e = vertices[Vert(halfedges, h_next)] ;
+				const vec3& f = vertices[Vert(halfedges, topology.Next(h_next))] ;
+
+				edge_sum = edge_sum + e ;
+				face_sum = face_sum + f ;
+				tangent_cos = tangent_cos + (a * c) * e + (c_prev + c) * f ;
+				tangent_sin = tangent_sin + (a * s) * e + (s_prev + s) * f ;
+
+				c_prev = c ;
+				s_prev = s ;
+				c = c_prev * cos_theta - s_prev * sin_theta ;
+				s = s_prev * cos_theta + c_prev * sin_theta ;
+				h_it = topology.Next(Twin(halfedges, h_it)) ;
+			}
 
-				vx_edge_valence++ ;
+			limit = (float(n * n) * vertices[v_id] + 4.0f * edge_sum + face_sum) / float(n * (n + 5)) ;
+			tangent = tangent_cos ;
+			// neighbors turn clockwise around the vertex
+			normal = tangent_sin.cross(tangent_cos) ;
+		}
 
-				const float s = Sharpness(C_old, Edge(H_old, h_id_it)) ;
-				vx_sharpness += s ;
-				vx_n_creases += sgn(s) ;
+		limits[v_id] = limit ;
+		set_limit_frame(v_id, tangent, normal) ;
+	}
+	_BARRIER
+}
+
+// ----------- Adaptive refinement -----------
+void
+Mesh_Subdiv_CatmullClark_CPU::subdivide_adaptive(Adaptive_patches& patches) const
+{
+	patches.clear() ;
+	if (finalized)
+	{
+		std::cerr << "ERROR Mesh_Subdiv_CatmullClark_CPU::subdivide_adaptive: the mesh is already subdivided" << std::endl ;
+		return ;
+	}
+	if (d_max == 0)
+	{
+		std::cerr << "ERROR Mesh_Subdiv_CatmullClark_CPU::subdivide_adaptive: the target depth must be at least 1" << std::endl ;
+		return ;
+	}
+
+	// the faces left to refine are copied with their one-ring into a scratch mesh, refined by one depth (see replace_cage_by_refinement),
+	// and their children are classified in turn: each depth is extracted from the scratch mesh of the previous one
+	std::unique_ptr<Mesh_Subdiv_CatmullClark_CPU> scratch[2] ;
+	const Mesh_Subdiv_CatmullClark_CPU* mesh = this ;
+
+	std::vector<index_t> faces(F_count_cage) ;
+	std::iota(faces.begin(), faces.end(), 0) ;
+	std::vector<index_t> face_halfedges, vertex_halfedges, offsets, irregular_faces ;
+	Tile_map map ;
+	Tile_index index ;
+	for (uint d = 0 ; ; ++d)
+	{
+		const index_t Hd = mesh->H_count ;
+		face_halfedges.resize(mesh->F_count) ;
+		for (index_t h = 0 ; h < Hd ; ++h)
+			face_halfedges[Mesh::Face(mesh->halfedges_cage, h)] = h ;
+
+		// regular faces become patches
+		const index_t n_faces = faces.size() ;
+		offsets.resize(n_faces) ;
+		_PARALLEL_FOR
+		for (index_t i = 0 ; i < n_faces ; ++i)
+			offsets[i] = mesh->is_regular_face(face_halfedges[faces[i]]) ? 1 : 0 ;
+		_BARRIER
+
+		irregular_faces.clear() ;
+		for (index_t i = 0 ; i < n_faces ; ++i)
+			if (offsets[i] == 0)
+				irregular_faces.push_back(faces[i]) ;
+
+		const index_t p_first = patches.patch_count() ;
+		const index_t n_patches = exclusive_scan_parallel(offsets) ;
+		patches.patch_points.resize(Adaptive_patches::patch_size * (p_first + n_patches)) ;
+		patches.patch_depths.resize(p_first + n_patches, d) ;
+
+		_PARALLEL_FOR
+		for (index_t i = 0 ; i < n_faces ; ++i)
+		{
+			const bool is_regular = i + 1 < n_faces ? offsets[i + 1] > offsets[i] : n_patches > offsets[i] ;
+			if (is_regular)
+				mesh->gather_regular_patch(face_halfedges[faces[i]], &patches.patch_points[Adaptive_patches::patch_size * (p_first + offsets[i])]) ;
+		}
+		_BARRIER
+
+		if (irregular_faces.empty())
+			break ;
+
+		// faces still irregular at the target depth are output as they are
+		if (d == d_max)
+		{
+			for (const index_t f: irregular_faces)
+			{
+				index_t h = face_halfedges[f] ;
+				for (int k = 0 ; k < 4 ; ++k, h = Mesh::Next(mesh->halfedges_cage, h))
+					patches.face_points.push_back(mesh->vertices[Vert(mesh->halfedges, h)]) ;
 			}
+			break ;
 		}
-		vx_sharpness *= 0.5f ; // used only iff 2 adjacent crease edges.
 
-		bool vx_is_border = h_id_it < 0 ;
-		const int vx_halfedge_valence = vx_edge_valence + (vx_is_border ? -1 : 0) ;
-		const float lerp_alpha = std::clamp(vx_sharpness,0.0f,1.0f) ;
+		std::unique_ptr<Mesh_Subdiv_CatmullClark_CPU>& tile = scratch[d % 2] ;
+		if (!tile)
+		{
+			tile.reset(new Mesh_Subdiv_CatmullClark_CPU(*this)) ;
+			tile->vertex_storage = VERTEX_STORAGE_AOS ;
+			tile->crease_storage = CREASE_STORAGE_DENSE ;
+			tile->crease_free = false ; // creases are extracted from the crease buffer of each depth
+		}
 
-		const vec3 increm_corner = v_old / float(vx_halfedge_valence) ; // corner vertex rule: C.3
-		const vec3 increm_smooth = (4.0f * new_edge_pt - new_face_pt + (float(vx_edge_valence) - 3.0f) * v_old) / float (vx_edge_valence*vx_edge_valence) ; // Smooth rule: C.2
-		vec3 increm_creased = c_sharpness_sgn * 0.25f * (new_edge_pt + v_old) ; // Creased vertex rule: C.5
-		if (vx_is_border)
+		vertex_halfedges.resize(mesh->V_count) ;
+		mesh->compute_vertex_halfedges(mesh->halfedges, vertex_halfedges) ;
+		mesh->extract_tile(irregular_faces, face_halfedges, vertex_halfedges, mesh->halfedges_cage, *tile, map, index) ;
+		tile->uvs.clear() ; // patches carry no UVs nor vertex attributes: they are not refined
+		tile->attributes.clear() ;
+
+		// faces of depth 1 are indexed by the halfedge they derive from (see refine_halfedge): those of the faces to refine are owned
+		faces.clear() ;
+		const index_t Ht = tile->H_count ;
+		for (index_t h = 0 ; h < Ht ; ++h)
+			if (map.faces[Mesh::Face(tile->halfedges_cage, h)] >= 0)
+				faces.push_back(h) ;
+
+		tile->replace_cage_by_refinement() ;
+		mesh = tile.get() ;
+	}
+}
+
+bool
+Mesh_Subdiv_CatmullClark_CPU::is_regular_face(index_t h_first) const
+{
+	// each vertex of the face is interior, and has 4 smooth edges and 4 quads around it
+	index_t h = h_first ;
+	for (int k = 0 ; k < 4 ; ++k, h = Mesh::Next(halfedges_cage, h))
+	{
+		index_t h_it = h ;
+		for (int i = 0 ; i < 4 ; ++i)
 		{
-			increm_creased = increm_creased + 0.25f * sgn(prev_sharpness) * (new_prev_edge_pt + v_old) ;
+			const index_t twin_id = Twin(halfedges, h_it) ;
+			if (twin_id < 0 || Sharpness(creases, Edge(halfedges, h_it)) > 0.0f || Mesh::n_vertex_of_polygon(h_it) != 4)
+				return false ;
+
+			h_it = Mesh::Next(halfedges_cage, twin_id) ;
+			if ((h_it == h) != (i == 3))
+				return false ;
 		}
+	}
+	return true ;
+}
 
-		// apply the right incrementation
-		vec3 increm ;
-		if ((vx_edge_valence == 2) || (vx_n_creases > 2))
-			increm = increm_corner ;
-		else if (vx_n_creases < 2)
-			increm = increm_smooth ;
-		else // vx_n_creases = 2
-			increm = lerp(increm_corner, increm_creased, lerp_alpha) ;
+void
+Mesh_Subdiv_CatmullClark_CPU::gather_regular_patch(index_t h_first, vec3* points) const
+{
+	// grid index of each vertex of the face, and of the vertices adjacent to it across its halfedge, across the previous halfedge, and diagonally
+	static const int grid[4][4] = {{5, 1, 4, 0}, {6, 7, 2, 3}, {10, 14, 11, 15}, {9, 8, 13, 12}} ;
 
-		apply_atomic_vec3_increment(new_vx_pt, increm) ;
+	index_t h = h_first ;
+	for (int k = 0 ; k < 4 ; ++k, h = Mesh::Next(halfedges_cage, h))
+	{
+		const index_t twin_next = Twin(halfedges, h) ;
+		const index_t twin_prev = Twin(halfedges, Mesh::Prev(halfedges_cage, h)) ;
+		const index_t twin_diagonal = Twin(halfedges, Mesh::Next(halfedges_cage, twin_next)) ;
+
+		points[grid[k][0]] = vertices[Vert(halfedges, h)] ;
+		points[grid[k][1]] = vertices[Vert(halfedges, Mesh::Next(halfedges_cage, Mesh::Next(halfedges_cage, twin_next)))] ;
+		points[grid[k][2]] = vertices[Vert(halfedges, Mesh::Prev(halfedges_cage, twin_prev))] ;
+		points[grid[k][3]] = vertices[Vert(halfedges, Mesh::Prev(halfedges_cage, twin_diagonal))] ;
 	}
-	_BARRIER
 }
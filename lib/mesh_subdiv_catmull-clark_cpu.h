@@ -1,6 +1,7 @@
 #ifndef __MESH_SUDBIV_CATMULLCLARK_CPU_H__
 #define __MESH_SUDBIV_CATMULLCLARK_CPU_H__
 
+#include "adaptive_patches.h"
 #include "mesh_subdiv_catmull-clark.h"
 #include "mesh_subdiv_cpu.h"
 
@@ -17,33 +18,294 @@ public:
 	 */
 	Mesh_Subdiv_CatmullClark_CPU(const std::string& filename, uint max_depth);
 
+	using Mesh_Subdiv_CPU::subdivide_vertices ;
+	using Mesh_Subdiv_CPU::subdivide_and_time ;
+	using Mesh_Subdiv_CPU::set_low_memory ;
+	using Mesh_Subdiv_CPU::set_level_fused ;
+	using Mesh_Subdiv_CPU::subdivide_and_time_levels ;
+	using Mesh_Subdiv_CPU::subdivide_and_time_total ;
+	using Mesh_Subdiv_CPU::set_vertex_refinement_mode ;
+	using Mesh_Subdiv_CPU::set_vertex_storage ;
+	using Mesh_Subdiv_CPU::set_simd_isa ;
+	using Mesh_Subdiv_CPU::get_simd_isa ;
+	using Mesh_Subdiv_CPU::set_crease_storage ;
+	using Mesh_Subdiv_CPU::get_border_crease_depth ;
+	using Mesh_Subdiv_CPU::set_limit_projection ;
+	using Mesh_Subdiv_CPU::set_uv_interpolation ;
+	using Mesh_Subdiv_CPU::subdivide_vertices_and_time ;
+	using Mesh_Subdiv_CPU::set_stencil_evaluation ;
+	using Mesh_Subdiv_CPU::get_stencil_tables ;
+
+	/**
+	 * @brief subdivide_adaptive runs feature-adaptive subdivision: only the faces around extraordinary vertices and creases are refined down to d_max.
+	 * At each depth, the regular faces (quads whose vertices are interior, of valence 4, and without sharp edges) are output as bicubic B-spline patches,
+	 * whose limit surface is that of uniform subdivision. The other faces are copied with their one-ring into a scratch mesh, refined by one depth, and their children are classified in turn.
+	 * Faces that are still irregular at d_max are output as quads, and match those of uniform subdivision.
+	 * The mesh itself is left unsubdivided, and the settings of uniform subdivision (SoA vertices, sparse creases) do not apply.
+	 * @param patches output patches and quads
+	 */
+	void subdivide_adaptive(Adaptive_patches& patches) const ;
+
 protected:
 	// ----------- Member functions that do the actual subdivision -----------
 	/**
-	 * @brief refine_halfedges operates Catmull-Clark halfedge refinement on the CPU
+	 * @brief refine_halfedges_level operates Catmull-Clark halfedge refinement of depth d on the CPU
+	 * @param d current depth
+	 */
+	void refine_halfedges_level(uint d) ;
+	/**
+	 * @brief refine_vertices_level operates Catmull-Clark vertex refinement of depth d on the CPU
+	 * @param d current depth
+	 */
+	void refine_vertices_level(uint d) ;
+	/**
+	 * @brief refine_vertex_halfedges_level computes vertex_halfedge_subdiv_buffers[d+1], which is required by the gathering kernels.
+	 * Depth d+1 is obtained analytically from depth d: vertex points inherit halfedge 4h, face points and edge points use halfedges 4h+2 and 4h+1 of their owner halfedge h.
+	 * @param d current depth
+	 */
+	void refine_vertex_halfedges_level(uint d) ;
+	/**
+	 * @brief refine_topology_level computes the halfedges, creases and vertex halfedges of depth d+1 within a single loop over the halfedges of depth d
+	 * @param d current depth
+	 */
+	void refine_topology_level(uint d) ;
+	/**
+	 * @brief refine_uvs_level operates Catmull-Clark UV refinement of depth d on the CPU: halfedges 4h to 4h+3 of depth d+1 get the UVs of the vertex point, edge point, face point and previous edge point of halfedge h
+	 * @param d current depth
+	 */
+	void refine_uvs_level(uint d) ;
+
+	/**
+	 * @brief uses_vertex_halfedges tells if vertex refinement reads vertex_halfedge_subdiv_buffers (i.e., in gather or SoA mode)
+	 */
+	bool uses_vertex_halfedges() const ;
+
+	/**
+	 * @brief soa_first_depth gives 1: faces are all quads from depth 1 on
+	 */
+	uint soa_first_depth() const ;
+	/**
+	 * @brief refine_vertices_level_soa operates Catmull-Clark vertex refinement of depth d on the CPU, with SoA vertices (see refine_vertices_catmull_clark_soa)
+	 * @param d current depth
+	 */
+	void refine_vertices_level_soa(uint d) ;
+
+	// ----------- Refinement kernels -----------
+	// The kernels below are instantiated for the CageTopology of depth 0 and for the QuadTopology of the next depths (see topology.h):
+	// the functions above dispatch to either instantiation. Vertex kernels are also instantiated for each sharpness policy (see sharpness.h).
+
+	/**
+	 * @brief refine_halfedges_level operates Catmull-Clark halfedge refinement of depth d on the CPU
+	 * @param d current depth
+	 * @param topology face connectivity of depth d
+	 */
+	template <typename Topology>
+	void refine_halfedges_level(uint d, const Topology& topology) ;
+	/**
+	 * @brief refine_vertices_level operates Catmull-Clark vertex refinement of depth d on the CPU
+	 * @param d current depth
+	 * @param topology face connectivity of depth d
+	 */
+	template <typename Topology>
+	void refine_vertices_level(uint d, const Topology& topology) ;
+	/**
+	 * @brief refine_vertices_level operates Catmull-Clark vertex refinement of depth d on the CPU
+	 * @param d current depth
+	 * @param topology face connectivity of depth d
+	 * @param sharpness edge sharpnesses of depth d: BorderSharpness for crease-free meshes, CreaseSharpness otherwise (see sharpness.h)
+	 */
+	template <typename Topology, typename SharpnessPolicy>
+	void refine_vertices_level(uint d, const Topology& topology, const SharpnessPolicy& sharpness) ;
+	/**
+	 * @brief refine_vertices_level operates Catmull-Clark vertex refinement of depth d on the CPU, on vertices of type Vertex (see Mesh_Subdiv_CPU::vertex_data):
+	 * vertex attributes are refined in the same passes as the positions, which walk the topology and compute the vertex configurations once for all of them
+	 * @param d current depth
+	 * @param topology face connectivity of depth d
+	 * @param sharpness edge sharpnesses of depth d
+	 */
+	template <typename Vertex, typename Topology, typename SharpnessPolicy>
+	void refine_vertices_level(uint d, const Topology& topology, const SharpnessPolicy& sharpness) ;
+	/**
+	 * @brief refine_vertex_halfedges_level computes vertex_halfedge_subdiv_buffers[d+1]
+	 * @param d current depth
+	 * @param topology face connectivity of depth d
+	 */
+	template <typename Topology>
+	void refine_vertex_halfedges_level(uint d, const Topology& topology) ;
+	/**
+	 * @brief refine_topology_level computes the halfedges, creases and vertex halfedges of depth d+1 within a single loop
+	 * @param d current depth
+	 * @param topology face connectivity of depth d
 	 */
-	void refine_halfedges() ;
+	template <typename Topology>
+	void refine_topology_level(uint d, const Topology& topology) ;
 	/**
-	 * @brief refine_vertices operates Catmull-Clark vertex refinement on the CPU
+	 * @brief refine_uvs_level operates Catmull-Clark UV refinement of depth d on the CPU
+	 * @param d current depth
+	 * @param topology face connectivity of depth d
 	 */
-	void refine_vertices() ;
+	template <typename Topology>
+	void refine_uvs_level(uint d, const Topology& topology) ;
+	/**
+	 * @brief refine_uv_edge_point computes the UV of the edge point of a halfedge, in its face, and its previous halfedge: the middle of the edge on UV seams,
+	 * and the smooth edge rule within a UV chart, computed by the smaller halfedge of the edge for both sides
+	 * @param topology face connectivity of depth d
+	 * @param H_old halfedge buffer at depth d
+	 * @param UV_old UV buffer at depth d
+	 * @param UV_new UV buffer at depth d+1, whose face points are set
+	 * @param h a halfedge index at depth d
+	 */
+	template <typename Topology>
+	void refine_uv_edge_point(const Topology& topology, const halfedge_buffer& H_old, const uv_buffer& UV_old, uv_buffer& UV_new, index_t h) const ;
+	/**
+	 * @brief refine_uv_vertex_point computes the UV of the vertex point of all the face corners of a fan, if the halfedge starts it (see Mesh_Subdiv_CPU::is_uv_fan_first):
+	 * the smooth vertex rule within a UV chart, and the boundary rule otherwise (see Mesh_Subdiv_CPU::uv_boundary_vertex_point)
+	 * @param topology face connectivity of depth d
+	 * @param H_old halfedge buffer at depth d
+	 * @param UV_old UV buffer at depth d
+	 * @param UV_new UV buffer at depth d+1, whose face points are set
+	 * @param h a halfedge index at depth d
+	 */
+	template <typename Topology>
+	void refine_uv_vertex_point(const Topology& topology, const halfedge_buffer& H_old, const uv_buffer& UV_old, uv_buffer& UV_new, index_t h) const ;
+
+	/**
+	 * @brief refine_halfedge computes the four halfedges of depth d+1 that derive from halfedge h of depth d
+	 * @param topology face connectivity of depth d
+	 * @param H_old halfedge buffer at depth d
+	 * @param H_new halfedge buffer at depth d+1
+	 * @param Vd number of vertices at depth d
+	 * @param Fd number of faces at depth d
+	 * @param _2Ed twice the number of edges at depth d
+	 * @param h a halfedge index at depth d
+	 */
+	template <typename Topology>
+	void refine_halfedge(const Topology& topology, const halfedge_buffer& H_old, halfedge_buffer& H_new, index_t Vd, index_t Fd, index_t _2Ed, index_t h) const ;
+	/**
+	 * @brief refine_vertex_halfedge writes the vertex halfedges of depth d+1 for which halfedge h of depth d is responsible
+	 * @param topology face connectivity of depth d
+	 * @param H_old halfedge buffer at depth d
+	 * @param VH_old vertex halfedges at depth d
+	 * @param VH_new vertex halfedges at depth d+1
+	 * @param Vd number of vertices at depth d
+	 * @param Fd number of faces at depth d
+	 * @param h a halfedge index at depth d
+	 */
+	template <typename Topology>
+	void refine_vertex_halfedge(const Topology& topology, const halfedge_buffer& H_old, const std::vector<index_t>& VH_old, std::vector<index_t>& VH_new, index_t Vd, index_t Fd, index_t h) const ;
 
-	// ----------- Utility functions -----------
 	/**
 	 * @brief refine_vertices_facepoints operates face point refinement on the CPU
 	 * @param d current depth
+	 * @param topology face connectivity of depth d
 	 */
-	void refine_vertices_facepoints(uint d) ;
+	template <typename Vertex, typename Topology>
+	void refine_vertices_facepoints(uint d, const Topology& topology) ;
 	/**
 	 * @brief refine_vertices_edgepoints operates edge point refinement on the CPU
 	 * @param d current depth
+	 * @param topology face connectivity of depth d
+	 * @param sharpness edge sharpnesses of depth d
 	 */
-	void refine_vertices_edgepoints(uint d) ;
+	template <typename Vertex, typename Topology, typename SharpnessPolicy>
+	void refine_vertices_edgepoints(uint d, const Topology& topology, const SharpnessPolicy& sharpness) ;
 	/**
 	 * @brief refine_vertices_vertexpoints operates vertex point refinement on the CPU
 	 * @param d current depth
+	 * @param topology face connectivity of depth d
+	 * @param sharpness edge sharpnesses of depth d
+	 */
+	template <typename Vertex, typename Topology, typename SharpnessPolicy>
+	void refine_vertices_vertexpoints(uint d, const Topology& topology, const SharpnessPolicy& sharpness) ;
+
+	/**
+	 * @brief refine_vertices_facepoints_gather operates face point refinement on the CPU, computing each face point within a single thread (no atomics)
+	 * @param d current depth
+	 * @param topology face connectivity of depth d
+	 */
+	template <typename Vertex, typename Topology>
+	void refine_vertices_facepoints_gather(uint d, const Topology& topology) ;
+	/**
+	 * @brief refine_vertices_edgepoints_gather operates edge point refinement on the CPU, computing each edge point within a single thread (no atomics)
+	 * @param d current depth
+	 * @param topology face connectivity of depth d
+	 * @param sharpness edge sharpnesses of depth d
+	 */
+	template <typename Vertex, typename Topology, typename SharpnessPolicy>
+	void refine_vertices_edgepoints_gather(uint d, const Topology& topology, const SharpnessPolicy& sharpness) ;
+	/**
+	 * @brief refine_vertices_vertexpoints_gather operates vertex point refinement on the CPU, computing each vertex point within a single thread (no atomics)
+	 * @pre vertex_halfedge_subdiv_buffers have been computed (see #refine_vertex_halfedges)
+	 * @param d current depth
+	 * @param topology face connectivity of depth d
+	 * @param sharpness edge sharpnesses of depth d
+	 */
+	template <typename Vertex, typename Topology, typename SharpnessPolicy>
+	void refine_vertices_vertexpoints_gather(uint d, const Topology& topology, const SharpnessPolicy& sharpness) ;
+
+	/**
+	 * @brief edgepoint_increment computes the contribution of halfedge h to the edge point of Edge(h)
+	 * @pre the face points of depth d+1 have been computed
+	 * @param topology face connectivity of the current depth
+	 * @param sharpness edge sharpnesses of the current depth
+	 * @param H_old halfedge buffer at the current depth
+	 * @param V_old vertex buffer at the current depth
+	 * @param V_new vertex buffer at the next depth
+	 * @param Vd number of vertices at the current depth
+	 * @param h a halfedge index
+	 * @return the contribution of h to its edge point
+	 */
+	template <typename Vertex, typename Topology, typename SharpnessPolicy>
+	Vertex edgepoint_increment(const Topology& topology, const SharpnessPolicy& sharpness, const halfedge_buffer& H_old, const Vertex* V_old, const Vertex* V_new, index_t Vd, index_t h) const ;
+
+	/**
+	 * @brief vertexpoint_increment computes the contribution of halfedge h to the vertex point of Vert(h)
+	 * @pre the face and edge points of depth d+1 have been computed
+	 * @param topology face connectivity of the current depth
+	 * @param sharpness edge sharpnesses of the current depth
+	 * @param H_old halfedge buffer at the current depth
+	 * @param V_old vertex buffer at the current depth
+	 * @param V_new vertex buffer at the next depth
+	 * @param Vd number of vertices at the current depth
+	 * @param Fd number of faces at the current depth
+	 * @param h a halfedge index
+	 * @param config the configuration of vertex Vert(h) (see #vertex_config)
+	 * @return the contribution of h to its vertex point
+	 */
+	template <typename Vertex, typename Topology, typename SharpnessPolicy>
+	Vertex vertexpoint_increment(const Topology& topology, const SharpnessPolicy& sharpness, const halfedge_buffer& H_old, const Vertex* V_old, const Vertex* V_new, index_t Vd, index_t Fd, index_t h, const VertexConfig& config) const ;
+
+	// ----------- Limit surface -----------
+	/**
+	 * @brief project_vertices_to_limit computes the limit position, normal and tangent of each vertex (see Mesh_Subdiv_CPU::project_vertices_to_limit).
+	 * Smooth vertices of valence n use the limit masks of Halstead et al. [1993]: the limit position weighs the vertex by n^2, its edge neighbors by 4 and its face neighbors by 1,
+	 * and both tangents weigh neighbors by the cosines and sines of their angle around the vertex.
+	 * @param vertex_halfedges the first outgoing halfedge of the fan of each vertex
+	 * @param limits output limit positions
+	 * @return false (with error notification) if the faces are not all quads, i.e., for an unsubdivided cage that has other polygons
+	 */
+	bool project_vertices_to_limit(const std::vector<index_t>& vertex_halfedges, vertex_buffer& limits) ;
+	/**
+	 * @brief project_vertices_to_limit computes the limit position, normal and tangent of each vertex
+	 * @param topology face connectivity of the mesh, whose faces are all quads
+	 * @param vertex_halfedges the first outgoing halfedge of the fan of each vertex
+	 * @param limits output limit positions
+	 */
+	template <typename Topology>
+	void project_vertices_to_limit(const Topology& topology, const std::vector<index_t>& vertex_halfedges, vertex_buffer& limits) ;
+
+	// ----------- Adaptive refinement -----------
+	/**
+	 * @brief is_regular_face tells if a cage face is a quad whose vertices are interior, have 4 smooth edges and only quads around them: its limit surface then is a bicubic B-spline patch
+	 * @param h_first a halfedge of the face
+	 */
+	bool is_regular_face(index_t h_first) const ;
+	/**
+	 * @brief gather_regular_patch gathers the 4x4 control points of the B-spline patch of a regular cage face (see #is_regular_face): the face and the 8 faces around it
+	 * @param h_first the halfedge of the face from the vertex of control point 5 to that of control point 6 (see Adaptive_patches::patch_points)
+	 * @param points output control points
 	 */
-	void refine_vertices_vertexpoints(uint d) ;
+	void gather_regular_patch(index_t h_first, vec3* points) const ;
 };
 
 #endif
@@ -1,39 +1,544 @@
 #include "mesh_subdiv_cpu.h"
 
+#include <algorithm>
+
 Mesh_Subdiv_CPU::Mesh_Subdiv_CPU(const std::string &filename, uint max_depth):
-	Mesh_Subdiv(filename,max_depth)
-{}
+	Mesh_Subdiv(filename,max_depth), vertex_refinement_mode(VERTEX_REFINEMENT_SCATTER), low_memory(false), level_fused(false),
+	vertex_storage(VERTEX_STORAGE_AOS), simd_isa(detect_simd_isa()), crease_storage(CREASE_STORAGE_DENSE), limit_projection(false),
+	uv_interpolation(UV_INTERPOLATION_LINEAR_BOUNDARIES), packed_vertex_width(0), stencil_evaluation(STENCIL_EVALUATION_NONE), refining_stencils(false)
+{
+	// borders lose one unit of sharpness per depth: they must remain fully sharp down to d_max
+	crease_free = d_max > 0 && d_max <= border_sharpness && has_border_creases_only() ;
+	border_crease_depth = crease_free ? 0 : d_max + 1 ;
+}
+
+void
+Mesh_Subdiv_CPU::set_vertex_refinement_mode(Vertex_refinement_mode mode)
+{
+	vertex_refinement_mode = mode ;
+}
+
+void
+Mesh_Subdiv_CPU::set_low_memory(bool low_memory)
+{
+	this->low_memory = low_memory ;
+}
+
+void
+Mesh_Subdiv_CPU::set_level_fused(bool level_fused)
+{
+	this->level_fused = level_fused ;
+}
+
+void
+Mesh_Subdiv_CPU::set_limit_projection(bool limit_projection)
+{
+	this->limit_projection = limit_projection ;
+}
+
+void
+Mesh_Subdiv_CPU::set_uv_interpolation(Uv_interpolation interpolation)
+{
+	uv_interpolation = interpolation ;
+}
+
+void
+Mesh_Subdiv_CPU::set_stencil_evaluation(Stencil_evaluation evaluation)
+{
+	// tables of the other kind are recomputed by the next subdivide_vertices
+	if (evaluation != stencil_evaluation)
+		std::vector<StencilTable>().swap(stencil_tables) ;
+	stencil_evaluation = evaluation ;
+}
+
+const std::vector<StencilTable>&
+Mesh_Subdiv_CPU::get_stencil_tables() const
+{
+	return stencil_tables ;
+}
+
+void
+Mesh_Subdiv_CPU::set_vertex_storage(Vertex_storage storage)
+{
+	vertex_storage = storage ;
+}
+
+void
+Mesh_Subdiv_CPU::set_simd_isa(Simd_isa isa)
+{
+	simd_isa = std::min(isa, detect_simd_isa()) ;
+}
+
+Simd_isa
+Mesh_Subdiv_CPU::get_simd_isa() const
+{
+	return simd_isa ;
+}
+
+void
+Mesh_Subdiv_CPU::set_crease_storage(Crease_storage storage)
+{
+	crease_storage = storage ;
+}
+
+uint
+Mesh_Subdiv_CPU::get_border_crease_depth() const
+{
+	return border_crease_depth ;
+}
+
+void
+Mesh_Subdiv_CPU::subdivide_and_time(int n_repetitions, Timing_stats& stats_he, Timing_stats& stats_cr, Timing_stats& stats_cl, Timing_stats& stats_vx)
+{
+	if (!low_memory)
+	{
+		Mesh_Subdiv::subdivide_and_time(n_repetitions, stats_he, stats_cr, stats_cl, stats_vx) ;
+		return ;
+	}
+
+	// steps are interleaved per depth, and intermediate depths are released: they cannot be repeated
+	std::cerr << "WARNING Mesh_Subdiv_CPU::subdivide_and_time: steps are not timed in low-memory mode" << std::endl ;
+	subdivide() ;
+}
+
+void
+Mesh_Subdiv_CPU::subdivide_and_time_levels(int n_repetitions, std::vector<Timing_stats>& stats_topology, std::vector<Timing_stats>& stats_vertices)
+{
+	if (finalized)
+		return ;
+
+	if (low_memory)
+	{
+		std::cerr << "WARNING Mesh_Subdiv_CPU::subdivide_and_time_levels: depths are not timed in low-memory mode" << std::endl ;
+		subdivide() ;
+		return ;
+	}
+
+	allocate_subdiv_buffers() ;
+
+	std::vector<std::vector<double>> t_topology(d_max, std::vector<double>(n_repetitions)) ;
+	std::vector<std::vector<double>> t_vertices(d_max, std::vector<double>(n_repetitions)) ;
+	for (int i = 0 ; i < n_repetitions ; ++i)
+	{
+		clear_vertex_subdiv_buffers() ;
+		if (uses_vertex_halfedges())
+			compute_cage_vertex_halfedges() ;
+
+		for (uint d = 0 ; d < d_max ; ++d)
+		{
+			set_current_depth(d) ;
+
+			auto start = timer::now() ;
+			refine_topology_level(d) ;
+			if (has_uvs())
+				refine_uvs_level(d) ;
+			auto stop = timer::now() ;
+			t_topology[d][i] = duration(stop - start).count() ;
+
+			start = timer::now() ;
+			refine_vertices_depth(d) ;
+			stop = timer::now() ;
+			t_vertices[d][i] = duration(stop - start).count() ;
+		}
+	}
+	set_current_depth(d_max) ;
+
+	readback_from_subdiv_buffers() ;
+
+	finalize_subdivision() ;
+
+	stats_topology.resize(d_max) ;
+	stats_vertices.resize(d_max) ;
+	for (uint d = 0 ; d < d_max ; ++d)
+	{
+		Timing_stats::compute_stats(t_topology[d], stats_topology[d]) ;
+		Timing_stats::compute_stats(t_vertices[d], stats_vertices[d]) ;
+	}
+}
+
+void
+Mesh_Subdiv_CPU::subdivide_and_time_total(int n_repetitions, Timing_stats& stats)
+{
+	if (finalized)
+		return ;
+
+	std::vector<double> times(n_repetitions) ;
+	for (int i = 0 ; i < n_repetitions ; ++i)
+	{
+		// low-memory refinement releases depth 0: it is copied again from the cage, once the previous depth d_max is released
+		if (i > 0 && low_memory)
+			release_subdiv_level(d_max) ;
+		if (i == 0 || low_memory)
+			allocate_subdiv_buffers() ;
+		else
+			clear_vertex_subdiv_buffers() ;
+
+		auto start = timer::now() ;
+		refine() ;
+		auto stop = timer::now() ;
+		times[i] = duration(stop - start).count() ;
+	}
+	set_current_depth(d_max) ;
+
+	readback_from_subdiv_buffers() ;
+
+	finalize_subdivision() ;
+
+	Timing_stats::compute_stats(times, stats) ;
+}
 
 void
 Mesh_Subdiv_CPU::allocate_subdiv_buffers()
 {
 	halfedge_subdiv_buffers.resize(d_max + 1) ;
 	crease_subdiv_buffers.resize(d_max + 1) ;
+	sparse_crease_subdiv_buffers.resize(d_max + 1) ;
 	vertex_subdiv_buffers.resize(d_max + 1) ;
+	vertex_soa_subdiv_buffers.resize(d_max + 1) ;
+	uv_subdiv_buffers.resize(has_uvs() ? d_max + 1 : 0) ;
+	border_crease_depth = crease_free ? 0 : d_max + 1 ;
+
+	// vertex attributes follow the position of each vertex, padded to a width the kernels are instantiated for
+	const int attribute_width = has_vertex_attributes() ? vertex_attribute_width() : 0 ;
+	packed_vertex_width = attribute_width == 0 ? 0 : attribute_width <= 1 ? 4 : attribute_width <= 5 ? 8 : 16 ;
+	packed_vertex_subdiv_buffers.resize(packed_vertex_width > 0 ? d_max + 1 : 0) ;
 
 	uint d = 0 ;
 	halfedge_subdiv_buffers[d]	= halfedges ;
-	crease_subdiv_buffers[d]	= creases	;
-	vertex_subdiv_buffers[d]	= vertices	;
+	if (packed_vertex_width > 0)
+		pack_vertices(packed_vertex_subdiv_buffers[d]) ;
+	else
+		vertex_subdiv_buffers[d]	= vertices	;
+	if (has_uvs())
+		uv_subdiv_buffers[d] = uvs ;
+	if (uses_dense_creases())
+		crease_subdiv_buffers[d] = creases ;
+	else if (!crease_free)
+		sparse_crease_subdiv_buffers[d].from_dense(creases) ;
+
+	// deeper levels are allocated on the fly in low-memory mode
+	if (low_memory)
+		return ;
 
 	for (d = 1 ; d <= d_max ; ++d)
+		allocate_subdiv_level(d) ;
+}
+
+void
+Mesh_Subdiv_CPU::allocate_subdiv_level(uint d)
+{
+	const index_t Hd = H(d) ;
+	const index_t Vd = V(d) ;
+	const index_t Cd = C(d) ;
+
+	// buffers of the scratch meshes of adaptive refinement are reused: creases and accumulated vertices are reset
+	// (sparse creases are allocated by refine_creases_level, whose output size depends on the sharp creases)
+	halfedge_subdiv_buffers[d].resize(Hd);
+	if (uses_dense_creases() && !border_creases_only(d))
+		crease_subdiv_buffers[d].assign(Cd, Crease());
+	if (vertices_in_soa(d))
+		vertex_soa_subdiv_buffers[d].resize(Vd) ;
+	else if (packed_vertex_width > 0)
+		packed_vertex_subdiv_buffers[d].assign(size_t(packed_vertex_width) * Vd, 0.0f) ;
+	else
+		vertex_subdiv_buffers[d].assign(Vd,{0.0f,0.0f,0.0f});
+	if (has_uvs())
+		uv_subdiv_buffers[d].resize(Hd) ;
+}
+
+void
+Mesh_Subdiv_CPU::release_subdiv_level(uint d)
+{
+	// swapping with empty buffers frees memory, unlike clear()
+	halfedge_buffer().swap(halfedge_subdiv_buffers[d]) ;
+	crease_buffer().swap(crease_subdiv_buffers[d]) ;
+	if (d < sparse_crease_subdiv_buffers.size())
+		sparse_crease_subdiv_buffers[d].release() ;
+	vertex_buffer().swap(vertex_subdiv_buffers[d]) ;
+	vertex_soa_subdiv_buffers[d].release() ;
+	if (d < vertex_halfedge_subdiv_buffers.size())
+		std::vector<index_t>().swap(vertex_halfedge_subdiv_buffers[d]) ;
+	if (d < uv_subdiv_buffers.size())
+		uv_buffer().swap(uv_subdiv_buffers[d]) ;
+	if (d < packed_vertex_subdiv_buffers.size())
+		std::vector<float>().swap(packed_vertex_subdiv_buffers[d]) ;
+}
+
+void
+Mesh_Subdiv_CPU::pack_vertices(std::vector<float>& packed) const
+{
+	const index_t Vd = vertices.size() ;
+	const int width = packed_vertex_width ;
+	const int attribute_width = vertex_attribute_width() ;
+	packed.assign(size_t(width) * Vd, 0.0f) ;
+
+	_PARALLEL_FOR
+	for (index_t v = 0 ; v < Vd ; ++v)
+	{
+		for (int i = 0 ; i < 3 ; ++i)
+			packed[width * v + i] = vertices[v][i] ;
+		for (int i = 0 ; i < attribute_width ; ++i)
+			packed[width * v + 3 + i] = attributes[attribute_width * v + i] ;
+	}
+	_BARRIER
+}
+
+void
+Mesh_Subdiv_CPU::unpack_vertices(const std::vector<float>& packed, index_t Vd)
+{
+	const int width = packed_vertex_width ;
+	const int attribute_width = vertex_attribute_width() ;
+	vertices.resize(Vd) ;
+	attributes.resize(size_t(attribute_width) * Vd) ;
+
+	_PARALLEL_FOR
+	for (index_t v = 0 ; v < Vd ; ++v)
+	{
+		for (int i = 0 ; i < 3 ; ++i)
+			vertices[v][i] = packed[width * v + i] ;
+		for (int i = 0 ; i < attribute_width ; ++i)
+			attributes[attribute_width * v + i] = packed[width * v + 3 + i] ;
+	}
+	_BARRIER
+}
+
+void
+Mesh_Subdiv_CPU::subdivide_vertices(const std::vector<vec3>& cage_vertices)
+{
+	if (index_t(cage_vertices.size()) != V_count_cage)
+	{
+		std::cerr << "ERROR Mesh_Subdiv_CPU::subdivide_vertices: the vertex buffer does not match the cage" << std::endl ;
+		return ;
+	}
+
+	if (low_memory)
+	{
+		std::cerr << "ERROR Mesh_Subdiv_CPU::subdivide_vertices: not available in low-memory mode" << std::endl ;
+		return ;
+	}
+
+	// halfedge and crease subdivision buffers are computed once and for all
+	if (!finalized)
+		subdivide() ;
+
+	restore_cage_counters() ;
+
+	// the packed cage keeps its vertex attributes
+	if (packed_vertex_width > 0)
+	{
+		std::vector<float>& packed = packed_vertex_subdiv_buffers[0] ;
+		const int width = packed_vertex_width ;
+		for (index_t v = 0 ; v < index_t(V_count_cage) ; ++v)
+			for (int i = 0 ; i < 3 ; ++i)
+				packed[width * v + i] = cage_vertices[v][i] ;
+	}
+	else
+		vertex_subdiv_buffers[0] = cage_vertices ;
+
+	if (stencil_evaluation != STENCIL_EVALUATION_NONE)
+	{
+		if (stencil_tables.empty())
+			compute_stencil_tables() ;
+		evaluate_stencil_tables(cage_vertices) ;
+		set_current_depth(d_max) ;
+	}
+	else
+	{
+		clear_vertex_subdiv_buffers() ;
+
+		refine_vertices() ;
+		set_current_depth(d_max) ;
+
+		if (vertices_in_soa(d_max))
+			vertex_soa_subdiv_buffers[d_max].to_aos(vertices) ;
+		else if (packed_vertex_width > 0)
+			unpack_vertices(packed_vertex_subdiv_buffers[d_max], V(d_max)) ;
+		else
+			vertices = vertex_subdiv_buffers[d_max] ;
+	}
+	project_to_limit() ;
+
+	finalize_subdivision() ;
+}
+
+void
+Mesh_Subdiv_CPU::subdivide_vertices_and_time(int n_repetitions, Timing_stats& stats)
+{
+	if (low_memory)
+	{
+		std::cerr << "ERROR Mesh_Subdiv_CPU::subdivide_vertices_and_time: not available in low-memory mode" << std::endl ;
+		return ;
+	}
+
+	if (!finalized)
+		subdivide() ;
+
+	// the cage positions are kept at depth 0
+	vertex_buffer cage_vertices(V_count_cage) ;
+	if (packed_vertex_width > 0)
+	{
+		const std::vector<float>& packed = packed_vertex_subdiv_buffers[0] ;
+		const int width = packed_vertex_width ;
+		for (index_t v = 0 ; v < index_t(V_count_cage) ; ++v)
+			cage_vertices[v] = vec3(packed[width * v], packed[width * v + 1], packed[width * v + 2]) ;
+	}
+	else
+		cage_vertices = vertex_subdiv_buffers[0] ;
+
+	// the first refinement computes the stencil tables, if any
+	subdivide_vertices(cage_vertices) ;
+
+	std::vector<double> times(n_repetitions) ;
+	for (int i = 0 ; i < n_repetitions ; ++i)
+	{
+		auto start = timer::now() ;
+		subdivide_vertices(cage_vertices) ;
+		auto stop = timer::now() ;
+		times[i] = duration(stop - start).count() ;
+	}
+
+	Timing_stats::compute_stats(times, stats) ;
+}
+
+void
+Mesh_Subdiv_CPU::clear_vertex_subdiv_buffers()
+{
+	// gathering overwrites all refined vertices
+	if (vertex_refinement_mode == VERTEX_REFINEMENT_GATHER)
+		return ;
+
+	// SoA kernels gather too
+	for (uint d = 1 ; d <= d_max && !vertices_in_soa(d) ; ++d)
 	{
-		const uint Hd = H(d) ;
-		const uint Vd = V(d) ;
-		const uint Cd = C(d) ;
+		if (packed_vertex_width > 0)
+		{
+			std::vector<float>& Px = packed_vertex_subdiv_buffers[d] ;
+			const size_t Pd = Px.size() ;
+
+			_PARALLEL_FOR
+			for (size_t i = 0 ; i < Pd ; ++i)
+				Px[i] = 0.0f ;
+			_BARRIER
+			continue ;
+		}
+
+		vertex_buffer& Vx = vertex_subdiv_buffers[d] ;
+		const index_t Vd = V(d) ;
+
+		_PARALLEL_FOR
+		for (index_t v_id = 0 ; v_id < Vd ; ++v_id)
+			Vx[v_id] = vec3(0.0f, 0.0f, 0.0f) ;
+		_BARRIER
+	}
+}
 
-		halfedge_subdiv_buffers[d].resize(Hd);
-		crease_subdiv_buffers[d].resize(Cd);
-		vertex_subdiv_buffers[d].resize(Vd,{0.0f,0.0f,0.0f});
+void
+Mesh_Subdiv_CPU::compute_cage_vertex_halfedges()
+{
+	set_current_depth(0) ;
+	vertex_halfedge_subdiv_buffers.resize(d_max + 1) ;
+	vertex_halfedge_subdiv_buffers[0].resize(V(0)) ;
+
+	compute_vertex_halfedges(halfedge_subdiv_buffers[0], vertex_halfedge_subdiv_buffers[0]) ;
+}
+
+void
+Mesh_Subdiv_CPU::refine_vertex_halfedges()
+{
+	compute_cage_vertex_halfedges() ;
+
+	for (uint d = 0 ; d < d_max; ++d)
+	{
+		set_current_depth(d) ;
+		refine_vertex_halfedges_level(d) ;
 	}
 }
 
 void
 Mesh_Subdiv_CPU::readback_from_subdiv_buffers()
 {
-	halfedges	= halfedge_subdiv_buffers[d_max] ;
-	creases		= crease_subdiv_buffers[d_max] ;
-	vertices	= vertex_subdiv_buffers[d_max] ;
+	// crease-free meshes, and meshes whose semi-sharp creases all decayed, only compute the creases of depth d_max from its borders
+	if (border_creases_only(d_max))
+		compute_border_creases(d_max) ;
+	// sparse creases are expanded for the mesh
+	else if (!uses_dense_creases())
+		sparse_crease_subdiv_buffers[d_max].to_dense(crease_subdiv_buffers[d_max], C(d_max)) ;
+
+	const bool with_uvs = has_uvs() ;
+	if (low_memory)
+	{
+		halfedges	= std::move(halfedge_subdiv_buffers[d_max]) ;
+		creases		= std::move(crease_subdiv_buffers[d_max]) ;
+		if (vertices_in_soa(d_max))
+			vertex_soa_subdiv_buffers[d_max].to_aos(vertices) ;
+		else if (packed_vertex_width > 0)
+			unpack_vertices(packed_vertex_subdiv_buffers[d_max], V(d_max)) ;
+		else
+			vertices = std::move(vertex_subdiv_buffers[d_max]) ;
+		if (with_uvs)
+			uvs		= std::move(uv_subdiv_buffers[d_max]) ;
+		release_subdiv_level(d_max) ;
+	}
+	else
+	{
+		halfedges	= halfedge_subdiv_buffers[d_max] ;
+		creases		= crease_subdiv_buffers[d_max] ;
+		if (vertices_in_soa(d_max))
+			vertex_soa_subdiv_buffers[d_max].to_aos(vertices) ;
+		else if (packed_vertex_width > 0)
+			unpack_vertices(packed_vertex_subdiv_buffers[d_max], V(d_max)) ;
+		else
+			vertices = vertex_subdiv_buffers[d_max] ;
+		if (with_uvs)
+			uvs		= uv_subdiv_buffers[d_max] ;
+	}
+
+	project_to_limit() ;
+}
+
+// ----------- Refinement over all depths -----------
+void
+Mesh_Subdiv_CPU::refine()
+{
+	if (low_memory || level_fused)
+		refine_level_fused() ;
+	else
+		Mesh_Subdiv::refine() ;
+}
+
+void
+Mesh_Subdiv_CPU::refine_level_fused()
+{
+	if (uses_vertex_halfedges())
+		compute_cage_vertex_halfedges() ;
+
+	for (uint d = 0 ; d < d_max; ++d)
+	{
+		set_current_depth(d) ;
+		if (low_memory)
+			allocate_subdiv_level(d + 1) ;
+
+		refine_topology_level(d) ;
+		if (has_uvs())
+			refine_uvs_level(d) ;
+		refine_vertices_depth(d) ;
+
+		if (low_memory)
+			release_subdiv_level(d) ;
+	}
+	set_current_depth(d_max) ;
+}
+
+void
+Mesh_Subdiv_CPU::refine_halfedges()
+{
+	for (uint d = 0 ; d < d_max; ++d)
+	{
+		set_current_depth(d) ;
+		refine_halfedges_level(d) ;
+		if (has_uvs())
+			refine_uvs_level(d) ;
+	}
 }
 
 void
@@ -42,42 +547,596 @@ Mesh_Subdiv_CPU::refine_creases()
 	for (uint d = 0 ; d < d_max; ++d)
 	{
 		set_current_depth(d) ;
-		const crease_buffer& C_old = crease_subdiv_buffers[d] ;
-		crease_buffer& C_new = crease_subdiv_buffers[d + 1] ;
-		const uint Cd = C(d) ;
+		refine_creases_level(d) ;
+	}
+}
 
-		_PARALLEL_FOR
-		for (int c_id = 0; c_id < Cd; ++c_id)
+void
+Mesh_Subdiv_CPU::compute_stencil_tables()
+{
+	// stencils are refined by the gathering kernels, which walk the vertex fans
+	if (vertex_halfedge_subdiv_buffers.empty())
+		refine_vertex_halfedges() ;
+
+	const bool composed = stencil_evaluation == STENCIL_EVALUATION_COMPOSED ;
+	stencil_tables.clear() ;
+	stencil_subdiv_buffers.resize(d_max + 1) ;
+	refining_stencils = true ;
+
+	for (uint d = 0 ; d <= d_max ; ++d)
+	{
+		set_current_depth(d) ;
+		std::vector<Stencil>& S_old = stencil_subdiv_buffers[d] ;
+
+		// per-level stencils start over from the vertices of each depth, composed ones from those of the cage
+		if (d == 0 || (!composed && d < d_max))
 		{
-			Crease& c0 = C_new[2*c_id + 0] ;
-			Crease& c1 = C_new[2*c_id + 1] ;
-			if (is_crease_edge(C_old,c_id))
-			{
-				const int c_next_id = C_old[c_id].Next ;
-				const int c_prev_id = C_old[c_id].Prev ;
-				const bool b1 = c_id == C_old[c_next_id].Prev && c_id != c_next_id ;
-				const bool b2 = c_id == C_old[c_prev_id].Next && c_id != c_prev_id;
-				const float thisS = 3.0f * C_old[c_id].Sharpness ;
-				const float nextS = C_old[c_next_id].Sharpness ;
-				const float prevS = C_old[c_prev_id].Sharpness ;
-
-				c0.Next = 2*c_id + 1 ;
-				c1.Next = 2 * c_next_id + (b1 ? 0 : 1) ;
-
-				c0.Prev = 2 * c_prev_id + (b2 ? 1 : 0) ;
-				c1.Prev = 2*c_id + 0 ;
-
-				c0.Sharpness = std::max(0.0f, 0.250f * (prevS + thisS ) - 1.0f) ;
-				c1.Sharpness = std::max(0.0f, 0.250f * (nextS + thisS ) - 1.0f) ;
-			}
-			else
+			const index_t Vd = V(d) ;
+			S_old.resize(Vd) ;
+
+			_PARALLEL_FOR
+			for (index_t v = 0 ; v < Vd ; ++v)
+				S_old[v] = Stencil(v) ;
+			_BARRIER
+		}
+		if (d == d_max)
+			break ;
+
+		stencil_subdiv_buffers[d + 1].assign(V(d + 1), Stencil()) ;
+		refine_vertices_level(d) ;
+		std::vector<Stencil>().swap(S_old) ;
+
+		if (!composed)
+		{
+			stencil_tables.emplace_back() ;
+			stencil_tables.back().assign(stencil_subdiv_buffers[d + 1], V(d)) ;
+		}
+	}
+
+	if (composed)
+	{
+		stencil_tables.emplace_back() ;
+		stencil_tables.back().assign(stencil_subdiv_buffers[d_max], V(0)) ;
+	}
+
+	refining_stencils = false ;
+	std::vector<std::vector<Stencil>>().swap(stencil_subdiv_buffers) ;
+	set_current_depth(d_max) ;
+}
+
+void
+Mesh_Subdiv_CPU::evaluate_stencil_tables(const vertex_buffer& cage_vertices)
+{
+	// intermediate depths of per-level tables are written to the vertex subdivision buffers, the last one to the mesh
+	const size_t n_tables = stencil_tables.size() ;
+	if (n_tables == 0)
+		vertices = cage_vertices ;
+	for (size_t d = 0 ; d < n_tables ; ++d)
+	{
+		const StencilTable& table = stencil_tables[d] ;
+		const vertex_buffer& V_old = d == 0 ? cage_vertices : vertex_subdiv_buffers[d] ;
+		vertex_buffer& V_new = d + 1 == n_tables ? vertices : vertex_subdiv_buffers[d + 1] ;
+
+		V_new.resize(table.row_count()) ;
+		table.evaluate(V_old.data(), V_new.data()) ;
+	}
+}
+
+void
+Mesh_Subdiv_CPU::refine_vertices()
+{
+	if (uses_vertex_halfedges() && vertex_halfedge_subdiv_buffers.empty())
+		refine_vertex_halfedges() ;
+
+	for (uint d = 0 ; d < d_max; ++d)
+	{
+		set_current_depth(d) ;
+		refine_vertices_depth(d) ;
+	}
+	set_current_depth(d_max) ;
+}
+
+// ----------- Refinement of a single depth -----------
+void
+Mesh_Subdiv_CPU::refine_creases_level(uint d)
+{
+	// see compute_border_creases
+	if (border_creases_only(d))
+		return ;
+
+	if (!uses_dense_creases())
+	{
+		refine_sparse_creases_level(d) ;
+		return ;
+	}
+
+	const crease_buffer& C_old = crease_subdiv_buffers[d] ;
+	crease_buffer& C_new = crease_subdiv_buffers[d + 1] ;
+	const index_t Cd = C(d) ;
+
+	float max_sharpness = 0.0f ;
+	_PARALLEL_FOR_REDUCTION(max, max_sharpness)
+	for (index_t c_id = 0; c_id < Cd; ++c_id)
+	{
+		refine_crease(C_old, C_new, c_id) ;
+		max_sharpness = std::max(max_sharpness, decaying_sharpness(C_new, c_id, d)) ;
+	}
+	_BARRIER
+
+	update_border_crease_depth(d + 1, max_sharpness) ;
+}
+
+void
+Mesh_Subdiv_CPU::refine_sparse_creases_level(uint d)
+{
+	const SparseCreaseBuffer& S_old = sparse_crease_subdiv_buffers[d] ;
+	SparseCreaseBuffer& S_new = sparse_crease_subdiv_buffers[d + 1] ;
+	const index_t n_old = S_old.count() ;
+
+	// sharp creases have two children, the others none: smooth children are kept one depth, as neighbors of sharp creases
+	std::vector<index_t> offsets(n_old) ;
+	_PARALLEL_FOR
+	for (index_t c = 0 ; c < n_old ; ++c)
+		offsets[c] = S_old.creases[c].Sharpness > _epsilon_ ? 2 : 0 ;
+	_BARRIER
+	S_new.resize(exclusive_scan_parallel(offsets)) ;
+
+	// children of edge e are edges 2e and 2e+1: they remain sorted
+	_PARALLEL_FOR
+	for (index_t c = 0 ; c < n_old ; ++c)
+	{
+		const Crease& cr = S_old.creases[c] ;
+		if (cr.Sharpness <= _epsilon_)
+			continue ;
+
+		const index_t c_id = S_old.edges[c] ;
+		const index_t c_new = offsets[c] ;
+		S_new.edges[c_new + 0] = 2*c_id + 0 ;
+		S_new.edges[c_new + 1] = 2*c_id + 1 ;
+		refine_sharp_crease(c_id, cr, S_old.crease(cr.Next), S_old.crease(cr.Prev), S_new.creases[c_new + 0], S_new.creases[c_new + 1]) ;
+	}
+	_BARRIER
+
+	S_new.build_table() ;
+}
+
+void
+Mesh_Subdiv_CPU::compute_border_creases(uint d)
+{
+	const halfedge_buffer& H_d = halfedge_subdiv_buffers[d] ;
+	crease_buffer& C_d = crease_subdiv_buffers[d] ;
+	const index_t Hd = H(d) ;
+	const int n = constant_face_size() ;
+
+	// refine_crease lowers the sharpness of a border by one per depth, its neighbors being equally sharp borders
+	const float sharpness = border_sharpness - float(d) ;
+
+	C_d.assign(C(d), Crease()) ;
+
+	_PARALLEL_FOR
+	for (index_t h_id = 0 ; h_id < Hd ; ++h_id)
+	{
+		if (Twin(H_d, h_id) < 0)
+			C_d[Edge(H_d, h_id)] = border_crease(H_d, n, sharpness, h_id) ;
+	}
+	_BARRIER
+}
+
+Crease
+Mesh_Subdiv_CPU::border_crease(const halfedge_buffer& H_d, int n, float sharpness, index_t h_id) const
+{
+	const auto next = [n](index_t h) { return h % n == n - 1 ? h - (n - 1) : h + 1 ; } ;
+	const auto prev = [n](index_t h) { return h % n == 0 ? h + (n - 1) : h - 1 ; } ;
+
+	// the neighbors of a border edge are the border edges incoming to its first vertex and outgoing from its last vertex
+	index_t h_prev = prev(h_id) ;
+	while (Twin(H_d, h_prev) >= 0)
+		h_prev = prev(Twin(H_d, h_prev)) ;
+
+	index_t h_next = next(h_id) ;
+	while (Twin(H_d, h_next) >= 0)
+		h_next = next(Twin(H_d, h_next)) ;
+
+	Crease c ;
+	c.Sharpness = sharpness ;
+	c.Prev = Edge(H_d, h_prev) ;
+	c.Next = Edge(H_d, h_next) ;
+	return c ;
+}
+
+void
+Mesh_Subdiv_CPU::update_border_crease_depth(uint d, float max_sharpness)
+{
+	// borders must remain fully sharp down to d_max (see crease_free), and depth d_max has nothing left to refine
+	if (max_sharpness > 0.0f || d >= border_crease_depth || d >= d_max || d_max > border_sharpness)
+		return ;
+
+	const halfedge_buffer& H_d = halfedge_subdiv_buffers[d] ;
+	const crease_buffer& C_d = crease_subdiv_buffers[d] ;
+	const index_t Hd = H(d) ;
+	const index_t Cd = C(d) ;
+	const int n = Hd / F(d) ; // faces of refined depths all have the same size
+	const float sharpness = border_sharpness - float(d) ;
+
+	// sharp creases may remain inside the mesh, and borders may keep other neighbors (e.g., where a crease tag meets a border)
+	bool border_only = true ;
+	_PARALLEL_FOR_REDUCTION(&&, border_only)
+	for (index_t h_id = 0 ; h_id < Hd ; ++h_id)
+	{
+		// edges beyond the crease buffer are smooth (see Mesh::Sharpness), and never borders
+		const index_t e_id = Edge(H_d, h_id) ;
+		if (e_id >= Cd)
+			continue ;
+
+		const Crease& c = C_d[e_id] ;
+		if (Twin(H_d, h_id) >= 0)
+		{
+			border_only = border_only && c.Sharpness == 0.0f ;
+			continue ;
+		}
+
+		const Crease b = border_crease(H_d, n, sharpness, h_id) ;
+		border_only = border_only && c.Sharpness == b.Sharpness && c.Prev == b.Prev && c.Next == b.Next ;
+	}
+	_BARRIER
+
+	if (border_only)
+		border_crease_depth = d ;
+}
+
+bool
+Mesh_Subdiv_CPU::uses_dense_creases() const
+{
+	return !crease_free && crease_storage == CREASE_STORAGE_DENSE ;
+}
+
+bool
+Mesh_Subdiv_CPU::border_creases_only(uint d) const
+{
+	return d >= border_crease_depth ;
+}
+
+void
+Mesh_Subdiv_CPU::refine_topology_level(uint d)
+{
+	refine_halfedges_level(d) ;
+	refine_creases_level(d) ;
+	if (uses_vertex_halfedges())
+		refine_vertex_halfedges_level(d) ;
+}
+
+// ----------- Refinement of a single depth in SoA mode -----------
+bool
+Mesh_Subdiv_CPU::vertices_in_soa(uint d) const
+{
+	// the SoA kernels refine positions only: vertex attributes are refined by the AoS ones
+	return vertex_storage == VERTEX_STORAGE_SOA && packed_vertex_width == 0 && d > soa_first_depth() ;
+}
+
+void
+Mesh_Subdiv_CPU::refine_vertices_depth(uint d)
+{
+	if (!vertices_in_soa(d + 1))
+	{
+		refine_vertices_level(d) ;
+		return ;
+	}
+
+	// the first SoA depth is computed by the AoS kernels (or is the cage)
+	if (!vertices_in_soa(d))
+		vertex_soa_subdiv_buffers[d].from_aos(vertex_subdiv_buffers[d]) ;
+
+	refine_vertices_level_soa(d) ;
+}
+
+SoaRefinementLevel
+Mesh_Subdiv_CPU::soa_refinement_level(uint d)
+{
+	SoaRefinementLevel level ;
+	level.halfedges = halfedge_subdiv_buffers[d].data() ;
+	level.creases = border_creases_only(d) ? nullptr : crease_subdiv_buffers[d].data() ;
+	level.crease_table = nullptr ;
+	level.crease_table_bits = 0 ;
+	level.vertex_halfedges = vertex_halfedge_subdiv_buffers[d].data() ;
+	for (int c = 0 ; c < 3 ; ++c)
+	{
+		level.old_xyz[c] = vertex_soa_subdiv_buffers[d].xyz[c].data() ;
+		level.new_xyz[c] = vertex_soa_subdiv_buffers[d+1].xyz[c].data() ;
+	}
+
+	level.H = H(d) ;
+	level.V = V(d) ;
+	level.E = E(d) ;
+	level.F = F(d) ;
+	level.C = C(d) ;
+	if (!crease_free && !uses_dense_creases())
+	{
+		const SparseCreaseBuffer& S = sparse_crease_subdiv_buffers[d] ;
+		level.creases = S.creases.data() ;
+		level.crease_table = S.table.data() ;
+		level.crease_table_bits = S.table_bits ;
+		level.C = S.count() ;
+	}
+
+	level.beta_table = nullptr ;
+	level.beta_table_size = 0 ;
+	return level ;
+}
+
+// ----------- Tile extraction -----------
+void
+Mesh_Subdiv_CPU::extract_tile(const std::vector<index_t>& tile_face_ids, const std::vector<index_t>& face_halfedges, const std::vector<index_t>& vertex_halfedges, const halfedge_buffer_cage& He_cage, Mesh_Subdiv_CPU& tile, Tile_map& map, Tile_index& index) const
+{
+	const halfedge_buffer& He = halfedges ;
+
+	// the index is sized to this mesh once, and only the entries of the tile elements are reset before returning
+	for (const auto& buffer_size: {std::make_pair(&index.halfedges, He.size()), std::make_pair(&index.vertices, vertices.size()),
+								   std::make_pair(&index.edges, size_t(E_count)), std::make_pair(&index.faces, face_halfedges.size())})
+	{
+		if (buffer_size.first->size() != buffer_size.second)
+			buffer_size.first->assign(buffer_size.second, -1) ;
+	}
+
+	// elements are collected once each, marked in the index, then sorted
+	const auto collect = [](std::vector<index_t>& elements, std::vector<index_t>& element_index, index_t id)
+	{
+		if (element_index[id] < 0)
+		{
+			element_index[id] = 0 ;
+			elements.push_back(id) ;
+		}
+	} ;
+	const auto sort_and_index = [](std::vector<index_t>& elements, std::vector<index_t>& element_index)
+	{
+		if (!std::is_sorted(elements.begin(), elements.end()))
+			std::sort(elements.begin(), elements.end()) ;
+		const index_t n = elements.size() ;
+		for (index_t i = 0 ; i < n ; ++i)
+			element_index[elements[i]] = i ;
+	} ;
+
+	// faces of the tile, and faces around their vertices
+	std::vector<index_t> faces ;
+	for (const index_t f: tile_face_ids)
+	{
+		const index_t h_first = face_halfedges[f] ;
+		index_t h = h_first ;
+		do
+		{
+			index_t h_it = h ;
+			do
 			{
-				c0.Sharpness = 0.0f ;
-				c1.Sharpness = 0.0f ;
+				collect(faces, index.faces, Face(He_cage, h_it)) ;
+				const index_t twin_id = Twin(He, h_it) ;
+				h_it = twin_id < 0 ? twin_id : Next(He_cage, twin_id) ;
 			}
+			while (h_it >= 0 && h_it != h) ;
+
+			if (h_it < 0) // do backward iteration too, up to the border
+				for (h_it = Twin(He, Prev(He_cage, h)) ; h_it >= 0 ; h_it = Twin(He, Prev(He_cage, h_it)))
+					collect(faces, index.faces, Face(He_cage, h_it)) ;
+
+			h = Next(He_cage, h) ;
 		}
-		_BARRIER
+		while (h != h_first) ;
+	}
+	sort_and_index(faces, index.faces) ;
+
+	// halfedges, vertices and edges of these faces
+	std::vector<index_t> tile_halfedges, tile_vertices, tile_edges ;
+	for (const index_t f: faces)
+	{
+		const index_t h_first = face_halfedges[f] ;
+		index_t h = h_first ;
+		do
+		{
+			tile_halfedges.push_back(h) ;
+			collect(tile_vertices, index.vertices, Vert(He, h)) ;
+			collect(tile_edges, index.edges, Edge(He, h)) ;
+			h = Next(He_cage, h) ;
+		}
+		while (h != h_first) ;
+	}
+	sort_and_index(tile_halfedges, index.halfedges) ;
+	sort_and_index(tile_vertices, index.vertices) ;
+	sort_and_index(tile_edges, index.edges) ;
+
+	const index_t Ht = tile_halfedges.size() ;
+	const index_t Vt = tile_vertices.size() ;
+	const index_t Et = tile_edges.size() ;
+	const index_t Ft = faces.size() ;
+
+	tile.halfedges.resize(Ht) ;
+	tile.halfedges_cage.resize(Ht) ;
+	tile.vertices.resize(Vt) ;
+	tile.creases.resize(Et) ;
+	tile.uvs.resize(has_uvs() ? Ht : 0) ;
+	const int attribute_width = has_vertex_attributes() ? vertex_attribute_width() : 0 ;
+	tile.attributes.resize(size_t(attribute_width) * Vt) ;
+	map.halfedges.resize(Ht) ;
+	map.vertices.resize(Vt) ;
+	map.edges.resize(Et) ;
+	map.faces.resize(Ft) ;
+
+	_PARALLEL_FOR
+	for (index_t f = 0 ; f < Ft ; ++f)
+	{
+		const bool is_tile_face = std::binary_search(tile_face_ids.begin(), tile_face_ids.end(), faces[f]) ;
+		map.faces[f] = is_tile_face ? faces[f] : ~faces[f] ;
+	}
+	_BARRIER
+
+	_PARALLEL_FOR
+	for (index_t e = 0 ; e < Et ; ++e)
+	{
+		// edges beyond the crease buffer are smooth (see Mesh::Sharpness)
+		const index_t e_id = tile_edges[e] ;
+		const Crease c = e_id < index_t(creases.size()) ? creases[e_id] : Crease{0.0f, e_id, e_id} ;
+		const index_t c_next = index.edges[c.Next] ;
+		const index_t c_prev = index.edges[c.Prev] ;
+
+		tile.creases[e].Sharpness = c.Sharpness ;
+		tile.creases[e].Next = c_next < 0 ? e : c_next ;
+		tile.creases[e].Prev = c_prev < 0 ? e : c_prev ;
+		map.edges[e] = ~e_id ;
 	}
+	_BARRIER
+
+	_PARALLEL_FOR
+	for (index_t h = 0 ; h < Ht ; ++h)
+	{
+		const index_t h_id = tile_halfedges[h] ;
+		const index_t twin_id = Twin(He, h_id) ;
+
+		HalfEdge& he = tile.halfedges[h] ;
+		he.Twin = twin_id < 0 ? twin_id : index.halfedges[twin_id] ;
+		he.Vert = index.vertices[Vert(He, h_id)] ;
+		he.Edge = index.edges[Edge(He, h_id)] ;
+
+		HalfEdge_cage& he_cage = tile.halfedges_cage[h] ;
+		he_cage.Next = index.halfedges[Next(He_cage, h_id)] ;
+		he_cage.Prev = index.halfedges[Prev(He_cage, h_id)] ;
+		he_cage.Face = index.faces[Face(He_cage, h_id)] ;
+
+		if (!tile.uvs.empty())
+			tile.uvs[h] = uvs[h_id] ;
+
+		// the face of the halfedge owning an edge (see compute_and_set_edges) owns it too
+		const bool is_owned = map.faces[he_cage.Face] >= 0 ;
+		map.halfedges[h] = is_owned ? h_id : ~h_id ;
+		if (is_owned && (twin_id < 0 || twin_id > h_id))
+			map.edges[he.Edge] = Edge(He, h_id) ;
+	}
+	_BARRIER
+
+	_PARALLEL_FOR
+	for (index_t v = 0 ; v < Vt ; ++v)
+	{
+		const index_t v_id = tile_vertices[v] ;
+		tile.vertices[v] = vertices[v_id] ;
+		for (int i = 0 ; i < attribute_width ; ++i)
+			tile.attributes[attribute_width * v + i] = attributes[attribute_width * v_id + i] ;
+
+		// the face owning a vertex may only be in the tile if the vertex is owned
+		const index_t f = index.faces[Face(He_cage, vertex_halfedges[v_id])] ;
+		map.vertices[v] = f >= 0 && map.faces[f] >= 0 ? v_id : ~v_id ;
+	}
+	_BARRIER
+
+	for (const auto& elements_index: {std::make_pair(&tile_halfedges, &index.halfedges), std::make_pair(&tile_vertices, &index.vertices),
+									  std::make_pair(&tile_edges, &index.edges), std::make_pair(&faces, &index.faces)})
+	{
+		for (const index_t id: *elements_index.first)
+			(*elements_index.second)[id] = -1 ;
+	}
+
+	tile.H_count = tile.H_count_cage = Ht ;
+	tile.V_count = tile.V_count_cage = Vt ;
+	tile.E_count = tile.E_count_cage = Et ;
+	tile.F_count = tile.F_count_cage = Ft ;
+	tile.C_count = tile.C_count_cage = Et ;
+	tile.set_current_depth(0) ;
+}
+
+void
+Mesh_Subdiv_CPU::compute_uniform_halfedges_cage(index_t Hd, int n, halfedge_buffer_cage& He_cage)
+{
+	He_cage.resize(Hd) ;
+	_PARALLEL_FOR
+	for (index_t h = 0 ; h < Hd ; ++h)
+	{
+		He_cage[h].Next = h % n == n - 1 ? h - (n - 1) : h + 1 ;
+		He_cage[h].Prev = h % n == 0 ? h + (n - 1) : h - 1 ;
+		He_cage[h].Face = h / n ;
+	}
+	_BARRIER
+}
+
+// ----------- Adaptive refinement -----------
+void
+Mesh_Subdiv_CPU::replace_cage_by_refinement()
+{
+	// only depths 0 and 1 are allocated
+	low_memory = true ;
+	allocate_subdiv_buffers() ;
+	if (uses_vertex_halfedges())
+		compute_cage_vertex_halfedges() ;
+
+	set_current_depth(0) ;
+	allocate_subdiv_level(1) ;
+	refine_topology_level(0) ;
+	if (has_uvs())
+		refine_uvs_level(0) ;
+	refine_vertices_depth(0) ;
+
+	set_current_depth(1) ;
+	const index_t H1 = H() ;
+	const index_t V1 = V() ;
+	const index_t E1 = E() ;
+	const index_t F1 = F() ;
+	const int n = constant_face_size() ;
+
+	// the buffers of the previous cage are kept for depth 1, such that the next refinement reuses their memory
+	if (has_uvs())
+		uvs.swap(uv_subdiv_buffers[1]) ;
+	halfedges.swap(halfedge_subdiv_buffers[1]) ;
+	if (packed_vertex_width > 0)
+		unpack_vertices(packed_vertex_subdiv_buffers[1], V1) ;
+	else
+		vertices.swap(vertex_subdiv_buffers[1]) ;
+	creases.swap(crease_subdiv_buffers[1]) ; // edges of depth 1 that do not derive from cage edges are smooth (see Mesh_Subdiv::C)
+	compute_uniform_halfedges_cage(H1, n, halfedges_cage) ;
+
+	H_count = H_count_cage = H1 ;
+	V_count = V_count_cage = V1 ;
+	E_count = E_count_cage = E1 ;
+	F_count = F_count_cage = F1 ;
+	C_count = C_count_cage = creases.size() ;
+	set_current_depth(0) ;
+}
+
+// ----------- Limit surface -----------
+void
+Mesh_Subdiv_CPU::project_to_limit()
+{
+	// normals of a previous projection no longer match the vertices
+	if (!limit_projection)
+	{
+		vertex_buffer().swap(normals) ;
+		vertex_buffer().swap(tangents) ;
+		return ;
+	}
+
+	// the vertex halfedges of depth d_max are already refined in gather and SoA modes (unless released, see #release_subdiv_level)
+	const index_t Vd = V() ;
+	const bool refined = d_max < vertex_halfedge_subdiv_buffers.size() && index_t(vertex_halfedge_subdiv_buffers[d_max].size()) == Vd ;
+	std::vector<index_t> computed_vertex_halfedges ;
+	if (!refined)
+	{
+		computed_vertex_halfedges.resize(Vd) ;
+		compute_vertex_halfedges(halfedges, computed_vertex_halfedges) ;
+	}
+	const std::vector<index_t>& vertex_halfedges = refined ? vertex_halfedge_subdiv_buffers[d_max] : computed_vertex_halfedges ;
+
+	vertex_buffer limits(Vd) ;
+	normals.resize(Vd) ;
+	tangents.resize(Vd) ;
+	if (!project_vertices_to_limit(vertex_halfedges, limits))
+	{
+		vertex_buffer().swap(normals) ;
+		vertex_buffer().swap(tangents) ;
+		return ;
+	}
+
+	vertices.swap(limits) ;
+}
+
+void
+Mesh_Subdiv_CPU::set_limit_frame(index_t v_id, const vec3& tangent, const vec3& normal)
+{
+	const vec3 unit_normal = normal.normalized() ;
+	normals[v_id] = unit_normal ;
+	tangents[v_id] = (tangent - unit_normal * unit_normal.dot(tangent)).normalized() ;
 }
 
 std::vector<double>
@@ -100,12 +1159,3 @@ Mesh_Subdiv_CPU::measure_time(void (Mesh_Subdiv::*fptr)(), Mesh_Subdiv& c, int n
 	return times ;
 }
 
-void
-Mesh_Subdiv_CPU::apply_atomic_vec3_increment(vec3& v, const vec3& v_increm)
-{
-	for (int c=0; c < 3; ++c)
-	{
-_ATOMIC
-		v[c] += v_increm[c] ;
-	}
-}
@@ -2,6 +2,12 @@
 #define __MESH_SUDBIV_CPU_H__
 
 #include "mesh_subdiv.h"
+#include "simd.h"
+#include "soa_refinement.h"
+#include "sparse_crease_buffer.h"
+#include "stencil_table.h"
+#include "vecn.h"
+#include "vertex_buffer_soa.h"
 
 /**
  * @brief The Mesh_Subdiv_CPU (pure virtual) class specializes memory operations for the CPU, and implements crease refinement.
@@ -16,12 +22,207 @@ public:
 	 */
 	Mesh_Subdiv_CPU(const std::string& filename, uint max_depth) ;
 
+	/**
+	 * @brief subdivide_vertices subdivides new vertex positions of the cage, reusing the halfedge and crease subdivision buffers computed by #subdivide.
+	 * Only vertex refinement is processed: this is meant for deforming cages (e.g., animation frames) whose topology does not change.
+	 * With stencil evaluation (see #set_stencil_evaluation), the new vertices are a sparse matrix-vector product of the stencil tables, computed at the first call.
+	 * The refined positions are then given by Mesh::get_vertices.
+	 * @pre the topology of the cage is unchanged, and cage_vertices contains Mesh_Subdiv::cage_vertex_count vertices.
+	 * @param cage_vertices the new vertex positions of the cage
+	 */
+	void subdivide_vertices(const std::vector<vec3>& cage_vertices) ;
+
+	/**
+	 * @brief subdivide_vertices_and_time subdivides the vertex positions of the cage again (see #subdivide_vertices) n_repetitions times, and times each refinement.
+	 * Stencil tables, if any, are computed before the timed repetitions.
+	 * @param n_repetitions number of timed repetitions
+	 * @param stats timings of the vertex refinement
+	 */
+	void subdivide_vertices_and_time(int n_repetitions, Timing_stats& stats) ;
+
+	/**
+	 * @brief The Stencil_evaluation enum lists the ways #subdivide_vertices can refine vertices.
+	 */
+	enum Stencil_evaluation
+	{
+		STENCIL_EVALUATION_NONE,		/*!< the vertex kernels refine each depth, walking the halfedges (default) */
+		STENCIL_EVALUATION_PER_LEVEL,	/*!< one stencil table per depth maps the vertices of depth d to those of depth d+1 */
+		STENCIL_EVALUATION_COMPOSED		/*!< a single stencil table maps the cage vertices to those of depth d_max */
+	};
+
+	/**
+	 * @brief set_stencil_evaluation selects whether #subdivide_vertices refines vertices with the vertex kernels or with stencil tables.
+	 * Vertex refinement is linear, and only depends on the topology and the creases: its matrices are recorded once as stencil tables (see #compute_stencil_tables),
+	 * which turns each later refinement into sparse matrix-vector products, without topology traversal nor atomics.
+	 * Composed tables skip the intermediate depths, but their rows gather more vertices, which grow with d_max.
+	 * @note vertex attributes (see Mesh::add_vertex_attribute) keep the values #subdivide refined: only positions are evaluated.
+	 * @param evaluation the vertex refinement of #subdivide_vertices
+	 */
+	void set_stencil_evaluation(Stencil_evaluation evaluation) ;
+
+	/**
+	 * @brief get_stencil_tables gives the stencil tables computed by #subdivide_vertices: one per depth, or a single one from the cage (see #set_stencil_evaluation)
+	 */
+	const std::vector<StencilTable>& get_stencil_tables() const ;
+
+	/**
+	 * @brief The Vertex_refinement_mode enum lists the strategies available to write refined vertices.
+	 */
+	enum Vertex_refinement_mode
+	{
+		VERTEX_REFINEMENT_SCATTER,	/*!< each halfedge atomically adds its contributions to the new vertex points (default) */
+		VERTEX_REFINEMENT_GATHER	/*!< each new vertex point is computed by a single thread that gathers its contributions, without atomics */
+	};
+
+	/**
+	 * @brief set_vertex_refinement_mode selects the strategy used by #refine_vertices.
+	 * @note only Catmull-Clark subdivision honors this selection: Loop subdivision ignores it. Both schemes gather regardless when refining stencils (see #compute_stencil_tables) or SoA vertices.
+	 * @param mode the vertex refinement strategy
+	 */
+	void set_vertex_refinement_mode(Vertex_refinement_mode mode) ;
+
+	/**
+	 * @brief set_low_memory selects whether subdivision keeps the buffers of all depths, or only those of two consecutive depths.
+	 * In low-memory mode, depths are refined one after the other (halfedges, creases then vertices), the buffers of depth d are released once depth d+1 is computed,
+	 * and the buffers of depth d_max are moved (not copied) into the mesh. Peak memory then is about the size of the two finest depths.
+	 * @note in low-memory mode, #subdivide_vertices is not available (it reuses the halfedges of all depths), and #subdivide_and_time and #subdivide_and_time_levels do not time each step:
+	 * #subdivide_and_time_total times the whole refinement instead.
+	 * @param low_memory true to enable the low-memory mode
+	 */
+	void set_low_memory(bool low_memory) ;
+
+	/**
+	 * @brief set_level_fused selects whether subdivision refines all depths step by step (halfedges, then creases, then vertices),
+	 * or depth by depth, running the steps of one depth back-to-back while its buffers are still in cache (see #refine_level_fused).
+	 * @note the low-memory mode always refines depth by depth.
+	 * @param level_fused true to refine depth by depth
+	 */
+	void set_level_fused(bool level_fused) ;
+
+	/**
+	 * @brief subdivide_and_time_levels subdivides depth by depth (see #set_level_fused) n_repetitions times, and times the refinement of each depth.
+	 * Vertex buffers are cleared (untimed) before each repetition.
+	 * @note not available in low-memory mode, whose intermediate depths cannot be refined again.
+	 * @param n_repetitions number of timed repetitions
+	 * @param stats_topology for each depth d in [0, d_max), timings of the refinement of halfedges, creases and vertex halfedges from depth d to d+1
+	 * @param stats_vertices for each depth d in [0, d_max), timings of the refinement of vertices from depth d to d+1
+	 */
+	void subdivide_and_time_levels(int n_repetitions, std::vector<Timing_stats>& stats_topology, std::vector<Timing_stats>& stats_vertices) ;
+
+	/**
+	 * @brief subdivide_and_time_total subdivides n_repetitions times, and times the whole refinement (all steps of all depths).
+	 * Vertex buffers are cleared (untimed) before each repetition. In low-memory mode, the cage is copied again (untimed) before each repetition, since refinement releases it.
+	 * @param n_repetitions number of timed repetitions
+	 * @param stats timings of the refinement
+	 */
+	void subdivide_and_time_total(int n_repetitions, Timing_stats& stats) ;
+
+	/**
+	 * @brief The Vertex_storage enum lists the layouts of the vertex subdivision buffers.
+	 */
+	enum Vertex_storage
+	{
+		VERTEX_STORAGE_AOS,	/*!< one vec3 per vertex (default) */
+		VERTEX_STORAGE_SOA	/*!< one aligned and padded array per coordinate, refined by SIMD gathering kernels at the depths whose faces are all triangles (Loop) or quads (Catmull-Clark) */
+	};
+
+	/**
+	 * @brief set_vertex_storage selects the layout of the vertex subdivision buffers.
+	 * In SoA mode, vertices are converted from AoS at the first uniform depth (see #soa_first_depth) and back to AoS at depth d_max:
+	 * the mesh vertices, exports and #subdivide_vertices keep using vec3 buffers.
+	 * @param storage the vertex layout
+	 */
+	void set_vertex_storage(Vertex_storage storage) ;
+
+	/**
+	 * @brief set_simd_isa selects the instruction set of the SoA kernels. It defaults to the best one supported by the running CPU (see detect_simd_isa).
+	 * @param isa the requested instruction set, lowered to what the running CPU supports
+	 */
+	void set_simd_isa(Simd_isa isa) ;
+
+	/**
+	 * @brief get_simd_isa gives the instruction set used by the SoA kernels
+	 */
+	Simd_isa get_simd_isa() const ;
+
+	/**
+	 * @brief The Crease_storage enum lists the layouts of the crease subdivision buffers.
+	 */
+	enum Crease_storage
+	{
+		CREASE_STORAGE_DENSE,	/*!< one crease per edge (default) */
+		CREASE_STORAGE_SPARSE	/*!< only the creases of sharp edges and their children, hashed by edge (see SparseCreaseBuffer) */
+	};
+
+	/**
+	 * @brief set_crease_storage selects the layout of the crease subdivision buffers.
+	 * In sparse mode, the creases of depth d+1 are the children of the sharp creases of depth d: creases whose sharpness reached 0 are dropped at the next depth,
+	 * and memory and refinement time scale with the number of sharp edges instead of the number of edges. Vertex kernels find sharpnesses through the hash table.
+	 * The creases of depth d_max are expanded back to one crease per edge, for the mesh and exports.
+	 * @note crease-free meshes (see #crease_free) store no crease at all, whatever the layout.
+	 * @param storage the crease layout
+	 */
+	void set_crease_storage(Crease_storage storage) ;
+
+	/**
+	 * @brief get_border_crease_depth gives the first depth of the last subdivision whose only creases were the borders (see #update_border_crease_depth):
+	 * semi-sharp creases had all decayed, and deeper depths were refined with the border-only kernels and without crease buffers.
+	 * @return a depth in [0, d_max), or d_max + 1 if semi-sharp creases remained down to d_max
+	 */
+	uint get_border_crease_depth() const ;
+
+	/**
+	 * @brief set_limit_projection selects whether subdivision ends with a projection of the vertices of depth d_max onto the limit surface (see #project_to_limit).
+	 * The mesh then also stores the limit normal and a limit tangent of each vertex (see Mesh::has_normals), which OBJ and PLY exports write along with the vertices.
+	 * @param limit_projection true to project the vertices onto the limit surface
+	 */
+	void set_limit_projection(bool limit_projection) ;
+
+	/**
+	 * @brief The Uv_interpolation enum lists the rules that refine the face-varying UVs of a mesh (see Mesh::has_uvs).
+	 */
+	enum Uv_interpolation
+	{
+		UV_INTERPOLATION_LINEAR_BOUNDARIES,	/*!< smooth inside UV charts, linear along their boundaries: boundary UVs stay in place and boundary edges are split in their middle (default) */
+		UV_INTERPOLATION_SMOOTH,			/*!< smooth inside UV charts, and cubic B-splines along their boundaries, whose corners (face corners alone in their chart) stay in place */
+		UV_INTERPOLATION_LINEAR				/*!< linear everywhere: UVs stay in place, and edge and face points are averages */
+	};
+
+	/**
+	 * @brief set_uv_interpolation selects the rules of UV refinement. UVs are refined along with the halfedges, and are stored per halfedge at each depth (see #uv_subdiv_buffers).
+	 * UV charts are the fans of face corners whose UVs match across edges: UV seams, where the UVs of both sides differ, and borders bound them. Creases do not affect UVs.
+	 * @param interpolation the UV refinement rules
+	 */
+	void set_uv_interpolation(Uv_interpolation interpolation) ;
+
+	virtual void subdivide_and_time(int n_repetitions, Timing_stats& stats_he, Timing_stats& stats_cr, Timing_stats& stats_cl, Timing_stats& stats_vx) override ;
+
 protected:
+	Vertex_refinement_mode vertex_refinement_mode ; /*!< the strategy used by #refine_vertices */
+	bool low_memory ; /*!< true if only two consecutive depths are kept in memory (see #set_low_memory) */
+	bool level_fused ; /*!< true if subdivision refines depth by depth (see #set_level_fused) */
+	Vertex_storage vertex_storage ; /*!< the layout of the vertex subdivision buffers (see #set_vertex_storage) */
+	Simd_isa simd_isa ; /*!< the instruction set of the SoA kernels (see #set_simd_isa) */
+	bool crease_free ; /*!< true if the only sharp edges of the mesh are its borders (see Mesh::has_border_creases_only): vertex kernels then use BorderSharpness, and no crease buffer is refined */
+	Crease_storage crease_storage ; /*!< the layout of the crease subdivision buffers (see #set_crease_storage) */
+	uint border_crease_depth ; /*!< first depth whose only creases are the borders (0 if #crease_free, see #update_border_crease_depth), or d_max + 1 */
+	bool limit_projection ; /*!< true if subdivision ends with a projection onto the limit surface (see #set_limit_projection) */
+	Uv_interpolation uv_interpolation ; /*!< the rules of UV refinement (see #set_uv_interpolation) */
+	int packed_vertex_width ; /*!< number of floats per vertex of packed_vertex_subdiv_buffers (4, 8 or 16: the position, the vertex attributes and padding), or 0 if the mesh has no vertex attributes (see #allocate_subdiv_buffers) */
+	Stencil_evaluation stencil_evaluation ; /*!< the vertex refinement of #subdivide_vertices (see #set_stencil_evaluation) */
+	bool refining_stencils ; /*!< true while the vertex kernels refine stencil_subdiv_buffers (see #compute_stencil_tables) */
+	std::vector<StencilTable> stencil_tables ; /*!< stencil tables evaluated by #subdivide_vertices, or empty if not computed yet */
 
 	// ----------- Subdivision buffers on the CPU -----------
 	std::vector<halfedge_buffer> halfedge_subdiv_buffers ; /*!< @brief halfedge_subdiv_buffers CPU halfedge subdivision buffers */
 	std::vector<crease_buffer> crease_subdiv_buffers ; /*!< @brief crease_subdiv_buffers CPU crease subdivision buffers */
+	std::vector<SparseCreaseBuffer> sparse_crease_subdiv_buffers ; /*!< @brief sparse_crease_subdiv_buffers CPU crease subdivision buffers in sparse mode (see #uses_dense_creases) */
 	std::vector<vertex_buffer> vertex_subdiv_buffers ; /*!< @brief vertex_subdiv_buffers CPU vertex subdivision buffers */
+	std::vector<VertexBufferSoA> vertex_soa_subdiv_buffers ; /*!< @brief vertex_soa_subdiv_buffers CPU vertex subdivision buffers in SoA mode (see #vertices_in_soa) */
+	std::vector<std::vector<index_t>> vertex_halfedge_subdiv_buffers ; /*!< @brief vertex_halfedge_subdiv_buffers CPU buffers storing one outgoing halfedge per vertex (see #compute_cage_vertex_halfedges) */
+	std::vector<uv_buffer> uv_subdiv_buffers ; /*!< @brief uv_subdiv_buffers CPU face-varying UV subdivision buffers, indexed as the halfedges of each depth (empty if the mesh has no UVs) */
+	std::vector<std::vector<float>> packed_vertex_subdiv_buffers ; /*!< @brief packed_vertex_subdiv_buffers CPU vertex subdivision buffers of meshes with vertex attributes, refined instead of vertex_subdiv_buffers: #packed_vertex_width floats per vertex */
+	std::vector<std::vector<Stencil>> stencil_subdiv_buffers ; /*!< @brief stencil_subdiv_buffers CPU stencil subdivision buffers, only kept for two consecutive depths while #compute_stencil_tables runs */
 
 	// ----------- Buffer management -----------
 	/**
@@ -33,22 +234,580 @@ protected:
 	 */
 	void readback_from_subdiv_buffers() final ;
 	/**
-	 * @brief refine_creases operates crease refinement in the CPU crease subdivision buffers.
+	 * @brief allocate_subdiv_level allocates the CPU buffers of depth d, and initializes refined vertices to 0.
+	 * @param d a depth in [1, d_max]
+	 */
+	void allocate_subdiv_level(uint d) ;
+	/**
+	 * @brief release_subdiv_level frees the CPU buffers of depth d.
+	 * @param d a depth in [0, d_max]
+	 */
+	void release_subdiv_level(uint d) ;
+	/**
+	 * @brief pack_vertices interleaves the vertices and vertex attributes of the mesh, as #packed_vertex_width floats per vertex
+	 * @param packed output packed vertex buffer
+	 */
+	void pack_vertices(std::vector<float>& packed) const ;
+	/**
+	 * @brief unpack_vertices replaces the vertices and vertex attributes of the mesh by those of a packed vertex buffer
+	 * @param packed packed vertex buffer
+	 * @param Vd number of vertices of the buffer
+	 */
+	void unpack_vertices(const std::vector<float>& packed, index_t Vd) ;
+	/**
+	 * @brief vertex_data gives the vertices of depth d to the vertex refinement kernels, which are templated on their type:
+	 * vec3 in vertex_subdiv_buffers, vecN<#packed_vertex_width> in packed_vertex_subdiv_buffers, such that vertex attributes are refined in the same pass as the positions,
+	 * or Stencil in stencil_subdiv_buffers (see #compute_stencil_tables).
+	 * @param d a depth in [0, d_max]
+	 */
+	template <typename Vertex>
+	Vertex* vertex_data(uint d) ;
+
+	// ----------- Refinement over all depths -----------
+	/**
+	 * @brief refine dispatches to the default refinement, or to #refine_level_fused in level-fused and low-memory modes.
+	 */
+	void refine() final ;
+	/**
+	 * @brief refine_level_fused refines depths one after the other: topology (see #refine_topology_level), then vertices.
+	 * In low-memory mode, the buffers of depth d+1 are allocated just before its refinement, and those of depth d are released right after.
+	 */
+	void refine_level_fused() ;
+	/**
+	 * @brief refine_halfedges operates halfedge refinement in the CPU halfedge subdivision buffers, for all depths.
+	 */
+	void refine_halfedges() final ;
+	/**
+	 * @brief refine_creases operates crease refinement in the CPU crease subdivision buffers, for all depths.
 	 */
 	void refine_creases() final ;
+	/**
+	 * @brief refine_vertices operates vertex refinement in the CPU vertex subdivision buffers, for all depths.
+	 */
+	void refine_vertices() final ;
+	/**
+	 * @brief compute_stencil_tables records the vertex refinement of all depths as stencil tables (see #set_stencil_evaluation):
+	 * the gathering vertex kernels, which need no atomics, refine stencils instead of positions (see #refining_stencils), from one stencil per vertex of the cage, or of each depth for per-level tables.
+	 * @pre the halfedges and creases of all depths are refined
+	 */
+	void compute_stencil_tables() ;
+	/**
+	 * @brief evaluate_stencil_tables refines vertex positions with the stencil tables, into the mesh vertices
+	 * @param cage_vertices the vertex positions of the cage
+	 */
+	void evaluate_stencil_tables(const vertex_buffer& cage_vertices) ;
+
+	// ----------- Refinement of a single depth -----------
+	/**
+	 * @brief refine_halfedges_level (pure virtual) should compute the halfedges of depth d+1 from those of depth d.
+	 * @param d current depth
+	 */
+	virtual void refine_halfedges_level(uint d) = 0 ;
+	/**
+	 * @brief refine_uvs_level (pure virtual) should compute the UVs of depth d+1 from the halfedges and UVs of depth d: each halfedge of depth d+1 gets the UV of its face corner.
+	 * Shared UVs (on both sides of an edge that is not a UV seam, or around a vertex inside a UV chart) must be equal for all their face corners, such that UV seams are found again at depth d+1 (see #is_uv_seam):
+	 * they are computed once and copied to each face corner (see #is_uv_fan_first).
+	 * @param d current depth
+	 */
+	virtual void refine_uvs_level(uint d) = 0 ;
+	/**
+	 * @brief refine_creases_level computes the creases of depth d+1 from those of depth d.
+	 * @param d current depth
+	 */
+	void refine_creases_level(uint d) ;
+	/**
+	 * @brief refine_sparse_creases_level computes the sparse creases of depth d+1 from those of depth d: the children of the sharp creases.
+	 * @param d current depth
+	 */
+	void refine_sparse_creases_level(uint d) ;
+	/**
+	 * @brief compute_border_creases computes the crease buffer of depth d of a crease-free mesh (see #crease_free) from its halfedges alone.
+	 * Border edges are creases of sharpness Mesh::border_sharpness - d, whose neighbors are the adjacent border edges, and all other edges are smooth:
+	 * this is what #refine_creases_level computes over d depths.
+	 * @pre the current depth is d, whose faces all have #constant_face_size vertices
+	 * @param d a depth in [1, d_max]
+	 */
+	void compute_border_creases(uint d) ;
+	/**
+	 * @brief uses_dense_creases tells if creases are refined in crease_subdiv_buffers, and not in sparse_crease_subdiv_buffers nor computed at depth d_max only (see #crease_free)
+	 */
+	bool uses_dense_creases() const ;
+	/**
+	 * @brief border_creases_only tells if depth d is refined like the depths of a crease-free mesh (see #crease_free): with BorderSharpness, and without crease buffers
+	 * @param d a depth in [0, d_max]
+	 */
+	bool border_creases_only(uint d) const ;
+	/**
+	 * @brief update_border_crease_depth sets #border_crease_depth to d if the dense creases of depth d are those #compute_border_creases computes.
+	 * This is only checked once no semi-sharp crease is left: borders then are the only creases at all deeper depths, and their refinement can be skipped.
+	 * @param d a depth in [1, d_max]
+	 * @param max_sharpness the highest sharpness of the creases of depth d that are less sharp than the borders (see #decaying_sharpness)
+	 */
+	void update_border_crease_depth(uint d, float max_sharpness) ;
+	/**
+	 * @brief border_crease gives the crease of a border halfedge, as computed by #compute_border_creases
+	 * @param H_d halfedge buffer of the depth, whose faces all have n vertices
+	 * @param n number of vertices per face
+	 * @param sharpness sharpness of the borders at the depth
+	 * @param h_id a halfedge index such that Twin(h_id) < 0
+	 */
+	Crease border_crease(const halfedge_buffer& H_d, int n, float sharpness, index_t h_id) const ;
+	/**
+	 * @brief decaying_sharpness gives the highest sharpness of the two creases that derive from crease c_id of depth d (see #refine_crease) lower than that of borders at depth d+1, or 0
+	 * @param C_new crease buffer at depth d+1
+	 * @param c_id a crease index at depth d
+	 * @param d current depth
+	 */
+	float decaying_sharpness(const crease_buffer& C_new, index_t c_id, uint d) const ;
+	/**
+	 * @brief refine_topology_level computes the halfedges, creases and (if #uses_vertex_halfedges) vertex halfedges of depth d+1.
+	 * The default runs #refine_halfedges_level, #refine_creases_level and #refine_vertex_halfedges_level one after the other:
+	 * derived classes may fuse them into a single loop, since none reads what another writes.
+	 * @param d current depth
+	 */
+	virtual void refine_topology_level(uint d) ;
+	/**
+	 * @brief refine_crease computes the two creases of depth d+1 that derive from crease c_id of depth d
+	 * @param C_old crease buffer at depth d
+	 * @param C_new crease buffer at depth d+1
+	 * @param c_id a crease index at depth d
+	 */
+	void refine_crease(const crease_buffer& C_old, crease_buffer& C_new, index_t c_id) const ;
+	/**
+	 * @brief refine_sharp_crease computes the two children of a sharp crease, in dense and sparse modes
+	 * @param c_id the edge of the crease at depth d
+	 * @param c the crease
+	 * @param c_next the crease of edge c.Next
+	 * @param c_prev the crease of edge c.Prev
+	 * @param c0 output crease of edge 2*c_id at depth d+1
+	 * @param c1 output crease of edge 2*c_id+1 at depth d+1
+	 */
+	static void refine_sharp_crease(index_t c_id, const Crease& c, const Crease& c_next, const Crease& c_prev, Crease& c0, Crease& c1) ;
+	/**
+	 * @brief refine_vertices_level (pure virtual) should compute the vertices of depth d+1 from the halfedges, creases and vertices of depth d.
+	 * @pre if #uses_vertex_halfedges, vertex_halfedge_subdiv_buffers[d] has been computed
+	 * @param d current depth
+	 */
+	virtual void refine_vertices_level(uint d) = 0 ;
+	/**
+	 * @brief refine_vertex_halfedges_level (pure virtual) should compute vertex_halfedge_subdiv_buffers[d+1] from the halfedges and vertex halfedges of depth d.
+	 * Depth d+1 can be obtained analytically: the halfedges of a vertex at depth d+1 derive from the halfedges of depth d.
+	 * @param d current depth
+	 */
+	virtual void refine_vertex_halfedges_level(uint d) = 0 ;
+	/**
+	 * @brief uses_vertex_halfedges (pure virtual) should tell if #refine_vertices_level reads vertex_halfedge_subdiv_buffers.
+	 */
+	virtual bool uses_vertex_halfedges() const = 0 ;
+
+	// ----------- Refinement of a single depth in SoA mode -----------
+	/**
+	 * @brief refine_vertices_depth dispatches the vertex refinement of depth d to #refine_vertices_level or #refine_vertices_level_soa, converting vertices to SoA at the first SoA depth.
+	 * @param d current depth
+	 */
+	void refine_vertices_depth(uint d) ;
+	/**
+	 * @brief vertices_in_soa tells if the vertices of depth d are only stored in vertex_soa_subdiv_buffers: depths above #soa_first_depth, in SoA mode.
+	 * @param d a depth in [0, d_max]
+	 */
+	bool vertices_in_soa(uint d) const ;
+	/**
+	 * @brief soa_first_depth (pure virtual) should give the first depth whose faces all have the same number of vertices, from which the SoA kernels apply
+	 */
+	virtual uint soa_first_depth() const = 0 ;
+	/**
+	 * @brief refine_vertices_level_soa (pure virtual) should compute vertex_soa_subdiv_buffers[d+1] from the halfedges, creases, vertex halfedges and SoA vertices of depth d.
+	 * @param d current depth, at least #soa_first_depth
+	 */
+	virtual void refine_vertices_level_soa(uint d) = 0 ;
+	/**
+	 * @brief soa_refinement_level gathers the buffers of depth d and d+1 for the SoA kernels
+	 * @param d current depth
+	 */
+	SoaRefinementLevel soa_refinement_level(uint d) ;
+
+	/**
+	 * @brief compute_cage_vertex_halfedges stores, for each vertex of the cage, the index of one of its outgoing halfedges into vertex_halfedge_subdiv_buffers[0].
+	 * For border vertices, it is the first halfedge of the fan (i.e., Twin(Prev(h)) < 0), such that the full one-ring is visited by forward iteration.
+	 * Isolated vertices get index -1.
+	 */
+	void compute_cage_vertex_halfedges() ;
+
+	/**
+	 * @brief refine_vertex_halfedges computes vertex_halfedge_subdiv_buffers at all depths, starting with #compute_cage_vertex_halfedges.
+	 */
+	void refine_vertex_halfedges() ;
+
+	/**
+	 * @brief clear_vertex_subdiv_buffers resets refined vertices to 0 when the vertex refinement strategy accumulates into them.
+	 */
+	void clear_vertex_subdiv_buffers() ;
 
 //	void refine_halfedges_and_time(int n_repetitions) final;
 
+	// ----------- Tile extraction -----------
+	/**
+	 * @brief The Tile_map struct gives, for the halfedges, vertices, edges and faces of a tile, their index in the mesh it is extracted from.
+	 * Elements that derive from the tile faces themselves (and not from their one-ring) are owned by the tile.
+	 * The index of an element that is not owned is stored as its bitwise complement (i.e., as a negative number).
+	 */
+	struct Tile_map
+	{
+		std::vector<index_t> halfedges ; /*!< index of each halfedge of the tile */
+		std::vector<index_t> vertices ; /*!< index of each vertex of the tile */
+		std::vector<index_t> edges ; /*!< index of each edge of the tile */
+		std::vector<index_t> faces ; /*!< index of each face of the tile */
+	};
+	/**
+	 * @brief The Tile_index struct gives the index in a tile of the halfedges, vertices, edges and faces of the mesh it is extracted from, or -1 (see #extract_tile).
+	 * Its buffers are sized to the mesh by the first extraction, which resets its own entries before returning: a single index serves all the tiles of a mesh.
+	 */
+	struct Tile_index
+	{
+		std::vector<index_t> halfedges ; /*!< index of each halfedge of the mesh in the tile */
+		std::vector<index_t> vertices ; /*!< index of each vertex of the mesh in the tile */
+		std::vector<index_t> edges ; /*!< index of each edge of the mesh in the tile */
+		std::vector<index_t> faces ; /*!< index of each face of the mesh in the tile */
+	};
+	/**
+	 * @brief extract_tile copies cage faces and their one-ring into the cage of the tile mesh, and maps the tile elements to those of the cage.
+	 * Tile elements are numbered in the order of the cage elements, such that refinement orders them as in the whole mesh (e.g., edges spanned by a halfedge and its twin).
+	 * @param tile_face_ids the faces of the tile, in increasing order
+	 * @param face_halfedges one halfedge of each cage face
+	 * @param vertex_halfedges one outgoing halfedge of each cage vertex (see #compute_vertex_halfedges): its face owns the vertex
+	 * @param He_cage the face connectivity of the cage
+	 * @param tile the tile mesh, a copy of this one whose cage is replaced
+	 * @param map output map of the tile elements at depth 0
+	 * @param index the index of the cage elements in the tile, used during extraction only
+	 */
+	void extract_tile(const std::vector<index_t>& tile_face_ids, const std::vector<index_t>& face_halfedges, const std::vector<index_t>& vertex_halfedges, const halfedge_buffer_cage& He_cage, Mesh_Subdiv_CPU& tile, Tile_map& map, Tile_index& index) const ;
+	/**
+	 * @brief compute_uniform_halfedges_cage computes the face connectivity of a mesh whose faces all have n vertices, numbered face after face
+	 * @param Hd number of halfedges
+	 * @param n number of vertices per face
+	 * @param He_cage output face connectivity
+	 */
+	static void compute_uniform_halfedges_cage(index_t Hd, int n, halfedge_buffer_cage& He_cage) ;
+
+	// ----------- Adaptive refinement -----------
+	/**
+	 * @brief replace_cage_by_refinement refines the cage by one depth, and makes depth 1 the new cage: adaptive refinement refines scratch meshes (see #extract_tile) one depth at a time.
+	 * As at depth 1, creases are only stored for the edges that derive from cage edges, and the face connectivity is rebuilt from #constant_face_size.
+	 * @pre the faces of depth 1 all have the same number of vertices
+	 */
+	void replace_cage_by_refinement() ;
+
+	// ----------- Limit surface -----------
+	/**
+	 * @brief project_to_limit replaces the vertices of the mesh by their limit positions, and stores their limit normals and tangents (see #project_vertices_to_limit),
+	 * if #limit_projection is set. Otherwise, it releases the normals and tangents of a previous projection.
+	 * @pre the current depth is d_max, whose halfedges, creases and vertices are the mesh buffers
+	 */
+	void project_to_limit() ;
+	/**
+	 * @brief project_vertices_to_limit (pure virtual) should compute the limit position, unit normal and unit tangent of each vertex of the mesh from its one-ring,
+	 * with the limit masks of the scheme for smooth vertices and with #limit_sharp_vertex for the others, into limits, #normals and #tangents.
+	 * @param vertex_halfedges the first outgoing halfedge of the fan of each vertex (see #compute_vertex_halfedges)
+	 * @param limits output limit positions
+	 * @return false (with error notification) if the limit masks do not apply to the mesh
+	 */
+	virtual bool project_vertices_to_limit(const std::vector<index_t>& vertex_halfedges, vertex_buffer& limits) = 0 ;
+	/**
+	 * @brief limit_sharp_vertex computes the limit of a vertex with at least two sharp edges, including border vertices, whose limit only depends on its sharp neighbors:
+	 * both schemes refine sharp edges like uniform cubic B-splines, so a crease vertex (two sharp edges) goes to (a + 4v + b) / 6 of its two sharp neighbors a and b, and a corner (more sharp edges, or only two edges, as in the vertex rules) stays in place.
+	 * The tangent follows the crease (or the first outgoing edge of a corner). The normal, which differs on each side of a crease, is averaged over the faces around the vertex.
+	 * Semi-sharp creases are projected as sharp ones: those that are not fully sharp at d_max would still blend in a few smooth steps.
+	 * @param topology face connectivity of the mesh
+	 * @param h_first the first outgoing halfedge of the fan of the vertex (see #compute_vertex_halfedges)
+	 * @param valence output number of edges of the vertex
+	 * @param limit output limit position
+	 * @param tangent output unit tangent
+	 * @param normal output unit normal
+	 * @return false if the vertex is interior with less than two sharp edges and more than two edges (i.e., smooth or a dart): the smooth limit masks of the scheme then apply, and only the valence is output
+	 */
+	template <typename Topology>
+	bool limit_sharp_vertex(const Topology& topology, index_t h_first, int& valence, vec3& limit, vec3& tangent, vec3& normal) const ;
+	/**
+	 * @brief set_limit_frame stores the unit normal of a vertex, and its unit tangent made orthogonal to the normal
+	 * @param v_id a vertex index
+	 * @param tangent a tangent of the vertex
+	 * @param normal a normal of the vertex
+	 */
+	void set_limit_frame(index_t v_id, const vec3& tangent, const vec3& normal) ;
+
+	// ----------- Face-varying UVs -----------
+	/**
+	 * @brief is_uv_seam tells if the edge spanned by a halfedge bounds a UV chart: it is a border, or the UVs of its ends differ on each side
+	 * @param topology face connectivity of the depth
+	 * @param H_d halfedges of the depth
+	 * @param UV_d UVs of the depth
+	 * @param h_id a halfedge index
+	 */
+	template <typename Topology>
+	bool is_uv_seam(const Topology& topology, const halfedge_buffer& H_d, const uv_buffer& UV_d, index_t h_id) const ;
+	/**
+	 * @brief uv_face_point averages the UVs of the face of a halfedge. The sum starts from the smallest halfedge of the face, such that all its halfedges get the same result.
+	 * @param topology face connectivity of the depth
+	 * @param UV_d UVs of the depth
+	 * @param h_id a halfedge index
+	 */
+	template <typename Topology>
+	vec2 uv_face_point(const Topology& topology, const uv_buffer& UV_d, index_t h_id) const ;
+	/**
+	 * @brief is_uv_fan_first tells if a halfedge starts the fan of the face corners around its vertex that share its UV (i.e., the face corners of a UV chart around the vertex):
+	 * the first halfedge after a UV seam if a seam (or a border) bounds the fan, and its smallest halfedge otherwise.
+	 * Walking backwards stops at the first smaller halfedge or UV seam, which is usually met within a step or two.
+	 * @param topology face connectivity of the depth
+	 * @param H_d halfedges of the depth
+	 * @param UV_d UVs of the depth
+	 * @param h_id a halfedge index
+	 * @param is_boundary output true if a UV seam (or a border) bounds the fan, only set for the first halfedge
+	 */
+	template <typename Topology>
+	bool is_uv_fan_first(const Topology& topology, const halfedge_buffer& H_d, const uv_buffer& UV_d, index_t h_id, bool& is_boundary) const ;
+	/**
+	 * @brief uv_boundary_vertex_point computes the refined UV of a face corner on the boundary of a UV chart, with the boundary rule of #uv_interpolation:
+	 * both schemes refine sharp edges like cubic B-splines, so a boundary UV goes to (a + 6v + b) / 8 of its two boundary neighbors a and b in smooth mode, unless the chart has a single face there (a corner).
+	 * @param topology face connectivity of the depth
+	 * @param H_d halfedges of the depth
+	 * @param UV_d UVs of the depth
+	 * @param h_first the first halfedge of the fan of the face corner (see #is_uv_fan_first)
+	 */
+	template <typename Topology>
+	vec2 uv_boundary_vertex_point(const Topology& topology, const halfedge_buffer& H_d, const uv_buffer& UV_d, index_t h_first) const ;
+
 	// ----------- Utility function for OpenMP atomic adds -----------
 	/**
-	 * @brief apply_atomic_vec3_increment applies an atomic OpenMP increment on vertex coordinates
-	 * @param v reference to a vertex coordinate to increment
+	 * @brief apply_atomic_increment applies an atomic OpenMP increment on vertex coordinates
+	 * @param v reference to a vertex coordinate to increment (a vec3, or a vecN with vertex attributes)
 	 * @param v_increm the coordinate incrementation value.
 	 */
-	static void apply_atomic_vec3_increment(vec3& v, const vec3& v_increm) ;
+	template <typename Vertex>
+	static void apply_atomic_increment(Vertex& v, const Vertex& v_increm) ;
 
 	// ----------- Utility function for timing -----------
 	virtual std::vector<double> measure_time(void (Mesh_Subdiv::*fptr)(), Mesh_Subdiv& c, int n_repetitions) final ;
 };
 
+template <typename Vertex>
+inline void
+Mesh_Subdiv_CPU::apply_atomic_increment(Vertex& v, const Vertex& v_increm)
+{
+	for (int c=0; c < Vertex::size; ++c)
+	{
+_ATOMIC
+		v[c] += v_increm[c] ;
+	}
+}
+
+template <typename Vertex>
+inline Vertex*
+Mesh_Subdiv_CPU::vertex_data(uint d)
+{
+	// vecN only holds its floats: a packed buffer is an array of them
+	static_assert(sizeof(Vertex) == Vertex::size * sizeof(float), "packed vertices must be contiguous floats") ;
+	return reinterpret_cast<Vertex*>(packed_vertex_subdiv_buffers[d].data()) ;
+}
+
+template <>
+inline vec3*
+Mesh_Subdiv_CPU::vertex_data<vec3>(uint d)
+{
+	return vertex_subdiv_buffers[d].data() ;
+}
+
+template <>
+inline Stencil*
+Mesh_Subdiv_CPU::vertex_data<Stencil>(uint d)
+{
+	return stencil_subdiv_buffers[d].data() ;
+}
+
+inline void
+Mesh_Subdiv_CPU::refine_crease(const crease_buffer& C_old, crease_buffer& C_new, index_t c_id) const
+{
+	Crease& c0 = C_new[2*c_id + 0] ;
+	Crease& c1 = C_new[2*c_id + 1] ;
+	if (is_crease_edge(C_old,c_id))
+	{
+		const Crease& c = C_old[c_id] ;
+		refine_sharp_crease(c_id, c, C_old[c.Next], C_old[c.Prev], c0, c1) ;
+	}
+	else
+	{
+		c0.Sharpness = 0.0f ;
+		c1.Sharpness = 0.0f ;
+	}
+}
+
+inline void
+Mesh_Subdiv_CPU::refine_sharp_crease(index_t c_id, const Crease& c, const Crease& c_next, const Crease& c_prev, Crease& c0, Crease& c1)
+{
+	const index_t c_next_id = c.Next ;
+	const index_t c_prev_id = c.Prev ;
+	const bool b1 = c_id == c_next.Prev && c_id != c_next_id ;
+	const bool b2 = c_id == c_prev.Next && c_id != c_prev_id;
+	const float thisS = 3.0f * c.Sharpness ;
+	const float nextS = c_next.Sharpness ;
+	const float prevS = c_prev.Sharpness ;
+
+	c0.Next = 2*c_id + 1 ;
+	c1.Next = 2 * c_next_id + (b1 ? 0 : 1) ;
+
+	c0.Prev = 2 * c_prev_id + (b2 ? 1 : 0) ;
+	c1.Prev = 2*c_id + 0 ;
+
+	c0.Sharpness = std::max(0.0f, 0.250f * (prevS + thisS ) - 1.0f) ;
+	c1.Sharpness = std::max(0.0f, 0.250f * (nextS + thisS ) - 1.0f) ;
+}
+
+template <typename Topology>
+bool
+Mesh_Subdiv_CPU::limit_sharp_vertex(const Topology& topology, index_t h_first, int& valence, vec3& limit, vec3& tangent, vec3& normal) const
+{
+	const vec3& v = vertices[Vert(halfedges, h_first)] ;
+
+	// the neighbor reached by the incoming halfedge of the fan precedes the others: it is the previous spoke of an interior vertex, and the other end of the incoming border of a border vertex
+	const index_t h_in = topology.Prev(h_first) ;
+	const vec3& v_in = vertices[Vert(halfedges, h_in)] ;
+	valence = 0 ;
+	int sharp_count = 0 ;
+	vec3 sharp_neighbors[2] ;
+	if (Twin(halfedges, h_in) < 0)
+	{
+		sharp_neighbors[sharp_count++] = v_in ;
+		++valence ;
+	}
+
+	index_t h_it = h_first ;
+	do
+	{
+		const index_t twin_id = Twin(halfedges, h_it) ;
+		++valence ;
+		if (twin_id < 0 || Sharpness(creases, Edge(halfedges, h_it)) > _epsilon_)
+		{
+			if (sharp_count < 2)
+				sharp_neighbors[sharp_count] = vertices[Vert(halfedges, topology.Next(h_it))] ;
+			++sharp_count ;
+		}
+
+		if (twin_id < 0)
+			break ;
+		h_it = topology.Next(twin_id) ;
+	}
+	while (h_it != h_first) ;
+
+	// vertices with two edges are corners, as in the vertex rules
+	const bool is_corner = valence == 2 || sharp_count > 2 ;
+	if (sharp_count < 2 && !is_corner)
+		return false ;
+
+	if (!is_corner)
+	{
+		limit = (sharp_neighbors[0] + 4.0f * v + sharp_neighbors[1]) / 6.0f ;
+		tangent = sharp_neighbors[1] - sharp_neighbors[0] ;
+	}
+	else
+	{
+		limit = v ;
+		tangent = vertices[Vert(halfedges, topology.Next(h_first))] - v ;
+	}
+
+	// each pair of consecutive neighbors spans a face, whose vertices turn from the later neighbor to the earlier one
+	normal = vec3() ;
+	vec3 v_prev = v_in ;
+	h_it = h_first ;
+	do
+	{
+		const vec3& v_next = vertices[Vert(halfedges, topology.Next(h_it))] ;
+		normal = normal + (v_next - limit).cross(v_prev - limit) ;
+		v_prev = v_next ;
+
+		const index_t twin_id = Twin(halfedges, h_it) ;
+		if (twin_id < 0)
+			break ;
+		h_it = topology.Next(twin_id) ;
+	}
+	while (h_it != h_first) ;
+
+	return true ;
+}
+
+template <typename Topology>
+bool
+Mesh_Subdiv_CPU::is_uv_seam(const Topology& topology, const halfedge_buffer& H_d, const uv_buffer& UV_d, index_t h_id) const
+{
+	const index_t twin_id = Twin(H_d, h_id) ;
+	return twin_id < 0 || UV_d[h_id] != UV_d[topology.Next(twin_id)] || UV_d[topology.Next(h_id)] != UV_d[twin_id] ;
+}
+
+template <typename Topology>
+vec2
+Mesh_Subdiv_CPU::uv_face_point(const Topology& topology, const uv_buffer& UV_d, index_t h_id) const
+{
+	index_t h_first = h_id ;
+	int n = 1 ;
+	for (index_t h_it = topology.Next(h_id) ; h_it != h_id ; h_it = topology.Next(h_it))
+	{
+		h_first = std::min(h_first, h_it) ;
+		++n ;
+	}
+
+	vec2 sum = UV_d[h_first] ;
+	for (index_t h_it = topology.Next(h_first) ; h_it != h_first ; h_it = topology.Next(h_it))
+		sum = sum + UV_d[h_it] ;
+	return sum / float(n) ;
+}
+
+template <typename Topology>
+bool
+Mesh_Subdiv_CPU::is_uv_fan_first(const Topology& topology, const halfedge_buffer& H_d, const uv_buffer& UV_d, index_t h_id, bool& is_boundary) const
+{
+	index_t h_it = h_id ;
+	while (true)
+	{
+		const index_t prev_id = topology.Prev(h_it) ;
+		if (is_uv_seam(topology, H_d, UV_d, prev_id))
+		{
+			is_boundary = true ;
+			return h_it == h_id ;
+		}
+
+		h_it = Twin(H_d, prev_id) ;
+		if (h_it <= h_id)
+		{
+			is_boundary = false ;
+			return h_it == h_id ;
+		}
+	}
+}
+
+template <typename Topology>
+vec2
+Mesh_Subdiv_CPU::uv_boundary_vertex_point(const Topology& topology, const halfedge_buffer& H_d, const uv_buffer& UV_d, index_t h_first) const
+{
+	const vec2& uv = UV_d[h_first] ;
+	if (uv_interpolation != UV_INTERPOLATION_SMOOTH)
+		return uv ;
+
+	// the fan ends at the next UV seam, which the seam before it prevents from wrapping around
+	index_t h_last = h_first ;
+	while (!is_uv_seam(topology, H_d, UV_d, h_last))
+		h_last = topology.Next(Twin(H_d, h_last)) ;
+
+	if (h_last == h_first)
+		return uv ;
+
+	return 0.125f * (UV_d[topology.Prev(h_first)] + 6.0f * uv + UV_d[topology.Next(h_last)]) ;
+}
+
+inline float
+Mesh_Subdiv_CPU::decaying_sharpness(const crease_buffer& C_new, index_t c_id, uint d) const
+{
+	const float border = border_sharpness - float(d + 1) ;
+	const float s0 = C_new[2*c_id + 0].Sharpness ;
+	const float s1 = C_new[2*c_id + 1].Sharpness ;
+	return std::max(s0 < border ? s0 : 0.0f, s1 < border ? s1 : 0.0f) ;
+}
+
 #endif
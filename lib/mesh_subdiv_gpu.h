@@ -3,6 +3,10 @@
 
 #include "mesh_subdiv.h"
 
+#ifdef ENABLE_64BIT_INDICES
+#	error "The GPU backend only supports 32-bit indices: the GLSL shaders read the buffers as int"
+#endif
+
 #include "glad/glad.h"
 #include "GLFW/glfw3.h"
 #include <cstring>
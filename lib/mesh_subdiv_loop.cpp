@@ -3,62 +3,75 @@
 Mesh_Subdiv_Loop::Mesh_Subdiv_Loop(const std::string &filename, uint maxd_cur):
 	Mesh_Subdiv(filename, maxd_cur)
 {
-	if (!is_tri_only())
+	// a mesh that failed to load is empty, and reported by Mesh::is_loaded
+	if (is_loaded() && !is_tri_only())
 	{
 		std::cerr << "ERROR Mesh_Subdiv_Loop: The mesh is not valid or not fully triangular" << std::endl ;
-		exit(0) ;
+		exit(1) ;
 	}
 	halfedges_cage.clear() ;
 }
 
-int
+index_t
 Mesh_Subdiv_Loop::H(int depth) const
 {
 	const int& d = depth < 0 ? d_cur : depth ;
-	return std::pow(4,d) * H_count ;
+	return int64_t(H_count) << (2 * d) ;
 }
 
-int
+index_t
 Mesh_Subdiv_Loop::F(int depth) const
 {
 	const int& d = depth < 0 ? d_cur : depth ;
-	return std::pow(4,d) * F_count ;
+	return int64_t(F_count) << (2 * d) ;
 }
 
-int
+index_t
 Mesh_Subdiv_Loop::E(int depth) const
 {
 	const int& d = depth < 0 ? d_cur : depth ;
-	return pow(2,d)*E_count + 3*(pow(2,2*d-1) - pow(2,d-1))*F_count ;
+	if (d == 0)
+		return E_count ;
+
+	return (int64_t(E_count) << d) + 3 * ((int64_t(1) << (2*d-1)) - (int64_t(1) << (d-1))) * F_count ;
 }
 
-int
+index_t
 Mesh_Subdiv_Loop::V(int depth) const
 {
 	const int& d = depth < 0 ? d_cur : depth ;
-	return V_count + (pow(2,d) - 1)*E_count + (pow(2,2*d-1) - 3*pow(2,d-1) + 1)*F_count ;
+	if (d == 0)
+		return V_count ;
+
+	return V_count + ((int64_t(1) << d) - 1) * E_count + ((int64_t(1) << (2*d-1)) - 3 * (int64_t(1) << (d-1)) + 1) * F_count ;
 }
 
-int
-Mesh_Subdiv_Loop::Next(int h) const
+index_t
+Mesh_Subdiv_Loop::Next(index_t h) const
 {
-	return h % 3 == 2 ? h - 2 : h + 1 ;
+	return TriangleTopology::Next(h) ;
 }
 
-int
-Mesh_Subdiv_Loop::Prev(int h) const
+index_t
+Mesh_Subdiv_Loop::Prev(index_t h) const
+{
+	return TriangleTopology::Prev(h) ;
+}
+
+index_t
+Mesh_Subdiv_Loop::Face(index_t h) const
 {
-	return h % 3 == 0 ? h + 2 : h - 1 ;
+	return TriangleTopology::Face(h) ;
 }
 
 int
-Mesh_Subdiv_Loop::Face(int h) const
+Mesh_Subdiv_Loop::n_vertex_of_polygon(index_t h) const
 {
-	return h / 3 ;
+	return 3 ;
 }
 
 int
-Mesh_Subdiv_Loop::n_vertex_of_polygon(int h) const
+Mesh_Subdiv_Loop::constant_face_size() const
 {
 	return 3 ;
 }
@@ -19,10 +19,10 @@ public:
 	Mesh_Subdiv_Loop(const std::string& filename, uint max_depth) ;
 
 	// ----------- Override of accessors -----------
-	int H(int depth = -1) const ;
-	int V(int depth = -1) const ;
-	int F(int depth = -1) const ;
-	int E(int depth = -1) const ;
+	index_t H(int depth = -1) const ;
+	index_t V(int depth = -1) const ;
+	index_t F(int depth = -1) const ;
+	index_t E(int depth = -1) const ;
 
 protected:
 	// override with analytic versions
@@ -31,26 +31,32 @@ protected:
 	 * @param h index of a halfedge
 	 * @return the previous halfedge in a face, analytically computed.
 	 */
-	int Prev(int h) const ;
+	index_t Prev(index_t h) const ;
 	/**
 	 * @brief Next is the (faster) analytic override of the computation of the next index of a halfedge, specialized for Loop subdivision
 	 * @param h index of a halfedge
 	 * @return the next halfedge in a face, analytically computed.
 	 */
-	int Next(int h) const ;
+	index_t Next(index_t h) const ;
 	/**
 	 * @brief Face is the (faster) analytic override of the computation of the face index of a halfedge, specialized for Loop subdivision
 	 * @param h index of a halfedge to access
 	 * @return the index of the face the halfedge lives in
 	 */
-	int Face(int h) const ;
+	index_t Face(index_t h) const ;
 
 	/**
 	 * @brief n_vertex_of_polygon is the (faster) analytic override of the computation of #n_vertex_of_polygon, specialized for Loop subdivision.
 	 * @param h the index of a halfedge of the polygon
 	 * @return the number of vertices of the polygon
 	 */
-	virtual int n_vertex_of_polygon(int h) const final ;
+	virtual int n_vertex_of_polygon(index_t h) const final ;
+
+	/**
+	 * @brief constant_face_size is the analytic override of #constant_face_size, specialized for Loop subdivision.
+	 * @return the number of vertices of all polygons, or 0 if it is not constant
+	 */
+	virtual int constant_face_size() const final ;
 };
 
 
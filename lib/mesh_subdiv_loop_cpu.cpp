@@ -8,171 +8,478 @@ Mesh_Subdiv_Loop_CPU::Mesh_Subdiv_Loop_CPU(const std::string &filename, uint dep
 
 // ----------- Member functions that do the actual subdivision -----------
 void
-Mesh_Subdiv_Loop_CPU::refine_halfedges()
+Mesh_Subdiv_Loop_CPU::refine_halfedges_level(uint d)
 {
-	for (uint d = 0 ; d < d_max; ++d)
-	{
-		set_current_depth(d) ;
-
-		halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
-		halfedge_buffer& H_new = halfedge_subdiv_buffers[d+1] ;
-		const int Hd = H(d) ;
-		const int Vd = V(d) ;
-		const int Ed = E(d) ;
-
-		const int _3Hd = 3 * Hd ;
+	const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
+	halfedge_buffer& H_new = halfedge_subdiv_buffers[d+1] ;
+	const index_t Hd = H(d) ;
+	const index_t Vd = V(d) ;
+	const index_t Ed = E(d) ;
+
+	_PARALLEL_FOR
+	for (index_t h_id = 0; h_id < Hd ; ++h_id)
+		refine_halfedge(H_old, H_new, Hd, Vd, Ed, h_id) ;
+	_BARRIER
+}
 
-		_PARALLEL_FOR
-		for (int h_id = 0; h_id < Hd ; ++h_id)
+void
+Mesh_Subdiv_Loop_CPU::refine_topology_level(uint d)
+{
+	const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
+	halfedge_buffer& H_new = halfedge_subdiv_buffers[d+1] ;
+	const crease_buffer& C_old = crease_subdiv_buffers[d] ;
+	crease_buffer& C_new = crease_subdiv_buffers[d+1] ;
+	const std::vector<index_t>& VH_old = vertex_halfedge_subdiv_buffers[d] ;
+	std::vector<index_t>& VH_new = vertex_halfedge_subdiv_buffers[d+1] ;
+	const index_t Hd = H(d) ;
+	const index_t Vd = V(d) ;
+	const index_t Ed = E(d) ;
+	const index_t Cd = uses_dense_creases() && !border_creases_only(d) ? C(d) : 0 ; // sparse creases are refined after this pass, and border-only depths compute depth d_max only (see compute_border_creases)
+	VH_new.assign(V(d+1), -1) ;
+
+	// a single pass reads each halfedge once (there are fewer creases than halfedges)
+	float max_sharpness = 0.0f ;
+	_PARALLEL_FOR_REDUCTION(max, max_sharpness)
+	for (index_t h_id = 0; h_id < Hd ; ++h_id)
+	{
+		refine_halfedge(H_old, H_new, Hd, Vd, Ed, h_id) ;
+		refine_vertex_halfedge(H_old, VH_old, VH_new, Vd, h_id) ;
+		if (h_id < Cd)
 		{
-			const int twin_id = Twin(H_old,h_id) ;
-			const int edge_id = Edge(H_old,h_id) ;
-			const int next_id_safe = twin_id < 0 ? twin_id : Next(twin_id) ;
-
-			const int prev_id = Prev(h_id) ;
-			const int prev_twin_id = Twin(H_old,prev_id) ;
-			const int prev_edge_id = Edge(H_old,prev_id) ;
-
-			const int _3h = 3 * h_id ;
-			const int _3h_p_1 = _3h + 1 ;
-
-			HalfEdge& h0 = H_new[_3h + 0] ;
-			HalfEdge& h1 = H_new[_3h_p_1] ;
-			HalfEdge& h2 = H_new[_3h + 2] ;
-			HalfEdge& h3 = H_new[_3Hd + h_id] ;
-
-			h0.Twin = 3 * next_id_safe + 2 ;
-			h1.Twin = _3Hd + h_id ;
-			h2.Twin = 3 * prev_twin_id ;
-			h3.Twin = _3h_p_1 ;
-
-			h0.Vert = Vert(H_old,h_id) ;
-			h1.Vert = Vd + edge_id ;
-			h2.Vert = Vd + prev_edge_id ;
-			h3.Vert = h2.Vert ;
-
-			h0.Edge = 2 * edge_id + (int(h_id) > twin_id ? 0 : 1)  ;
-			h1.Edge = 2 * Ed + h_id ;
-			h2.Edge = 2 * prev_edge_id + (int(prev_id) > prev_twin_id ? 1 : 0) ;
-			h3.Edge = h1.Edge ;
+			refine_crease(C_old, C_new, h_id) ;
+			max_sharpness = std::max(max_sharpness, decaying_sharpness(C_new, h_id, d)) ;
 		}
-		_BARRIER
 	}
+	_BARRIER
+
+	if (Cd > 0)
+		update_border_crease_depth(d + 1, max_sharpness) ;
+
+	if (!uses_dense_creases())
+		refine_creases_level(d) ;
 }
 
 void
-Mesh_Subdiv_Loop_CPU::refine_vertices()
+Mesh_Subdiv_Loop_CPU::refine_uvs_level(uint d)
 {
-	// NOTE. This currently is only a copy-pasting of edgepoints_with_creases_branchless and vertexpoints_with_creases_branchless
-	// within the same loop on halfedges.
-	// TODO: one can probably exploit the single-loop case more optimally !
+	const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
+	const uv_buffer& UV_old = uv_subdiv_buffers[d] ;
+	uv_buffer& UV_new = uv_subdiv_buffers[d+1] ;
+	const index_t Hd = H(d) ;
+	const index_t _3Hd = 3 * Hd ;
+
+	// even vertices take beta from the table of the cage valences (see refine_vertices_level_soa)
+	if (d == 0)
+		compute_beta_table() ;
+
+	_PARALLEL_FOR
+	for (index_t h_id = 0; h_id < Hd ; ++h_id)
+	{
+		refine_uv_odd_point(H_old, UV_old, UV_new, _3Hd, h_id) ;
+		refine_uv_even_point(H_old, UV_old, UV_new, h_id) ;
+	}
+	_BARRIER
+}
 
-	for (uint d = 0 ; d < d_max; ++d)
+void
+Mesh_Subdiv_Loop_CPU::refine_uv_odd_point(const halfedge_buffer& H_old, const uv_buffer& UV_old, uv_buffer& UV_new, index_t _3Hd, index_t h) const
+{
+	const TriangleTopology topology ;
+	const index_t next_id = topology.Next(h) ;
+	if (uv_interpolation == UV_INTERPOLATION_LINEAR || is_uv_seam(topology, H_old, UV_old, h))
 	{
-		set_current_depth(d) ;
+		UV_new[3 * h + 1] = UV_new[3 * next_id + 2] = UV_new[_3Hd + next_id] = 0.5f * (UV_old[h] + UV_old[next_id]) ;
+		return ;
+	}
 
-		const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
-		const crease_buffer& C_old = crease_subdiv_buffers[d] ;
-		const vertex_buffer& V_old = vertex_subdiv_buffers[d] ;
-		vertex_buffer& V_new = vertex_subdiv_buffers[d+1] ;
+	// the smaller halfedge of the edge computes it for both sides
+	const index_t twin_id = Twin(H_old, h) ;
+	if (twin_id < h)
+		return ;
 
-		const int Vd = V(d) ;
-		const int Hd = H(d) ;
+	const index_t twin_next_id = topology.Next(twin_id) ;
+	const vec2 uv = 0.375f * (UV_old[h] + UV_old[next_id]) + 0.125f * (UV_old[topology.Prev(h)] + UV_old[topology.Prev(twin_id)]) ;
+	UV_new[3 * h + 1] = UV_new[3 * next_id + 2] = UV_new[_3Hd + next_id] = uv ;
+	UV_new[3 * twin_id + 1] = UV_new[3 * twin_next_id + 2] = UV_new[_3Hd + twin_next_id] = uv ;
+}
 
-		_PARALLEL_FOR
-		for (int h_id = 0; h_id < Hd ; ++h_id)
+void
+Mesh_Subdiv_Loop_CPU::refine_uv_even_point(const halfedge_buffer& H_old, const uv_buffer& UV_old, uv_buffer& UV_new, index_t h) const
+{
+	const TriangleTopology topology ;
+	if (uv_interpolation == UV_INTERPOLATION_LINEAR)
+	{
+		UV_new[3 * h] = UV_old[h] ;
+		return ;
+	}
+
+	// the first halfedge of the fan computes it for all its face corners
+	bool is_boundary ;
+	if (!is_uv_fan_first(topology, H_old, UV_old, h, is_boundary))
+		return ;
+
+	vec2 uv ;
+	if (is_boundary)
+		uv = uv_boundary_vertex_point(topology, H_old, UV_old, h) ;
+	else
+	{
+		// (1 - n beta) v + beta (sum of the neighbors), as the smooth even vertex rule
+		int n = 0 ;
+		vec2 sum ;
+		index_t h_it = h ;
+		do
 		{
-			const int v_id = Vert(H_old,h_id) ;
-			const int new_odd_pt_id = Vd + Edge(H_old,h_id) ;
-			vec3& v_new = V_new[new_odd_pt_id] ;
-			vec3& new_even_pt_vx = V_new[v_id] ;
+			sum = sum + UV_old[topology.Next(h_it)] ;
+			++n ;
+			h_it = topology.Next(Twin(H_old, h_it)) ;
+		}
+		while (h_it != h) ;
 
-			// edgepoints
-			const int v_prev_id = Vert(H_old,Prev(h_id)) ;
-			const int v_next_id = Vert(H_old,Next(h_id)) ;
+		const float beta = beta_table[n] ;
+		uv = (1.0f - float(n) * beta) * UV_old[h] + beta * sum ;
+	}
 
-			const int c_id = Edge(H_old,h_id) ;
+	index_t h_it = h ;
+	do
+	{
+		UV_new[3 * h_it] = uv ;
+		if (is_uv_seam(topology, H_old, UV_old, h_it))
+			break ;
+		h_it = topology.Next(Twin(H_old, h_it)) ;
+	}
+	while (h_it != h) ;
+}
 
-			const vec3& v_old_vx = V_old[v_id] ;
-			const vec3& v_prev_old_vx = V_old[v_prev_id] ;
-			const vec3& v_next_old_vx = V_old[v_next_id] ;
+void
+Mesh_Subdiv_Loop_CPU::refine_halfedge(const halfedge_buffer& H_old, halfedge_buffer& H_new, index_t Hd, index_t Vd, index_t Ed, index_t h_id) const
+{
+	const index_t _3Hd = 3 * Hd ;
+	const TriangleTopology topology ;
+
+	const index_t twin_id = Twin(H_old,h_id) ;
+	const index_t edge_id = Edge(H_old,h_id) ;
+	const index_t next_id_safe = twin_id < 0 ? twin_id : topology.Next(twin_id) ;
+
+	const index_t prev_id = topology.Prev(h_id) ;
+	const index_t prev_twin_id = Twin(H_old,prev_id) ;
+	const index_t prev_edge_id = Edge(H_old,prev_id) ;
+
+	const index_t _3h = 3 * h_id ;
+	const index_t _3h_p_1 = _3h + 1 ;
+
+	HalfEdge& h0 = H_new[_3h + 0] ;
+	HalfEdge& h1 = H_new[_3h_p_1] ;
+	HalfEdge& h2 = H_new[_3h + 2] ;
+	HalfEdge& h3 = H_new[_3Hd + h_id] ;
+
+	h0.Twin = 3 * next_id_safe + 2 ;
+	h1.Twin = _3Hd + h_id ;
+	h2.Twin = 3 * prev_twin_id ;
+	h3.Twin = _3h_p_1 ;
+
+	h0.Vert = Vert(H_old,h_id) ;
+	h1.Vert = Vd + edge_id ;
+	h2.Vert = Vd + prev_edge_id ;
+	h3.Vert = h2.Vert ;
+
+	h0.Edge = 2 * edge_id + (h_id > twin_id ? 0 : 1)  ;
+	h1.Edge = 2 * Ed + h_id ;
+	h2.Edge = 2 * prev_edge_id + (prev_id > prev_twin_id ? 1 : 0) ;
+	h3.Edge = h1.Edge ;
+}
 
-			const bool is_border = is_border_halfedge(H_old,h_id) ;
-			const float sharpness = std::clamp(Sharpness(C_old,c_id),0.0f,1.0f) ;
+void
+Mesh_Subdiv_Loop_CPU::refine_vertices_level(uint d)
+{
+	const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
+	if (border_creases_only(d))
+		refine_vertices_level(d, BorderSharpness(H_old)) ;
+	else if (!uses_dense_creases())
+		refine_vertices_level(d, SparseCreaseSharpness(H_old, sparse_crease_subdiv_buffers[d])) ;
+	else
+		refine_vertices_level(d, CreaseSharpness(H_old, crease_subdiv_buffers[d])) ;
+}
 
-			const vec3 increm_smooth_edge = 0.375f * v_old_vx + 0.125f * v_prev_old_vx ;
-			const vec3 increm_sharp_edge = 0.5f * (is_border ? v_old_vx + v_next_old_vx : v_old_vx) ;
-			vec3 increm = lerp(increm_smooth_edge,increm_sharp_edge,sharpness) ;
-            apply_atomic_vec3_increment(v_new, increm) ;
+template <typename SharpnessPolicy>
+void
+Mesh_Subdiv_Loop_CPU::refine_vertices_level(uint d, const SharpnessPolicy& sharpness)
+{
+	// see compute_stencil_tables: stencils are gathered, as their increments cannot be atomic
+	if (refining_stencils)
+	{
+		refine_vertices_level_gather<Stencil>(d, sharpness) ;
+		return ;
+	}
 
-			// vertex points
-			const int n = vertex_edge_valence(H_old,h_id) ;
-			const int n_creases = vertex_crease_valence(H_old, C_old, h_id) ;
-			const int vertex_he_valence = vertex_halfedge_valence(H_old,h_id) ;
+	switch (packed_vertex_width)
+	{
+		case 4:		refine_vertices_level<vecN<4>>(d, sharpness) ; break ;
+		case 8:		refine_vertices_level<vecN<8>>(d, sharpness) ; break ;
+		case 16:	refine_vertices_level<vecN<16>>(d, sharpness) ; break ;
+		default:	refine_vertices_level<vec3>(d, sharpness) ;
+	}
+}
 
-			const float edge_sharpness = Sharpness(C_old,c_id) ;
-			const float vx_sharpness = n_creases < 2 ? 0.0f :  // n_creases < 0 ==> dart vertex ==> smooth
-													   0.5f * vertex_sharpness_sum(H_old, C_old, h_id) ; // only used iff exactly 2 adjacent crease edges
+template <typename Vertex, typename SharpnessPolicy>
+void
+Mesh_Subdiv_Loop_CPU::refine_vertices_level(uint d, const SharpnessPolicy& sharpness)
+{
+	compute_vertex_configs(d, sharpness) ;
+
+	const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
+	const Vertex* V_old = vertex_data<Vertex>(d) ;
+	Vertex* V_new = vertex_data<Vertex>(d+1) ;
+	const vertex_config_buffer& VC = vertex_configs ;
+
+	const index_t Vd = V(d) ;
+	const index_t Hd = H(d) ;
+
+	_PARALLEL_FOR
+	for (index_t h_id = 0; h_id < Hd ; ++h_id)
+	{
+		const Vertex increm_odd = edgepoint_increment(sharpness, H_old, V_old, h_id) ;
+		apply_atomic_increment(V_new[Vd + Edge(H_old,h_id)], increm_odd) ;
+
+		const Vertex increm_even = vertexpoint_increment(sharpness, H_old, V_old, VC, h_id) ;
+		apply_atomic_increment(V_new[Vert(H_old,h_id)], increm_even) ;
+	}
+	_BARRIER
+}
 
-			const float lerp_alpha = std::clamp(vx_sharpness,0.0f,1.0f) ;
+template <typename Vertex, typename SharpnessPolicy>
+void
+Mesh_Subdiv_Loop_CPU::refine_vertices_level_gather(uint d, const SharpnessPolicy& sharpness)
+{
+	compute_vertex_configs(d, sharpness) ;
 
-			// utility notations
-			const float n_ = 1./float(n) ;
-			const float beta = compute_beta(n_) ;
-			const float beta_ = n_ - beta ;
+	const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
+	const std::vector<index_t>& VH_old = vertex_halfedge_subdiv_buffers[d] ;
+	const Vertex* V_old = vertex_data<Vertex>(d) ;
+	Vertex* V_new = vertex_data<Vertex>(d+1) ;
+	const vertex_config_buffer& VC = vertex_configs ;
+	const TriangleTopology topology ;
 
+	const index_t Vd = V(d) ;
+	const index_t Hd = H(d) ;
 
-			float edge_sharpness_factr = edge_sharpness < 1e-6 ? 0.0 : 1.0 ;
+	// odd points: an edge is treated by its biggest halfedge id (twin_id is negative at borders)
+	_PARALLEL_FOR
+	for (index_t h_id = 0; h_id < Hd ; ++h_id)
+	{
+		const index_t twin_id = Twin(H_old, h_id) ;
+		if (twin_id > h_id)
+			continue ;
 
-			// border correction
-			float increm_sharp_factr_v_old = 0.375f ;
-			float increm_sharp_factr_v_border = 0.0f ;
+		Vertex new_odd_pt = edgepoint_increment(sharpness, H_old, V_old, h_id) ;
+		if (twin_id >= 0)
+			new_odd_pt = new_odd_pt + edgepoint_increment(sharpness, H_old, V_old, twin_id) ;
 
-			int v_border_id = v_id ;
-			if (is_border)
-			{
-				increm_sharp_factr_v_old = 0.75f ;
-
-				for (int h_id_it = Prev(h_id) ; ; h_id_it = Prev(h_id_it))
-				{
-					const int h_it_twin = Twin(H_old, h_id_it) ;
-					if (h_it_twin < 0)
-					{
-						assert(is_crease_halfedge(H_old, C_old, h_id_it)) ;
-						v_border_id = Vert(H_old, h_id_it) ;
-						increm_sharp_factr_v_border = 0.125f ;
-						break ;
-					}
-
-					h_id_it = h_it_twin ;
-				}
-			}
+		V_new[Vd + Edge(H_old, h_id)] = new_odd_pt ;
+	}
+	_BARRIER
 
-			const vec3 increm_corner_vx = v_old_vx / vertex_he_valence ;
-			const vec3 increm_smooth_vx = beta_ * v_old_vx + beta * v_next_old_vx ;
-			const vec3 increm_sharp_vx = edge_sharpness_factr * (0.125f * v_next_old_vx + increm_sharp_factr_v_old * v_old_vx + increm_sharp_factr_v_border * V_old[v_border_id]) ;
+	// even points: h_first starts the fan, forward iteration visits all outgoing halfedges
+	_PARALLEL_FOR
+	for (index_t v_id = 0; v_id < Vd ; ++v_id)
+	{
+		const index_t h_first = VH_old[v_id] ;
+		Vertex new_even_pt ;
 
-      if ((n==2) || n_creases > 2) // Corner vertex rule
-			{
-				apply_atomic_vec3_increment(new_even_pt_vx,increm_corner_vx) ;
-			}
-			else if (vx_sharpness < 1e-6) // smooth
+		if (h_first >= 0) // not an isolated vertex
+		{
+			index_t h_it = h_first ;
+			do
 			{
-				apply_atomic_vec3_increment(new_even_pt_vx,increm_smooth_vx) ;
+				new_even_pt = new_even_pt + vertexpoint_increment(sharpness, H_old, V_old, VC, h_it) ;
+
+				const index_t twin_id = Twin(H_old, h_it) ;
+				if (twin_id < 0)
+					break ;
+				h_it = topology.Next(twin_id) ;
 			}
-			else // creased or blend
-			{
-				const vec3 incremV = lerp(increm_corner_vx,increm_sharp_vx,lerp_alpha) ;
-				apply_atomic_vec3_increment(new_even_pt_vx, incremV) ;
-      }
+			while (h_it != h_first) ;
 		}
+
+		V_new[v_id] = new_even_pt ;
+	}
 	_BARRIER
+}
+
+template <typename Vertex, typename SharpnessPolicy>
+Vertex
+Mesh_Subdiv_Loop_CPU::edgepoint_increment(const SharpnessPolicy& sharpness, const halfedge_buffer& H_old, const Vertex* V_old, index_t h_id) const
+{
+	const TriangleTopology topology ;
+	const index_t v_id = Vert(H_old,h_id) ;
+	const index_t v_prev_id = Vert(H_old,topology.Prev(h_id)) ;
+	const index_t v_next_id = Vert(H_old,topology.Next(h_id)) ;
+
+	const Vertex& v_old_vx = V_old[v_id] ;
+	const Vertex& v_prev_old_vx = V_old[v_prev_id] ;
+	const Vertex& v_next_old_vx = V_old[v_next_id] ;
+
+	const bool is_border = is_border_halfedge(H_old,h_id) ;
+	const float edge_sharpness = sharpness.Sharpness(h_id) ;
+	const float edge_alpha = std::clamp(edge_sharpness,0.0f,1.0f) ;
+
+	const Vertex increm_smooth_edge = 0.375f * v_old_vx + 0.125f * v_prev_old_vx ;
+	const Vertex increm_sharp_edge = 0.5f * (is_border ? v_old_vx + v_next_old_vx : v_old_vx) ;
+	return lerp(increm_smooth_edge,increm_sharp_edge,edge_alpha) ;
+}
+
+template <typename Vertex, typename SharpnessPolicy>
+Vertex
+Mesh_Subdiv_Loop_CPU::vertexpoint_increment(const SharpnessPolicy& sharpness, const halfedge_buffer& H_old, const Vertex* V_old, const vertex_config_buffer& VC, index_t h_id) const
+{
+	const TriangleTopology topology ;
+	const index_t v_id = Vert(H_old,h_id) ;
+	const index_t v_next_id = Vert(H_old,topology.Next(h_id)) ;
+
+	const Vertex& v_old_vx = V_old[v_id] ;
+	const Vertex& v_next_old_vx = V_old[v_next_id] ;
+
+	const bool is_border = is_border_halfedge(H_old,h_id) ;
+	const float edge_sharpness = sharpness.Sharpness(h_id) ;
+
+	const VertexConfig& vx_config = VC[v_id] ;
+	const int n = vx_config.Edge_valence ;
+	const int n_creases = vx_config.Crease_valence ;
+	const int vertex_he_valence = n - (vx_config.Border_neighbor < 0 ? 0 : 1) ;
+
+	const float vx_sharpness = n_creases < 2 ? 0.0f :  // n_creases < 0 ==> dart vertex ==> smooth
+											   0.5f * vx_config.Sharpness_sum ; // only used iff exactly 2 adjacent crease edges
+
+	const float lerp_alpha = std::clamp(vx_sharpness,0.0f,1.0f) ;
+
+	// utility notations
+	const float n_ = 1./float(n) ;
+	const float beta = compute_beta(n_) ;
+	const float beta_ = n_ - beta ;
+
+
+	float edge_sharpness_factr = edge_sharpness < 1e-6 ? 0.0 : 1.0 ;
+
+	// border correction
+	float increm_sharp_factr_v_old = 0.375f ;
+	float increm_sharp_factr_v_border = 0.0f ;
+
+	index_t v_border_id = v_id ;
+	if (is_border)
+	{
+		increm_sharp_factr_v_old = 0.75f ;
+		v_border_id = vx_config.Border_neighbor ;
+		increm_sharp_factr_v_border = 0.125f ;
 	}
 
-	set_current_depth(d_max) ;
+	const Vertex increm_corner_vx = v_old_vx / vertex_he_valence ;
+	const Vertex increm_smooth_vx = beta_ * v_old_vx + beta * v_next_old_vx ;
+	const Vertex increm_sharp_vx = edge_sharpness_factr * (0.125f * v_next_old_vx + increm_sharp_factr_v_old * v_old_vx + increm_sharp_factr_v_border * V_old[v_border_id]) ;
+
+	if ((n==2) || n_creases > 2) // Corner vertex rule
+		return increm_corner_vx ;
+	else if (vx_sharpness < 1e-6) // smooth
+		return increm_smooth_vx ;
+	else // creased or blend
+		return lerp(increm_corner_vx,increm_sharp_vx,lerp_alpha) ;
+}
+
+bool
+Mesh_Subdiv_Loop_CPU::uses_vertex_halfedges() const
+{
+	return true ;
+}
+
+uint
+Mesh_Subdiv_Loop_CPU::soa_first_depth() const
+{
+	return 0 ;
+}
+
+void
+Mesh_Subdiv_Loop_CPU::refine_vertices_level_soa(uint d)
+{
+	if (beta_table.empty())
+		compute_beta_table() ;
+
+	SoaRefinementLevel level = soa_refinement_level(d) ;
+	level.beta_table = beta_table.data() ;
+	level.beta_table_size = beta_table.size() ;
+
+	refine_vertices_loop_soa(level, simd_isa) ;
 }
 
 // ----------- Utility functions -----------
+void
+Mesh_Subdiv_Loop_CPU::refine_vertex_halfedges_level(uint d)
+{
+	const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
+	const std::vector<index_t>& VH_old = vertex_halfedge_subdiv_buffers[d] ;
+	std::vector<index_t>& VH_new = vertex_halfedge_subdiv_buffers[d+1] ;
+
+	const index_t Hd = H(d) ;
+	const index_t Vd = V(d) ;
+	VH_new.assign(V(d+1), -1) ;
+
+	_PARALLEL_FOR
+	for (index_t h_id = 0; h_id < Hd ; ++h_id)
+		refine_vertex_halfedge(H_old, VH_old, VH_new, Vd, h_id) ;
+	_BARRIER
+}
+
+void
+Mesh_Subdiv_Loop_CPU::refine_vertex_halfedge(const halfedge_buffer& H_old, const std::vector<index_t>& VH_old, std::vector<index_t>& VH_new, index_t Vd, index_t h_id) const
+{
+	const index_t _3h_id = 3 * h_id ;
+
+	if (VH_old[Vert(H_old, h_id)] == h_id) // even vertex
+		VH_new[Vert(H_old, h_id)] = _3h_id + 0 ;
+
+	if (Twin(H_old, h_id) < h_id) // odd vertex
+		VH_new[Vd + Edge(H_old, h_id)] = _3h_id + 1 ;
+}
+
+template <typename SharpnessPolicy>
+void
+Mesh_Subdiv_Loop_CPU::compute_vertex_configs(uint d, const SharpnessPolicy& sharpness)
+{
+	const halfedge_buffer& H_old = halfedge_subdiv_buffers[d] ;
+	const std::vector<index_t>& VH_old = vertex_halfedge_subdiv_buffers[d] ;
+	vertex_config_buffer& VC = vertex_configs ;
+	const TriangleTopology topology ;
+
+	const index_t Vd = V(d) ;
+	VC.resize(Vd) ;
+
+	_PARALLEL_FOR
+	for (index_t v_id = 0; v_id < Vd ; ++v_id)
+	{
+		const index_t h_id = VH_old[v_id] ;
+		if (h_id >= 0) // not an isolated vertex
+			VC[v_id] = vertex_config(topology, sharpness, H_old, h_id) ;
+	}
+	_BARRIER
+}
+
+void
+Mesh_Subdiv_Loop_CPU::compute_beta_table()
+{
+	// refinement does not change the valence of old vertices, and new ones are regular
+	const halfedge_buffer& H_cage = halfedge_subdiv_buffers[0] ;
+	std::vector<int> n_halfedges(V_count_cage, 0) ;
+	for (index_t h_id = 0 ; h_id < H_count_cage ; ++h_id)
+		++n_halfedges[Vert(H_cage, h_id)] ;
+
+	// border vertices have one more edge than outgoing halfedges
+	int max_valence = 6 ;
+	for (const int n : n_halfedges)
+		max_valence = std::max(max_valence, n + 1) ;
+
+	beta_table.resize(max_valence + 1) ;
+	beta_table[0] = 0.0f ;
+	for (int n = 1 ; n <= max_valence ; ++n)
+		beta_table[n] = compute_beta(1./float(n)) ;
+}
+
 float
 Mesh_Subdiv_Loop_CPU::compute_beta(float one_over_n)
 {
@@ -191,5 +498,56 @@ Mesh_Subdiv_Loop_CPU::compute_ngamma(float one_over_n)
 	return 1 - _8_o_5 * std::pow((_3_o_8 + std::cos(_2pi * one_over_n)* 0.250f),2);
 }
 
+// ----------- Limit surface -----------
+bool
+Mesh_Subdiv_Loop_CPU::project_vertices_to_limit(const std::vector<index_t>& vertex_halfedges, vertex_buffer& limits)
+{
+	const TriangleTopology topology ;
+	const index_t Vd = V() ;
 
+	_PARALLEL_FOR
+	for (index_t v_id = 0 ; v_id < Vd ; ++v_id)
+	{
+		const index_t h_first = vertex_halfedges[v_id] ;
+		vec3 limit = vertices[v_id] ;
+		vec3 tangent, normal ;
+		int n ;
 
+		if (h_first >= 0 && !limit_sharp_vertex(topology, h_first, n, limit, tangent, normal))
+		{
+			// interior vertex: the fan of its n edges is closed
+			index_t h_it = h_first ;
+
+			// cosine and sine of the angle i are rotated from one neighbor to the next
+			const float theta = _2pi / float(n) ;
+			const float cos_theta = std::cos(theta), sin_theta = std::sin(theta) ;
+			float c = 1.0f, s = 0.0f ;
+			vec3 neighbor_sum, tangent_cos, tangent_sin ;
+			for (int i = 0 ; i < n ; ++i)
+			{
+				const vec3& e = vertices[Vert(halfedges, topology.Next(h_it))] ;
+				neighbor_sum = neighbor_sum + e ;
+				tangent_cos = tangent_cos + c * e ;
+				tangent_sin = tangent_sin + s * e ;
+
+				const float c_next = c * cos_theta - s * sin_theta ;
+				s = s * cos_theta + c * sin_theta ;
+				c = c_next ;
+				h_it = topology.Next(Twin(halfedges, h_it)) ;
+			}
+
+			// the limit is the eigenvector of eigenvalue 1 of the even vertex rule, which weighs the vertex by 1 - n * beta and its neighbors by beta
+			const float omega = 0.375f / compute_beta(1.0f / float(n)) ;
+			limit = (omega * vertices[v_id] + neighbor_sum) / (omega + float(n)) ;
+			tangent = tangent_cos ;
+			// neighbors turn clockwise around the vertex
+			normal = tangent_sin.cross(tangent_cos) ;
+		}
+
+		limits[v_id] = limit ;
+		set_limit_frame(v_id, tangent, normal) ;
+	}
+	_BARRIER
+
+	return true ;
+}
@@ -17,18 +17,162 @@ public:
 	 */
 	Mesh_Subdiv_Loop_CPU(const std::string& filename, uint max_depth);
 
+	using Mesh_Subdiv_CPU::subdivide_vertices ;
+	using Mesh_Subdiv_CPU::subdivide_and_time ;
+	using Mesh_Subdiv_CPU::set_low_memory ;
+	using Mesh_Subdiv_CPU::set_level_fused ;
+	using Mesh_Subdiv_CPU::subdivide_and_time_levels ;
+	using Mesh_Subdiv_CPU::subdivide_and_time_total ;
+	using Mesh_Subdiv_CPU::set_vertex_storage ;
+	using Mesh_Subdiv_CPU::set_simd_isa ;
+	using Mesh_Subdiv_CPU::get_simd_isa ;
+	using Mesh_Subdiv_CPU::set_crease_storage ;
+	using Mesh_Subdiv_CPU::get_border_crease_depth ;
+	using Mesh_Subdiv_CPU::set_limit_projection ;
+	using Mesh_Subdiv_CPU::set_uv_interpolation ;
+	using Mesh_Subdiv_CPU::subdivide_vertices_and_time ;
+	using Mesh_Subdiv_CPU::set_stencil_evaluation ;
+	using Mesh_Subdiv_CPU::get_stencil_tables ;
+
 protected:
 	// ----------- Member functions that do the actual subdivision -----------
 	/**
-	 * @brief refine_halfedges operates Loop halfedge refinement on the CPU
+	 * @brief refine_halfedges_level operates Loop halfedge refinement of depth d on the CPU
+	 * @param d current depth
+	 */
+	void refine_halfedges_level(uint d) ;
+	/**
+	 * @brief refine_vertices_level operates Loop vertex refinement of depth d on the CPU
+	 * @param d current depth
+	 */
+	void refine_vertices_level(uint d) ;
+	/**
+	 * @brief refine_vertices_level operates Loop vertex refinement of depth d on the CPU
+	 * @param d current depth
+	 * @param sharpness edge sharpnesses of depth d: BorderSharpness for crease-free meshes, CreaseSharpness otherwise (see sharpness.h)
+	 */
+	template <typename SharpnessPolicy>
+	void refine_vertices_level(uint d, const SharpnessPolicy& sharpness) ;
+	/**
+	 * @brief refine_vertices_level operates Loop vertex refinement of depth d on the CPU, on vertices of type Vertex (see Mesh_Subdiv_CPU::vertex_data):
+	 * vertex attributes are refined in the same pass as the positions, which walks the topology and computes the vertex configurations once for all of them
+	 * @param d current depth
+	 * @param sharpness edge sharpnesses of depth d
+	 */
+	template <typename Vertex, typename SharpnessPolicy>
+	void refine_vertices_level(uint d, const SharpnessPolicy& sharpness) ;
+	/**
+	 * @brief refine_vertices_level_gather operates Loop vertex refinement of depth d on the CPU without atomics: each odd point is computed by the biggest halfedge of its edge,
+	 * and each even point by walking the fan of its outgoing halfedges (see Mesh_Subdiv_CPU::vertex_halfedge_subdiv_buffers). It refines stencils (see Mesh_Subdiv_CPU::compute_stencil_tables).
+	 * @param d current depth
+	 * @param sharpness edge sharpnesses of depth d
+	 */
+	template <typename Vertex, typename SharpnessPolicy>
+	void refine_vertices_level_gather(uint d, const SharpnessPolicy& sharpness) ;
+	/**
+	 * @brief edgepoint_increment computes the contribution of halfedge h to the odd point of its edge
+	 * @param sharpness edge sharpnesses of depth d
+	 * @param H_old halfedge buffer at depth d
+	 * @param V_old vertices at depth d
+	 * @param h_id a halfedge index at depth d
 	 */
-	void refine_halfedges() ;
+	template <typename Vertex, typename SharpnessPolicy>
+	Vertex edgepoint_increment(const SharpnessPolicy& sharpness, const halfedge_buffer& H_old, const Vertex* V_old, index_t h_id) const ;
 	/**
-	 * @brief refine_vertices operates Loop vertex refinement on the CPU
+	 * @brief vertexpoint_increment computes the contribution of halfedge h to the even point of its vertex
+	 * @param sharpness edge sharpnesses of depth d
+	 * @param H_old halfedge buffer at depth d
+	 * @param V_old vertices at depth d
+	 * @param VC vertex configurations at depth d (see #compute_vertex_configs)
+	 * @param h_id a halfedge index at depth d
 	 */
-	void refine_vertices() ;
+	template <typename Vertex, typename SharpnessPolicy>
+	Vertex vertexpoint_increment(const SharpnessPolicy& sharpness, const halfedge_buffer& H_old, const Vertex* V_old, const vertex_config_buffer& VC, index_t h_id) const ;
 
 	// ----------- Utility functions -----------
+	/**
+	 * @brief refine_vertex_halfedges_level computes vertex_halfedge_subdiv_buffers[d+1].
+	 * Depth d+1 is obtained analytically from depth d: even vertices inherit halfedge 3h, and odd vertices use halfedge 3h+1 of their edge's owner halfedge h.
+	 * @param d current depth
+	 */
+	void refine_vertex_halfedges_level(uint d) ;
+	/**
+	 * @brief refine_topology_level computes the halfedges, creases and vertex halfedges of depth d+1 within a single loop over the halfedges of depth d
+	 * @param d current depth
+	 */
+	void refine_topology_level(uint d) ;
+	/**
+	 * @brief refine_uvs_level operates Loop UV refinement of depth d on the CPU: halfedges 3h to 3h+2 of depth d+1 get the UVs of the even vertex, odd vertex and previous odd vertex of halfedge h, and halfedge 3Hd+h the one of the previous odd vertex
+	 * @param d current depth
+	 */
+	void refine_uvs_level(uint d) ;
+	/**
+	 * @brief refine_uv_odd_point computes the UV of the odd vertex of a halfedge, in its face, and its next halfedge: the middle of the edge on UV seams,
+	 * and the smooth edge rule within a UV chart, computed by the smaller halfedge of the edge for both sides
+	 * @param H_old halfedge buffer at depth d
+	 * @param UV_old UV buffer at depth d
+	 * @param UV_new UV buffer at depth d+1
+	 * @param _3Hd three times the number of halfedges at depth d
+	 * @param h a halfedge index at depth d
+	 */
+	void refine_uv_odd_point(const halfedge_buffer& H_old, const uv_buffer& UV_old, uv_buffer& UV_new, index_t _3Hd, index_t h) const ;
+	/**
+	 * @brief refine_uv_even_point computes the UV of the even vertex of all the face corners of a fan, if the halfedge starts it (see Mesh_Subdiv_CPU::is_uv_fan_first):
+	 * the smooth vertex rule within a UV chart, and the boundary rule otherwise (see Mesh_Subdiv_CPU::uv_boundary_vertex_point)
+	 * @param H_old halfedge buffer at depth d
+	 * @param UV_old UV buffer at depth d
+	 * @param UV_new UV buffer at depth d+1
+	 * @param h a halfedge index at depth d
+	 */
+	void refine_uv_even_point(const halfedge_buffer& H_old, const uv_buffer& UV_old, uv_buffer& UV_new, index_t h) const ;
+	/**
+	 * @brief refine_halfedge computes the four halfedges of depth d+1 that derive from halfedge h of depth d
+	 * @param H_old halfedge buffer at depth d
+	 * @param H_new halfedge buffer at depth d+1
+	 * @param Hd number of halfedges at depth d
+	 * @param Vd number of vertices at depth d
+	 * @param Ed number of edges at depth d
+	 * @param h a halfedge index at depth d
+	 */
+	void refine_halfedge(const halfedge_buffer& H_old, halfedge_buffer& H_new, index_t Hd, index_t Vd, index_t Ed, index_t h) const ;
+	/**
+	 * @brief refine_vertex_halfedge writes the vertex halfedges of depth d+1 for which halfedge h of depth d is responsible
+	 * @param H_old halfedge buffer at depth d
+	 * @param VH_old vertex halfedges at depth d
+	 * @param VH_new vertex halfedges at depth d+1
+	 * @param Vd number of vertices at depth d
+	 * @param h a halfedge index at depth d
+	 */
+	void refine_vertex_halfedge(const halfedge_buffer& H_old, const std::vector<index_t>& VH_old, std::vector<index_t>& VH_new, index_t Vd, index_t h) const ;
+
+	/**
+	 * @brief uses_vertex_halfedges tells if vertex refinement reads vertex_halfedge_subdiv_buffers (always, to compute vertex configurations)
+	 */
+	bool uses_vertex_halfedges() const ;
+
+	/**
+	 * @brief soa_first_depth gives 0: Loop subdivision meshes are made of triangles at all depths
+	 */
+	uint soa_first_depth() const ;
+	/**
+	 * @brief refine_vertices_level_soa operates Loop vertex refinement of depth d on the CPU, with SoA vertices (see refine_vertices_loop_soa)
+	 * @param d current depth
+	 */
+	void refine_vertices_level_soa(uint d) ;
+	/**
+	 * @brief compute_beta_table fills #beta_table for all the valences of the cage, which bound the valences of all depths.
+	 */
+	void compute_beta_table() ;
+
+	/**
+	 * @brief compute_vertex_configs computes the configuration of each vertex at depth d once, for the even vertex rule to read from.
+	 * @pre vertex_halfedge_subdiv_buffers have been computed (see #refine_vertex_halfedges)
+	 * @param d current depth
+	 * @param sharpness edge sharpnesses of depth d
+	 */
+	template <typename SharpnessPolicy>
+	void compute_vertex_configs(uint d, const SharpnessPolicy& sharpness) ;
+
 	/**
 	 * @brief compute_beta is a static mathematical utility function
 	 * @param one_over_n is a scalar containing the value 1/valence.
@@ -47,6 +191,21 @@ protected:
 	 * @return n times gamma (see accompanying paper formulae)
 	 */
 	static float compute_ngamma(float one_over_n) ;
+
+	// ----------- Limit surface -----------
+	/**
+	 * @brief project_vertices_to_limit computes the limit position, normal and tangent of each vertex (see Mesh_Subdiv_CPU::project_vertices_to_limit).
+	 * Smooth vertices of valence n use the limit masks of Loop [1987]: the limit position weighs the vertex by 3 / (8 beta) and its neighbors by 1,
+	 * and both tangents weigh neighbors by the cosines and sines of their angle around the vertex.
+	 * @param vertex_halfedges the first outgoing halfedge of the fan of each vertex
+	 * @param limits output limit positions
+	 * @return true
+	 */
+	bool project_vertices_to_limit(const std::vector<index_t>& vertex_halfedges, vertex_buffer& limits) ;
+
+	// ----------- Per-vertex configurations -----------
+	vertex_config_buffer vertex_configs ; /*!< configuration of each vertex at the current depth (see #compute_vertex_configs) */
+	std::vector<float> beta_table ; /*!< beta of the even vertex rule, indexed by edge valence, for the SoA and UV kernels (see #compute_beta_table) */
 };
 
 #endif
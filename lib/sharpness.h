@@ -0,0 +1,67 @@
+#ifndef __SHARPNESS_H__
+#define __SHARPNESS_H__
+
+#include <vector>
+
+#include "halfedge.h"
+#include "crease.h"
+#include "sparse_crease_buffer.h"
+
+/**
+ * @brief The sharpness policies give the sharpness of the edge spanned by a halfedge through non-virtual inline functions.
+ * Like the topology policies (see topology.h), CPU vertex refinement kernels are templated on them and instantiated once per policy.
+ */
+
+/**
+ * @brief The CreaseSharpness policy reads sharpness values from a crease buffer indexed by edge.
+ */
+struct CreaseSharpness
+{
+	CreaseSharpness(const std::vector<HalfEdge>& h_buffer, const std::vector<Crease>& c_buffer):
+		halfedges(h_buffer.data()), creases(c_buffer.data()), crease_count(c_buffer.size())
+	{}
+
+	// edges beyond the crease buffer are smooth (see Mesh::Sharpness)
+	float Sharpness(index_t h) const
+	{
+		const index_t c = halfedges[h].Edge ;
+		return c < crease_count ? creases[c].Sharpness : 0.0f ;
+	}
+
+	const HalfEdge* halfedges ; /*!< HalfEdge buffer of the depth */
+	const Crease* creases ; /*!< Crease buffer of the depth */
+	index_t crease_count ; /*!< number of creases of the depth */
+};
+
+/**
+ * @brief The SparseCreaseSharpness policy finds sharpness values in a sparse crease buffer, through its hash table.
+ */
+struct SparseCreaseSharpness
+{
+	SparseCreaseSharpness(const std::vector<HalfEdge>& h_buffer, const SparseCreaseBuffer& c_buffer):
+		halfedges(h_buffer.data()), creases(c_buffer)
+	{}
+
+	float Sharpness(index_t h) const { return creases.Sharpness(halfedges[h].Edge) ; }
+
+	const HalfEdge* halfedges ; /*!< HalfEdge buffer of the depth */
+	const SparseCreaseBuffer& creases ; /*!< sparse crease buffer of the depth */
+};
+
+/**
+ * @brief The BorderSharpness policy describes meshes whose only creases are their borders, sharp enough to remain so down to the subdivision depth:
+ * border edges are fully sharp (a sharpness of 1 gives the same rules as any higher sharpness), and all other edges are smooth.
+ * It reads no crease buffer.
+ */
+struct BorderSharpness
+{
+	BorderSharpness(const std::vector<HalfEdge>& h_buffer):
+		halfedges(h_buffer.data())
+	{}
+
+	float Sharpness(index_t h) const { return halfedges[h].Twin < 0 ? 1.0f : 0.0f ; }
+
+	const HalfEdge* halfedges ; /*!< HalfEdge buffer of the depth */
+};
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef __SIMD_H__
+#define __SIMD_H__
+
+#if defined(__x86_64__) || defined(_M_X64)
+#	define SIMD_X86
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	endif
+#endif
+
+/**
+ * @brief The Simd_isa enum lists the instruction sets for which the SoA vertex refinement kernels are compiled, from the least to the most capable.
+ */
+enum Simd_isa
+{
+	SIMD_ISA_SCALAR,	/*!< portable scalar code */
+	SIMD_ISA_AVX2,		/*!< 8-wide AVX2 and FMA */
+	SIMD_ISA_AVX512		/*!< 16-wide AVX-512F */
+};
+
+/**
+ * @brief detect_simd_isa queries the instruction sets supported by the running CPU (and operating system).
+ * @return the most capable instruction set for which kernels are available
+ */
+inline Simd_isa
+detect_simd_isa()
+{
+#if defined(SIMD_X86) && !defined(ENABLE_64BIT_INDICES)
+#	if defined(_MSC_VER)
+	int info[4] ;
+	__cpuid(info, 0) ;
+	if (info[0] < 7)
+		return SIMD_ISA_SCALAR ;
+
+	__cpuid(info, 1) ;
+	const bool os_saves_ymm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6 ;
+	const bool fma = info[2] & (1 << 12) ;
+	if (!os_saves_ymm || !fma)
+		return SIMD_ISA_SCALAR ;
+
+	const bool os_saves_zmm = (_xgetbv(0) & 0xe6) == 0xe6 ;
+	__cpuidex(info, 7, 0) ;
+	if (os_saves_zmm && (info[1] & (1 << 16)))
+		return SIMD_ISA_AVX512 ;
+	if (info[1] & (1 << 5))
+		return SIMD_ISA_AVX2 ;
+#	else
+	__builtin_cpu_init() ;
+	if (__builtin_cpu_supports("avx512f"))
+		return SIMD_ISA_AVX512 ;
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		return SIMD_ISA_AVX2 ;
+#	endif
+#endif
+	return SIMD_ISA_SCALAR ;
+}
+
+/**
+ * @brief simd_isa_name gives a printable name of an instruction set
+ */
+inline const char*
+simd_isa_name(Simd_isa isa)
+{
+	switch (isa)
+	{
+		case SIMD_ISA_AVX512:
+			return "avx512" ;
+		case SIMD_ISA_AVX2:
+			return "avx2" ;
+		default:
+			return "scalar" ;
+	}
+}
+
+#endif
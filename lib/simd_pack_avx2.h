@@ -0,0 +1,157 @@
+#ifndef __SIMD_PACK_AVX2_H__
+#define __SIMD_PACK_AVX2_H__
+
+#include <cstdint>
+#include <immintrin.h>
+
+namespace {
+
+/**
+ * @brief The Pack_avx2 struct is the 8-lane AVX2 implementation of the SIMD pack interface (see Pack_scalar).
+ * Masks hold all bits set in active lanes. Indices are 32-bit: gathers take offsets in units of 32-bit words.
+ * @pre the translation unit is compiled for AVX2 and FMA (e.g., with #pragma GCC target("avx2,fma")).
+ */
+struct Pack_avx2
+{
+	struct F
+	{
+		__m256 v ;
+		F() = default ;
+		F(__m256 v): v(v) {}
+		F(float s): v(_mm256_set1_ps(s)) {}
+	};
+
+	struct I
+	{
+		__m256i v ;
+		I() = default ;
+		I(__m256i v): v(v) {}
+		I(int s): v(_mm256_set1_epi32(s)) {}
+	};
+
+	struct M
+	{
+		__m256i v ;
+		M() = default ;
+		M(__m256i v): v(v) {}
+	};
+
+	typedef int Index ;
+	static const int W = 8 ;
+
+	static I iota(int base) { return _mm256_add_epi32(_mm256_set1_epi32(base), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)) ; }
+	static M none() { return _mm256_setzero_si256() ; }
+
+	static M lt(I a, I b) { return _mm256_cmpgt_epi32(b.v, a.v) ; }
+	static M eq(I a, I b) { return _mm256_cmpeq_epi32(a.v, b.v) ; }
+	static M lt(F a, F b) { return _mm256_castps_si256(_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)) ; }
+	static M eq(F a, F b) { return _mm256_castps_si256(_mm256_cmp_ps(a.v, b.v, _CMP_EQ_OQ)) ; }
+	static M mask_and(M a, M b) { return _mm256_and_si256(a.v, b.v) ; }
+	static M mask_or(M a, M b) { return _mm256_or_si256(a.v, b.v) ; }
+	static M mask_andnot(M a, M b) { return _mm256_andnot_si256(a.v, b.v) ; }
+	static bool any(M m) { return !_mm256_testz_si256(m.v, m.v) ; }
+
+	static F select(M m, F a, F b) { return _mm256_blendv_ps(b.v, a.v, _mm256_castsi256_ps(m.v)) ; }
+	static I select(M m, I a, I b) { return _mm256_blendv_epi8(b.v, a.v, m.v) ; }
+	static F min(F a, F b) { return _mm256_min_ps(a.v, b.v) ; }
+	static F max(F a, F b) { return _mm256_max_ps(a.v, b.v) ; }
+	static F to_float(I a) { return _mm256_cvtepi32_ps(a.v) ; }
+
+	/**
+	 * @brief div3 divides non-negative integers by 3, as the high bits of their product with ceil(2^33 / 3)
+	 */
+	static I div3(I a)
+	{
+		const __m256i magic = _mm256_set1_epi32(int(0xAAAAAAAB)) ;
+		const __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(a.v, magic), 33) ;
+		const __m256i odd = _mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a.v, 32), magic), 33) ;
+		return _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA) ;
+	}
+
+	/**
+	 * @brief mul_hash gives the bits high bits of the low 32 bits of the product of each integer with factor (multiplicative hashing, see SparseCreaseBuffer::hash)
+	 */
+	static I mul_hash(I a, uint32_t factor, int bits)
+	{
+		return _mm256_srl_epi32(_mm256_mullo_epi32(a.v, _mm256_set1_epi32(int(factor))), _mm_cvtsi32_si128(32 - bits)) ;
+	}
+
+	static I load(const Index* ptr, M m) { return _mm256_maskload_epi32(ptr, m.v) ; }
+	static F load(const float* ptr, M m) { return _mm256_maskload_ps(ptr, m.v) ; }
+	static I gather(const Index* base, I idx, M m) { return _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), base, idx.v, m.v, 4) ; }
+	static F gather(const float* base, I idx, M m) { return _mm256_mask_i32gather_ps(_mm256_setzero_ps(), base, idx.v, _mm256_castsi256_ps(m.v), 4) ; }
+	static void store(float* ptr, F v, M m) { _mm256_maskstore_ps(ptr, m.v, v.v) ; }
+
+	// AVX2 has no scatter instruction
+	static void scatter(float* base, I idx, F v, M m)
+	{
+		alignas(32) int lanes_idx[W] ;
+		alignas(32) float lanes_v[W] ;
+		_mm256_store_si256((__m256i*) lanes_idx, idx.v) ;
+		_mm256_store_ps(lanes_v, v.v) ;
+
+		const int bits = _mm256_movemask_ps(_mm256_castsi256_ps(m.v)) ;
+		for (int i = 0 ; i < W ; ++i)
+			if (bits & (1 << i))
+				base[lanes_idx[i]] = lanes_v[i] ;
+	}
+};
+
+// operators are not friends defined in the class: GCC does not apply the target pragma to those
+inline Pack_avx2::F
+operator+(Pack_avx2::F a, Pack_avx2::F b)
+{
+	return _mm256_add_ps(a.v, b.v) ;
+}
+
+inline Pack_avx2::F
+operator-(Pack_avx2::F a, Pack_avx2::F b)
+{
+	return _mm256_sub_ps(a.v, b.v) ;
+}
+
+inline Pack_avx2::F
+operator*(Pack_avx2::F a, Pack_avx2::F b)
+{
+	return _mm256_mul_ps(a.v, b.v) ;
+}
+
+inline Pack_avx2::F
+operator/(Pack_avx2::F a, Pack_avx2::F b)
+{
+	return _mm256_div_ps(a.v, b.v) ;
+}
+
+inline Pack_avx2::I
+operator+(Pack_avx2::I a, Pack_avx2::I b)
+{
+	return _mm256_add_epi32(a.v, b.v) ;
+}
+
+inline Pack_avx2::I
+operator-(Pack_avx2::I a, Pack_avx2::I b)
+{
+	return _mm256_sub_epi32(a.v, b.v) ;
+}
+
+inline Pack_avx2::I
+operator*(Pack_avx2::I a, Pack_avx2::I b)
+{
+	return _mm256_mullo_epi32(a.v, b.v) ;
+}
+
+inline Pack_avx2::I
+operator&(Pack_avx2::I a, Pack_avx2::I b)
+{
+	return _mm256_and_si256(a.v, b.v) ;
+}
+
+inline Pack_avx2::I
+operator>>(Pack_avx2::I a, int n)
+{
+	return _mm256_srai_epi32(a.v, n) ;
+}
+
+}
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef __SIMD_PACK_AVX512_H__
+#define __SIMD_PACK_AVX512_H__
+
+#include <cstdint>
+#include <immintrin.h>
+
+namespace {
+
+/**
+ * @brief The Pack_avx512 struct is the 16-lane AVX-512F implementation of the SIMD pack interface (see Pack_scalar).
+ * Masks are AVX-512 mask registers. Indices are 32-bit: gathers and scatters take offsets in units of 32-bit words.
+ * @pre the translation unit is compiled for AVX-512F (e.g., with #pragma GCC target("avx512f")).
+ */
+struct Pack_avx512
+{
+	struct F
+	{
+		__m512 v ;
+		F() = default ;
+		F(__m512 v): v(v) {}
+		F(float s): v(_mm512_set1_ps(s)) {}
+	};
+
+	struct I
+	{
+		__m512i v ;
+		I() = default ;
+		I(__m512i v): v(v) {}
+		I(int s): v(_mm512_set1_epi32(s)) {}
+	};
+
+	typedef __mmask16 M ;
+	typedef int Index ;
+	static const int W = 16 ;
+
+	static I iota(int base) { return _mm512_add_epi32(_mm512_set1_epi32(base), _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)) ; }
+	static M none() { return 0 ; }
+
+	static M lt(I a, I b) { return _mm512_cmplt_epi32_mask(a.v, b.v) ; }
+	static M eq(I a, I b) { return _mm512_cmpeq_epi32_mask(a.v, b.v) ; }
+	static M lt(F a, F b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ) ; }
+	static M eq(F a, F b) { return _mm512_cmp_ps_mask(a.v, b.v, _CMP_EQ_OQ) ; }
+	static M mask_and(M a, M b) { return a & b ; }
+	static M mask_or(M a, M b) { return a | b ; }
+	static M mask_andnot(M a, M b) { return ~a & b ; }
+	static bool any(M m) { return m != 0 ; }
+
+	static F select(M m, F a, F b) { return _mm512_mask_blend_ps(m, b.v, a.v) ; }
+	static I select(M m, I a, I b) { return _mm512_mask_blend_epi32(m, b.v, a.v) ; }
+	static F min(F a, F b) { return _mm512_min_ps(a.v, b.v) ; }
+	static F max(F a, F b) { return _mm512_max_ps(a.v, b.v) ; }
+	static F to_float(I a) { return _mm512_cvtepi32_ps(a.v) ; }
+
+	/**
+	 * @brief div3 divides non-negative integers by 3, as the high bits of their product with ceil(2^33 / 3)
+	 */
+	static I div3(I a)
+	{
+		const __m512i magic = _mm512_set1_epi32(int(0xAAAAAAAB)) ;
+		const __m512i even = _mm512_srli_epi64(_mm512_mul_epu32(a.v, magic), 33) ;
+		const __m512i odd = _mm512_srli_epi64(_mm512_mul_epu32(_mm512_srli_epi64(a.v, 32), magic), 33) ;
+		return _mm512_mask_blend_epi32(0xAAAA, even, _mm512_slli_epi64(odd, 32)) ;
+	}
+
+	/**
+	 * @brief mul_hash gives the bits high bits of the low 32 bits of the product of each integer with factor (multiplicative hashing, see SparseCreaseBuffer::hash)
+	 */
+	static I mul_hash(I a, uint32_t factor, int bits)
+	{
+		return _mm512_srl_epi32(_mm512_mullo_epi32(a.v, _mm512_set1_epi32(int(factor))), _mm_cvtsi32_si128(32 - bits)) ;
+	}
+
+	static I load(const Index* ptr, M m) { return _mm512_maskz_loadu_epi32(m, ptr) ; }
+	static F load(const float* ptr, M m) { return _mm512_maskz_loadu_ps(m, ptr) ; }
+	static I gather(const Index* base, I idx, M m) { return _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), m, idx.v, base, 4) ; }
+	static F gather(const float* base, I idx, M m) { return _mm512_mask_i32gather_ps(_mm512_setzero_ps(), m, idx.v, base, 4) ; }
+	static void store(float* ptr, F v, M m) { _mm512_mask_storeu_ps(ptr, m, v.v) ; }
+	static void scatter(float* base, I idx, F v, M m) { _mm512_mask_i32scatter_ps(base, m, idx.v, v.v, 4) ; }
+};
+
+// operators are not friends defined in the class: GCC does not apply the target pragma to those
+inline Pack_avx512::F
+operator+(Pack_avx512::F a, Pack_avx512::F b)
+{
+	return _mm512_add_ps(a.v, b.v) ;
+}
+
+inline Pack_avx512::F
+operator-(Pack_avx512::F a, Pack_avx512::F b)
+{
+	return _mm512_sub_ps(a.v, b.v) ;
+}
+
+inline Pack_avx512::F
+operator*(Pack_avx512::F a, Pack_avx512::F b)
+{
+	return _mm512_mul_ps(a.v, b.v) ;
+}
+
+inline Pack_avx512::F
+operator/(Pack_avx512::F a, Pack_avx512::F b)
+{
+	return _mm512_div_ps(a.v, b.v) ;
+}
+
+inline Pack_avx512::I
+operator+(Pack_avx512::I a, Pack_avx512::I b)
+{
+	return _mm512_add_epi32(a.v, b.v) ;
+}
+
+inline Pack_avx512::I
+operator-(Pack_avx512::I a, Pack_avx512::I b)
+{
+	return _mm512_sub_epi32(a.v, b.v) ;
+}
+
+inline Pack_avx512::I
+operator*(Pack_avx512::I a, Pack_avx512::I b)
+{
+	return _mm512_mullo_epi32(a.v, b.v) ;
+}
+
+inline Pack_avx512::I
+operator&(Pack_avx512::I a, Pack_avx512::I b)
+{
+	return _mm512_and_si512(a.v, b.v) ;
+}
+
+inline Pack_avx512::I
+operator>>(Pack_avx512::I a, int n)
+{
+	return _mm512_srai_epi32(a.v, n) ;
+}
+
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef __SIMD_PACK_SCALAR_H__
+#define __SIMD_PACK_SCALAR_H__
+
+#include <cstdint>
+#include <type_traits>
+
+#include "index_type.h"
+
+namespace {
+
+/**
+ * @brief The Pack_scalar struct is the 1-lane implementation of the SIMD pack interface used by soa_refinement_kernels.h.
+ * A pack interface defines a float vector F, an index vector I and a lane mask M of W lanes, and the operations the kernels need on them:
+ * F and I also support the arithmetic operators (with scalars converting implicitly), and I supports & and >>.
+ * Masked gathers return 0 in inactive lanes, and masked stores leave inactive lanes untouched.
+ */
+struct Pack_scalar
+{
+	typedef float F ;
+	typedef index_t I ;
+	typedef bool M ;
+	typedef index_t Index ; /*!< type of the integers gathered by #gather */
+	static const int W = 1 ;
+
+	static I iota(index_t base) { return base ; }
+	static M none() { return false ; }
+
+	static M lt(I a, I b) { return a < b ; }
+	static M eq(I a, I b) { return a == b ; }
+	static M lt(F a, F b) { return a < b ; }
+	static M eq(F a, F b) { return a == b ; }
+	static M mask_and(M a, M b) { return a && b ; }
+	static M mask_or(M a, M b) { return a || b ; }
+	static M mask_andnot(M a, M b) { return !a && b ; }
+	static bool any(M m) { return m ; }
+
+	static F select(M m, F a, F b) { return m ? a : b ; }
+	static I select(M m, I a, I b) { return m ? a : b ; }
+	static F min(F a, F b) { return a < b ? a : b ; }
+	static F max(F a, F b) { return a > b ? a : b ; }
+	static F to_float(I a) { return float(a) ; }
+	static I div3(I a) { return a / 3 ; }
+	static I mul_hash(I a, uint64_t factor, int bits) { typedef typename std::make_unsigned<I>::type U ; return I((U(a) * U(factor)) >> (8 * sizeof(U) - bits)) ; }
+
+	static I load(const Index* ptr, M m) { return m ? *ptr : 0 ; }
+	static F load(const float* ptr, M m) { return m ? *ptr : 0.0f ; }
+	static I gather(const Index* base, I idx, M m) { return m ? base[idx] : 0 ; }
+	static F gather(const float* base, I idx, M m) { return m ? base[idx] : 0.0f ; }
+	static void store(float* ptr, F v, M m) { if (m) *ptr = v ; }
+	static void scatter(float* base, I idx, F v, M m) { if (m) base[idx] = v ; }
+};
+
+}
+
+#endif
@@ -0,0 +1,71 @@
+#include <cstdint>
+#include <limits>
+
+#include "simd_pack_scalar.h"
+#include "soa_refinement_kernels.h"
+
+// ----------- Scalar instantiation, always available -----------
+void
+soa_scalar::refine_vertices_catmull_clark(const SoaRefinementLevel& level)
+{
+	refine_vertices_catmull_clark_kernels<Pack_scalar>(level) ;
+}
+
+void
+soa_scalar::refine_vertices_loop(const SoaRefinementLevel& level)
+{
+	refine_vertices_loop_kernels<Pack_scalar>(level) ;
+}
+
+// ----------- Dispatch -----------
+/**
+ * @brief supported_isa lowers isa to what both the running CPU and the buffers of the level support.
+ * SIMD packs gather halfedges and creases with 32-bit offsets counted in 32-bit words.
+ */
+static Simd_isa
+supported_isa(const SoaRefinementLevel& level, Simd_isa isa)
+{
+	if (isa > detect_simd_isa())
+		return detect_simd_isa() ;
+
+	const int64_t max_offset = std::numeric_limits<int32_t>::max() ;
+	const int64_t halfedge_words = int64_t(level.H) * int64_t(sizeof(HalfEdge) / sizeof(int32_t)) ;
+	const int64_t crease_words = int64_t(level.C) * int64_t(sizeof(Crease) / sizeof(int32_t)) ;
+	const int64_t table_words = level.crease_table ? (int64_t(1) << level.crease_table_bits) * int64_t(sizeof(CreaseSlot) / sizeof(int32_t)) : 0 ;
+	if (halfedge_words > max_offset || crease_words > max_offset || table_words > max_offset)
+		return SIMD_ISA_SCALAR ;
+
+	return isa ;
+}
+
+void
+refine_vertices_catmull_clark_soa(const SoaRefinementLevel& level, Simd_isa isa)
+{
+	switch (supported_isa(level, isa))
+	{
+		case SIMD_ISA_AVX512:
+			soa_avx512::refine_vertices_catmull_clark(level) ;
+			break ;
+		case SIMD_ISA_AVX2:
+			soa_avx2::refine_vertices_catmull_clark(level) ;
+			break ;
+		default:
+			soa_scalar::refine_vertices_catmull_clark(level) ;
+	}
+}
+
+void
+refine_vertices_loop_soa(const SoaRefinementLevel& level, Simd_isa isa)
+{
+	switch (supported_isa(level, isa))
+	{
+		case SIMD_ISA_AVX512:
+			soa_avx512::refine_vertices_loop(level) ;
+			break ;
+		case SIMD_ISA_AVX2:
+			soa_avx2::refine_vertices_loop(level) ;
+			break ;
+		default:
+			soa_scalar::refine_vertices_loop(level) ;
+	}
+}
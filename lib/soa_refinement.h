@@ -0,0 +1,66 @@
+#ifndef __SOA_REFINEMENT_H__
+#define __SOA_REFINEMENT_H__
+
+#include "halfedge.h"
+#include "crease.h"
+#include "simd.h"
+#include "sparse_crease_buffer.h"
+
+/**
+ * @brief The SoaRefinementLevel struct gives the SoA vertex refinement kernels a raw view of the buffers of one subdivision depth d.
+ * Kernels gather each new vertex within a single SIMD lane (no atomics), and are only defined for depths whose faces are all triangles (Loop) or quads (Catmull-Clark).
+ */
+struct SoaRefinementLevel
+{
+	const HalfEdge* halfedges ;			/*!< halfedges of depth d */
+	const Crease* creases ;				/*!< creases of depth d, indexed by edge or by crease_table, or nullptr if the only sharp edges are borders (see BorderSharpness) */
+	const CreaseSlot* crease_table ;	/*!< hash table of the sparse creases of depth d (see SparseCreaseBuffer), or nullptr if creases are indexed by edge */
+	const index_t* vertex_halfedges ;	/*!< one outgoing halfedge per vertex of depth d, that starts its fan (see Mesh::compute_vertex_halfedges) */
+	const float* old_xyz[3] ;			/*!< vertex coordinates of depth d */
+	float* new_xyz[3] ;					/*!< vertex coordinates of depth d+1 */
+
+	index_t H ; /*!< number of halfedges of depth d */
+	index_t V ; /*!< number of vertices of depth d */
+	index_t E ; /*!< number of edges of depth d */
+	index_t F ; /*!< number of faces of depth d */
+	index_t C ; /*!< number of creases of depth d */
+	int crease_table_bits ; /*!< log2 of the number of slots of crease_table */
+
+	const float* beta_table ;	/*!< Loop only: beta weight of the even vertex rule, indexed by vertex valence */
+	int beta_table_size ;		/*!< Loop only: number of entries of beta_table, which must exceed the highest valence */
+};
+
+/**
+ * @brief refine_vertices_catmull_clark_soa computes the face, edge and vertex points of depth d+1 of a quad-only depth d
+ * @param level buffers of depth d
+ * @param isa the instruction set to use. It is lowered to SIMD_ISA_SCALAR if the buffers are too big for 32-bit gather offsets.
+ */
+void refine_vertices_catmull_clark_soa(const SoaRefinementLevel& level, Simd_isa isa) ;
+
+/**
+ * @brief refine_vertices_loop_soa computes the odd and even vertices of depth d+1 of a triangle-only depth d
+ * @param level buffers of depth d
+ * @param isa the instruction set to use. It is lowered to SIMD_ISA_SCALAR if the buffers are too big for 32-bit gather offsets.
+ */
+void refine_vertices_loop_soa(const SoaRefinementLevel& level, Simd_isa isa) ;
+
+// ----------- Instantiations of the kernels for each instruction set -----------
+namespace soa_scalar
+{
+	void refine_vertices_catmull_clark(const SoaRefinementLevel& level) ;
+	void refine_vertices_loop(const SoaRefinementLevel& level) ;
+}
+
+namespace soa_avx2
+{
+	void refine_vertices_catmull_clark(const SoaRefinementLevel& level) ;
+	void refine_vertices_loop(const SoaRefinementLevel& level) ;
+}
+
+namespace soa_avx512
+{
+	void refine_vertices_catmull_clark(const SoaRefinementLevel& level) ;
+	void refine_vertices_loop(const SoaRefinementLevel& level) ;
+}
+
+#endif
@@ -0,0 +1,53 @@
+#include "soa_refinement.h"
+
+#if defined(SIMD_X86) && !defined(ENABLE_64BIT_INDICES)
+
+#include <cstddef>
+#include <immintrin.h>
+
+#include "utils.h"
+
+// kernels of this translation unit are compiled for AVX2, whatever the flags of the build: they are only called if the CPU supports it (see detect_simd_isa)
+#if defined(__clang__)
+#	pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+#	pragma GCC push_options
+#	pragma GCC target("avx2,fma")
+#endif
+
+#include "simd_pack_avx2.h"
+#include "soa_refinement_kernels.h"
+
+void
+soa_avx2::refine_vertices_catmull_clark(const SoaRefinementLevel& level)
+{
+	refine_vertices_catmull_clark_kernels<Pack_avx2>(level) ;
+}
+
+void
+soa_avx2::refine_vertices_loop(const SoaRefinementLevel& level)
+{
+	refine_vertices_loop_kernels<Pack_avx2>(level) ;
+}
+
+#if defined(__clang__)
+#	pragma clang attribute pop
+#elif defined(__GNUC__)
+#	pragma GCC pop_options
+#endif
+
+#else // no AVX2 kernels: detect_simd_isa never selects them
+
+void
+soa_avx2::refine_vertices_catmull_clark(const SoaRefinementLevel& level)
+{
+	soa_scalar::refine_vertices_catmull_clark(level) ;
+}
+
+void
+soa_avx2::refine_vertices_loop(const SoaRefinementLevel& level)
+{
+	soa_scalar::refine_vertices_loop(level) ;
+}
+
+#endif
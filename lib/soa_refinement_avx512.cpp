@@ -0,0 +1,53 @@
+#include "soa_refinement.h"
+
+#if defined(SIMD_X86) && !defined(ENABLE_64BIT_INDICES)
+
+#include <cstddef>
+#include <immintrin.h>
+
+#include "utils.h"
+
+// kernels of this translation unit are compiled for AVX-512F, whatever the flags of the build: they are only called if the CPU supports it (see detect_simd_isa)
+#if defined(__clang__)
+#	pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#elif defined(__GNUC__)
+#	pragma GCC push_options
+#	pragma GCC target("avx512f")
+#endif
+
+#include "simd_pack_avx512.h"
+#include "soa_refinement_kernels.h"
+
+void
+soa_avx512::refine_vertices_catmull_clark(const SoaRefinementLevel& level)
+{
+	refine_vertices_catmull_clark_kernels<Pack_avx512>(level) ;
+}
+
+void
+soa_avx512::refine_vertices_loop(const SoaRefinementLevel& level)
+{
+	refine_vertices_loop_kernels<Pack_avx512>(level) ;
+}
+
+#if defined(__clang__)
+#	pragma clang attribute pop
+#elif defined(__GNUC__)
+#	pragma GCC pop_options
+#endif
+
+#else // no AVX-512F kernels: detect_simd_isa never selects them
+
+void
+soa_avx512::refine_vertices_catmull_clark(const SoaRefinementLevel& level)
+{
+	soa_scalar::refine_vertices_catmull_clark(level) ;
+}
+
+void
+soa_avx512::refine_vertices_loop(const SoaRefinementLevel& level)
+{
+	soa_scalar::refine_vertices_loop(level) ;
+}
+
+#endif
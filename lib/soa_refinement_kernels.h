@@ -0,0 +1,532 @@
+#ifndef __SOA_REFINEMENT_KERNELS_H__
+#define __SOA_REFINEMENT_KERNELS_H__
+
+#include <cstddef>
+
+#include "soa_refinement.h"
+#include "utils.h"
+
+/**
+ * SoA vertex refinement kernels, written once for any SIMD pack P (see Pack_scalar) and instantiated by one translation unit per instruction set.
+ * Each lane computes one new vertex: face points and edge points gather the vertices of their face or edge,
+ * and vertex points walk the fan of their vertex (from vertex_halfedges) to gather their whole one-ring, then select their rule.
+ * Everything is in an anonymous namespace: instantiations compiled for different instruction sets must not be merged by the linker.
+ */
+namespace {
+
+/**
+ * @brief The Vec3_pack struct holds the coordinates of W vertices, one per lane.
+ */
+template <typename F>
+struct Vec3_pack
+{
+	typedef F Scalar ;
+	F x, y, z ;
+};
+
+// scalars only deduce F from the vector, such that plain floats convert to packs
+template <typename F>
+Vec3_pack<F>
+operator+(const Vec3_pack<F>& a, const Vec3_pack<F>& b)
+{
+	return {a.x + b.x, a.y + b.y, a.z + b.z} ;
+}
+
+template <typename F>
+Vec3_pack<F>
+operator-(const Vec3_pack<F>& a, const Vec3_pack<F>& b)
+{
+	return {a.x - b.x, a.y - b.y, a.z - b.z} ;
+}
+
+template <typename F>
+Vec3_pack<F>
+operator*(const typename Vec3_pack<F>::Scalar& s, const Vec3_pack<F>& a)
+{
+	return {s * a.x, s * a.y, s * a.z} ;
+}
+
+template <typename F>
+Vec3_pack<F>
+operator/(const Vec3_pack<F>& a, const typename Vec3_pack<F>::Scalar& s)
+{
+	return {a.x / s, a.y / s, a.z / s} ;
+}
+
+/**
+ * @brief The Soa_mesh struct gathers the halfedge, crease and vertex attributes of a SoaRefinementLevel into packs.
+ */
+template <typename P>
+struct Soa_mesh
+{
+	typedef typename P::F F ;
+	typedef typename P::I I ;
+	typedef typename P::M M ;
+	typedef typename P::Index Index ;
+	typedef Vec3_pack<F> V3 ;
+
+	static const int halfedge_stride = sizeof(HalfEdge) / sizeof(index_t) ;
+	static const int crease_stride = sizeof(Crease) / sizeof(float) ;
+	static const int slot_stride = sizeof(CreaseSlot) / sizeof(index_t) ;
+
+	Soa_mesh(const SoaRefinementLevel& level):
+		level(level),
+		twins(reinterpret_cast<const Index*>(level.halfedges) + offsetof(HalfEdge, Twin) / sizeof(index_t)),
+		verts(reinterpret_cast<const Index*>(level.halfedges) + offsetof(HalfEdge, Vert) / sizeof(index_t)),
+		edges(reinterpret_cast<const Index*>(level.halfedges) + offsetof(HalfEdge, Edge) / sizeof(index_t)),
+		sharpnesses(level.creases ? reinterpret_cast<const float*>(level.creases) + offsetof(Crease, Sharpness) / sizeof(float) : nullptr),
+		slot_edges(reinterpret_cast<const Index*>(level.crease_table) + offsetof(CreaseSlot, Edge) / sizeof(index_t)),
+		slot_creases(reinterpret_cast<const Index*>(level.crease_table) + offsetof(CreaseSlot, Crease) / sizeof(index_t))
+	{}
+
+	I Twin(I h, M m) const { return P::gather(twins, h * halfedge_stride, m) ; }
+	I Vert(I h, M m) const { return P::gather(verts, h * halfedge_stride, m) ; }
+	I Edge(I h, M m) const { return P::gather(edges, h * halfedge_stride, m) ; }
+
+	// edges beyond the crease buffer are smooth (see Mesh::Sharpness), and crease-free levels only have sharp borders (see BorderSharpness)
+	F Sharpness(I h, I e, M m) const
+	{
+		if (level.crease_table)
+			return sparse_sharpness(e, m) ;
+		if (!sharpnesses)
+			return P::select(P::lt(Twin(h, m), I(0)), F(1.0f), F(0.0f)) ;
+		return P::gather(sharpnesses, e * crease_stride, P::mask_and(m, P::lt(e, I(level.C)))) ;
+	}
+
+	// lanes probe the hash table (see SparseCreaseBuffer::find) until they find their edge or an empty slot
+	F sparse_sharpness(I e, M m) const
+	{
+		const I slot_mask = I((index_t(1) << level.crease_table_bits) - 1) ;
+		I slot = P::mul_hash(e, SparseCreaseBuffer::hash_factor, level.crease_table_bits) ;
+		F sharpness = F(0.0f) ;
+		M probing = m ;
+		while (P::any(probing))
+		{
+			const I slot_edge = P::gather(slot_edges, slot * slot_stride, probing) ;
+			const M found = P::mask_and(probing, P::eq(slot_edge, e)) ;
+			const I c = P::gather(slot_creases, slot * slot_stride, found) ;
+			sharpness = P::select(found, P::gather(sharpnesses, c * crease_stride, found), sharpness) ;
+			probing = P::mask_andnot(P::mask_or(found, P::lt(slot_edge, I(0))), probing) ;
+			slot = (slot + 1) & slot_mask ;
+		}
+		return sharpness ;
+	}
+
+	V3 old_vertex(I v, M m) const
+	{
+		return {P::gather(level.old_xyz[0], v, m), P::gather(level.old_xyz[1], v, m), P::gather(level.old_xyz[2], v, m)} ;
+	}
+	V3 new_vertex(I v, M m) const
+	{
+		return {P::gather(level.new_xyz[0], v, m), P::gather(level.new_xyz[1], v, m), P::gather(level.new_xyz[2], v, m)} ;
+	}
+	V3 load_old_vertices(index_t first, M m) const
+	{
+		return {P::load(level.old_xyz[0] + first, m), P::load(level.old_xyz[1] + first, m), P::load(level.old_xyz[2] + first, m)} ;
+	}
+	void store_new_vertices(index_t first, const V3& v, M m) const
+	{
+		P::store(level.new_xyz[0] + first, v.x, m) ;
+		P::store(level.new_xyz[1] + first, v.y, m) ;
+		P::store(level.new_xyz[2] + first, v.z, m) ;
+	}
+	void scatter_new_vertex(I idx, const V3& v, M m) const
+	{
+		P::scatter(level.new_xyz[0], idx, v.x, m) ;
+		P::scatter(level.new_xyz[1], idx, v.y, m) ;
+		P::scatter(level.new_xyz[2], idx, v.z, m) ;
+	}
+
+	const SoaRefinementLevel& level ;
+	const Index* twins ;
+	const Index* verts ;
+	const Index* edges ;
+	const float* sharpnesses ;
+	const Index* slot_edges ;
+	const Index* slot_creases ;
+};
+
+// ----------- Topology of uniform depths (see topology.h) -----------
+template <typename P>
+struct Quad_pack_topology
+{
+	typedef typename P::I I ;
+	static I Next(I h) { return h - (h & 3) + ((h + 1) & 3) ; }
+	static I Prev(I h) { return h - (h & 3) + ((h + 3) & 3) ; }
+	static I Face(I h) { return h >> 2 ; }
+};
+
+template <typename P>
+struct Triangle_pack_topology
+{
+	typedef typename P::I I ;
+	static I Next(I h) { const I r = h - 3 * P::div3(h) ; return P::select(P::eq(r, I(2)), h - 2, h + 1) ; }
+	static I Prev(I h) { const I r = h - 3 * P::div3(h) ; return P::select(P::eq(r, I(0)), h + 2, h - 1) ; }
+};
+
+// ----------- Arithmetic helpers -----------
+template <typename P>
+typename P::F
+clamp01(typename P::F x)
+{
+	return P::min(P::max(x, typename P::F(0.0f)), typename P::F(1.0f)) ;
+}
+
+template <typename P>
+Vec3_pack<typename P::F>
+lerp3(const Vec3_pack<typename P::F>& a, const Vec3_pack<typename P::F>& b, typename P::F alpha)
+{
+	return (1.0f - alpha) * a + alpha * b ;
+}
+
+template <typename P>
+Vec3_pack<typename P::F>
+select3(typename P::M m, const Vec3_pack<typename P::F>& a, const Vec3_pack<typename P::F>& b)
+{
+	return {P::select(m, a.x, b.x), P::select(m, a.y, b.y), P::select(m, a.z, b.z)} ;
+}
+
+// same thresholds as sgn() in utils.h
+template <typename P>
+typename P::F
+sgn_pack(typename P::F s)
+{
+	typedef typename P::F F ;
+	return P::select(P::lt(F(_epsilon_), s), F(1.0f), P::select(P::lt(s, F(-_epsilon_)), F(-1.0f), F(0.0f))) ;
+}
+
+template <typename P>
+typename P::I
+count_if(typename P::M m)
+{
+	typedef typename P::I I ;
+	return P::select(m, I(1), I(0)) ;
+}
+
+// ----------- Catmull-Clark -----------
+template <typename P>
+void
+refine_facepoints_catmull_clark(const Soa_mesh<P>& mesh)
+{
+	typedef typename P::I I ;
+	typedef typename P::M M ;
+	typedef Vec3_pack<typename P::F> V3 ;
+
+	const index_t Vd = mesh.level.V ;
+	const index_t Fd = mesh.level.F ;
+
+	_PARALLEL_FOR
+	for (index_t f_id = 0 ; f_id < Fd ; f_id += P::W)
+	{
+		const I f = P::iota(f_id) ;
+		const M active = P::lt(f, I(Fd)) ;
+		const I h = 4 * f ;
+
+		const V3 sum = mesh.old_vertex(mesh.Vert(h, active), active)
+					 + mesh.old_vertex(mesh.Vert(h + 1, active), active)
+					 + mesh.old_vertex(mesh.Vert(h + 2, active), active)
+					 + mesh.old_vertex(mesh.Vert(h + 3, active), active) ;
+
+		mesh.store_new_vertices(Vd + f_id, 0.25f * sum, active) ;
+	}
+	_BARRIER
+}
+
+template <typename P>
+Vec3_pack<typename P::F>
+edgepoint_increment_catmull_clark(const Soa_mesh<P>& mesh, typename P::I h, typename P::I twin, typename P::M m)
+{
+	typedef typename P::F F ;
+	typedef typename P::I I ;
+	typedef Vec3_pack<F> V3 ;
+	typedef Quad_pack_topology<P> Topology ;
+
+	const V3 v_old = mesh.old_vertex(mesh.Vert(h, m), m) ;
+	const V3 v_next_old = mesh.old_vertex(mesh.Vert(Topology::Next(h), m), m) ;
+	const V3 new_face_pt = mesh.new_vertex(I(mesh.level.V) + Topology::Face(h), m) ;
+
+	const F border_factr = P::select(P::lt(twin, I(0)), F(1.0f), F(0.5f)) ;
+	const V3 increm_smooth = 0.25f * (v_old + new_face_pt) ; // Smooth rule B.2
+	const V3 increm_sharp = border_factr * lerp3<P>(v_old, v_next_old, 0.5f) ; // Crease rule: B.3
+
+	const F lerp_alpha = clamp01<P>(mesh.Sharpness(h, mesh.Edge(h, m), m)) ;
+	return lerp3<P>(increm_smooth, increm_sharp, lerp_alpha) ; // Blending crease rule: B.4
+}
+
+template <typename P>
+void
+refine_edgepoints_catmull_clark(const Soa_mesh<P>& mesh)
+{
+	typedef typename P::I I ;
+	typedef typename P::M M ;
+	typedef Vec3_pack<typename P::F> V3 ;
+
+	const index_t Hd = mesh.level.H ;
+	const index_t VFd = mesh.level.V + mesh.level.F ;
+
+	_PARALLEL_FOR
+	for (index_t h_id = 0 ; h_id < Hd ; h_id += P::W)
+	{
+		// an edge is computed by its biggest halfedge id (twin is negative at borders)
+		const I h = P::iota(h_id) ;
+		const M active = P::lt(h, I(Hd)) ;
+		const I twin = mesh.Twin(h, active) ;
+		const M owner = P::mask_and(active, P::lt(twin, h)) ;
+		if (!P::any(owner))
+			continue ;
+
+		const M has_twin = P::mask_andnot(P::lt(twin, I(0)), owner) ;
+		const V3 increm = edgepoint_increment_catmull_clark(mesh, h, twin, owner) ;
+		const V3 increm_twin = edgepoint_increment_catmull_clark(mesh, twin, h, has_twin) ;
+		const V3 new_edge_pt = increm + select3<P>(has_twin, increm_twin, V3{0.0f, 0.0f, 0.0f}) ;
+
+		mesh.scatter_new_vertex(I(VFd) + mesh.Edge(h, owner), new_edge_pt, owner) ;
+	}
+	_BARRIER
+}
+
+template <typename P>
+void
+refine_vertexpoints_catmull_clark(const Soa_mesh<P>& mesh)
+{
+	typedef typename P::F F ;
+	typedef typename P::I I ;
+	typedef typename P::M M ;
+	typedef Vec3_pack<F> V3 ;
+	typedef Quad_pack_topology<P> Topology ;
+
+	const index_t Vd = mesh.level.V ;
+	const I Vd_pack = I(Vd) ;
+	const I VFd_pack = I(Vd + mesh.level.F) ;
+	const V3 zero = {0.0f, 0.0f, 0.0f} ;
+
+	_PARALLEL_FOR
+	for (index_t v_id = 0 ; v_id < Vd ; v_id += P::W)
+	{
+		const M active = P::lt(P::iota(v_id), Vd_pack) ;
+		const I h_first = P::load(mesh.level.vertex_halfedges + v_id, active) ;
+		const M valid = P::mask_andnot(P::lt(h_first, I(0)), active) ; // not an isolated vertex
+		const V3 v_old = mesh.load_old_vertices(v_id, valid) ;
+
+		// walk the fan of outgoing halfedges, accumulating the vertex configuration and the sums of the per-halfedge increments
+		I n_halfedges = I(0) ;
+		I n_creases = I(0) ;
+		F sharpness_sum = 0.0f ;
+		V3 edge_pt_sum = zero ;
+		V3 face_pt_sum = zero ;
+		V3 creased_sum = zero ;
+		V3 creased_last = zero ;
+
+		I h = h_first ;
+		M walking = valid ;
+		M border = P::none() ;
+		while (P::any(walking))
+		{
+			const I edge = mesh.Edge(h, walking) ;
+			const F sharpness = mesh.Sharpness(h, edge, walking) ;
+			const V3 new_edge_pt = mesh.new_vertex(VFd_pack + edge, walking) ;
+			const V3 new_face_pt = mesh.new_vertex(Vd_pack + Topology::Face(h), walking) ;
+			const V3 creased = sgn_pack<P>(sharpness) * (new_edge_pt + v_old) ;
+
+			n_halfedges = n_halfedges + count_if<P>(walking) ;
+			n_creases = n_creases + count_if<P>(P::mask_and(walking, P::lt(F(_epsilon_), sharpness))) ;
+			sharpness_sum = sharpness_sum + sharpness ;
+			edge_pt_sum = edge_pt_sum + new_edge_pt ;
+			face_pt_sum = face_pt_sum + new_face_pt ;
+			creased_sum = creased_sum + creased ;
+			creased_last = select3<P>(walking, creased, creased_last) ;
+
+			const I twin = mesh.Twin(h, walking) ;
+			const M at_border = P::mask_and(walking, P::lt(twin, I(0))) ;
+			border = P::mask_or(border, at_border) ;
+			h = P::select(walking, Topology::Next(twin), h) ;
+			walking = P::mask_andnot(P::mask_or(at_border, P::eq(h, h_first)), walking) ;
+		}
+
+		// border vertices also have the incoming border edge, whose creased term is the previous edge of the first halfedge
+		const I h_prev = Topology::Prev(h_first) ;
+		const I prev_edge = mesh.Edge(h_prev, border) ;
+		const F prev_sharpness = mesh.Sharpness(h_prev, prev_edge, border) ;
+		const V3 creased_prev = sgn_pack<P>(prev_sharpness) * (mesh.new_vertex(VFd_pack + prev_edge, border) + v_old) ;
+		n_creases = n_creases + count_if<P>(P::mask_and(border, P::lt(F(_epsilon_), prev_sharpness))) ;
+		sharpness_sum = sharpness_sum + prev_sharpness ;
+
+		const I edge_valence = n_halfedges + count_if<P>(border) ;
+		const F n = P::to_float(edge_valence) ;
+		const F k = P::to_float(n_halfedges) ;
+		const F lerp_alpha = clamp01<P>(0.5f * sharpness_sum) ;
+
+		const V3 vx_corner = k * (v_old / k) ; // corner vertex rule: C.3
+		const V3 vx_smooth = (4.0f * edge_pt_sum - face_pt_sum + (k * (n - 3.0f)) * v_old) / (n * n) ; // Smooth rule: C.2
+		const V3 vx_creased = 0.25f * creased_sum + select3<P>(border, 0.25f * (creased_sum - creased_last + creased_prev), zero) ; // Creased vertex rule: C.5
+
+		const M is_corner = P::mask_or(P::eq(edge_valence, I(2)), P::lt(I(2), n_creases)) ;
+		const M is_smooth = P::lt(n_creases, I(2)) ;
+		V3 new_vx_pt = select3<P>(is_corner, vx_corner, select3<P>(is_smooth, vx_smooth, lerp3<P>(vx_corner, vx_creased, lerp_alpha))) ;
+		new_vx_pt = select3<P>(valid, new_vx_pt, zero) ;
+
+		mesh.store_new_vertices(v_id, new_vx_pt, active) ;
+	}
+	_BARRIER
+}
+
+template <typename P>
+void
+refine_vertices_catmull_clark_kernels(const SoaRefinementLevel& level)
+{
+	const Soa_mesh<P> mesh(level) ;
+	refine_facepoints_catmull_clark(mesh) ;
+	refine_edgepoints_catmull_clark(mesh) ;
+	refine_vertexpoints_catmull_clark(mesh) ;
+}
+
+// ----------- Loop -----------
+template <typename P>
+Vec3_pack<typename P::F>
+oddpoint_increment_loop(const Soa_mesh<P>& mesh, typename P::I h, typename P::I twin, typename P::M m)
+{
+	typedef typename P::F F ;
+	typedef typename P::I I ;
+	typedef Vec3_pack<F> V3 ;
+	typedef Triangle_pack_topology<P> Topology ;
+
+	const V3 v_old = mesh.old_vertex(mesh.Vert(h, m), m) ;
+	const V3 v_prev_old = mesh.old_vertex(mesh.Vert(Topology::Prev(h), m), m) ;
+	const V3 v_next_old = mesh.old_vertex(mesh.Vert(Topology::Next(h), m), m) ;
+
+	const V3 increm_smooth = 0.375f * v_old + 0.125f * v_prev_old ;
+	const V3 increm_sharp = 0.5f * select3<P>(P::lt(twin, I(0)), v_old + v_next_old, v_old) ;
+
+	const F lerp_alpha = clamp01<P>(mesh.Sharpness(h, mesh.Edge(h, m), m)) ;
+	return lerp3<P>(increm_smooth, increm_sharp, lerp_alpha) ;
+}
+
+template <typename P>
+void
+refine_oddpoints_loop(const Soa_mesh<P>& mesh)
+{
+	typedef typename P::I I ;
+	typedef typename P::M M ;
+	typedef Vec3_pack<typename P::F> V3 ;
+
+	const index_t Hd = mesh.level.H ;
+	const index_t Vd = mesh.level.V ;
+
+	_PARALLEL_FOR
+	for (index_t h_id = 0 ; h_id < Hd ; h_id += P::W)
+	{
+		// an edge is computed by its biggest halfedge id (twin is negative at borders)
+		const I h = P::iota(h_id) ;
+		const M active = P::lt(h, I(Hd)) ;
+		const I twin = mesh.Twin(h, active) ;
+		const M owner = P::mask_and(active, P::lt(twin, h)) ;
+		if (!P::any(owner))
+			continue ;
+
+		const M has_twin = P::mask_andnot(P::lt(twin, I(0)), owner) ;
+		const V3 increm = oddpoint_increment_loop(mesh, h, twin, owner) ;
+		const V3 increm_twin = oddpoint_increment_loop(mesh, twin, h, has_twin) ;
+		const V3 new_odd_pt = increm + select3<P>(has_twin, increm_twin, V3{0.0f, 0.0f, 0.0f}) ;
+
+		mesh.scatter_new_vertex(I(Vd) + mesh.Edge(h, owner), new_odd_pt, owner) ;
+	}
+	_BARRIER
+}
+
+template <typename P>
+void
+refine_evenpoints_loop(const Soa_mesh<P>& mesh)
+{
+	typedef typename P::F F ;
+	typedef typename P::I I ;
+	typedef typename P::M M ;
+	typedef Vec3_pack<F> V3 ;
+	typedef Triangle_pack_topology<P> Topology ;
+
+	const index_t Vd = mesh.level.V ;
+	const I beta_max = I(mesh.level.beta_table_size - 1) ;
+	const V3 zero = {0.0f, 0.0f, 0.0f} ;
+
+	_PARALLEL_FOR
+	for (index_t v_id = 0 ; v_id < Vd ; v_id += P::W)
+	{
+		const M active = P::lt(P::iota(v_id), I(Vd)) ;
+		const I h_first = P::load(mesh.level.vertex_halfedges + v_id, active) ;
+		const M valid = P::mask_andnot(P::lt(h_first, I(0)), active) ; // not an isolated vertex
+		const V3 v_old = mesh.load_old_vertices(v_id, valid) ;
+
+		// walk the fan of outgoing halfedges, accumulating the vertex configuration and the sums of the per-halfedge increments
+		I n_halfedges = I(0) ;
+		I n_creases = I(0) ;
+		F sharpness_sum = 0.0f ;
+		F sharp_factr_v_old = 0.0f ;
+		F sharp_factr_border = 0.0f ;
+		V3 next_sum = zero ;
+		V3 sharp_next_sum = zero ;
+
+		I h = h_first ;
+		M walking = valid ;
+		M border = P::none() ;
+		while (P::any(walking))
+		{
+			const F sharpness = mesh.Sharpness(h, mesh.Edge(h, walking), walking) ;
+			const F sharp_factr = P::select(P::lt(sharpness, F(1e-6f)), F(0.0f), F(1.0f)) ;
+			const V3 v_next_old = mesh.old_vertex(mesh.Vert(Topology::Next(h), walking), walking) ;
+			const I twin = mesh.Twin(h, walking) ;
+			const M at_border = P::mask_and(walking, P::lt(twin, I(0))) ;
+
+			n_halfedges = n_halfedges + count_if<P>(walking) ;
+			n_creases = n_creases + count_if<P>(P::mask_and(walking, P::lt(F(_epsilon_), sharpness))) ;
+			sharpness_sum = sharpness_sum + sharpness ;
+			next_sum = next_sum + v_next_old ;
+			sharp_next_sum = sharp_next_sum + sharp_factr * v_next_old ;
+			sharp_factr_v_old = sharp_factr_v_old + sharp_factr * P::select(at_border, F(0.75f), F(0.375f)) ;
+			sharp_factr_border = P::select(at_border, sharp_factr, sharp_factr_border) ;
+
+			border = P::mask_or(border, at_border) ;
+			h = P::select(walking, Topology::Next(twin), h) ;
+			walking = P::mask_andnot(P::mask_or(at_border, P::eq(h, h_first)), walking) ;
+		}
+
+		// border vertices also have the incoming border edge, that points from the border neighbor
+		const I h_in = Topology::Prev(h_first) ;
+		const F prev_sharpness = mesh.Sharpness(h_in, mesh.Edge(h_in, border), border) ;
+		const V3 v_border_old = mesh.old_vertex(mesh.Vert(h_in, border), border) ;
+		n_creases = n_creases + count_if<P>(P::mask_and(border, P::lt(F(_epsilon_), prev_sharpness))) ;
+		sharpness_sum = sharpness_sum + prev_sharpness ;
+
+		const I edge_valence = n_halfedges + count_if<P>(border) ;
+		const F k = P::to_float(n_halfedges) ;
+		const F vx_sharpness = P::select(P::lt(n_creases, I(2)), F(0.0f), 0.5f * sharpness_sum) ;
+		const F lerp_alpha = clamp01<P>(vx_sharpness) ;
+
+		const I beta_id = P::select(P::lt(beta_max, edge_valence), beta_max, edge_valence) ;
+		const F beta = P::gather(mesh.level.beta_table, beta_id, valid) ;
+		const F beta_ = 1.0f / P::to_float(edge_valence) - beta ;
+
+		const V3 vx_corner = k * (v_old / k) ;
+		const V3 vx_smooth = (k * beta_) * v_old + beta * next_sum ;
+		const V3 vx_sharp = 0.125f * sharp_next_sum + sharp_factr_v_old * v_old + (0.125f * sharp_factr_border) * select3<P>(border, v_border_old, zero) ;
+
+		const M is_corner = P::mask_or(P::eq(edge_valence, I(2)), P::lt(I(2), n_creases)) ;
+		const M is_smooth = P::lt(vx_sharpness, F(1e-6f)) ;
+		V3 new_vx_pt = select3<P>(is_corner, vx_corner, select3<P>(is_smooth, vx_smooth, lerp3<P>(vx_corner, vx_sharp, lerp_alpha))) ;
+		new_vx_pt = select3<P>(valid, new_vx_pt, zero) ;
+
+		mesh.store_new_vertices(v_id, new_vx_pt, active) ;
+	}
+	_BARRIER
+}
+
+template <typename P>
+void
+refine_vertices_loop_kernels(const SoaRefinementLevel& level)
+{
+	const Soa_mesh<P> mesh(level) ;
+	refine_oddpoints_loop(mesh) ;
+	refine_evenpoints_loop(mesh) ;
+}
+
+}
+
+#endif
@@ -0,0 +1,187 @@
+#ifndef __SPARSE_CREASE_BUFFER_H__
+#define __SPARSE_CREASE_BUFFER_H__
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "index_type.h"
+#include "crease.h"
+#include "utils.h"
+
+/**
+ * @brief The CreaseSlot struct is a slot of the hash table of a SparseCreaseBuffer
+ */
+struct CreaseSlot
+{
+	index_t Edge ; /*!< edge of the crease, or -1 if the slot is empty */
+	index_t Crease ; /*!< index of the crease in the SparseCreaseBuffer */
+};
+
+/**
+ * @brief The SparseCreaseBuffer struct stores the creases of one depth whose edge may be sharp, instead of one crease per edge.
+ * Creases are sorted by edge, and found from their edge by a hash table (Fibonacci hashing, linear probing, at most half full).
+ * Neighbors (Crease::Next and Crease::Prev) are edge indices, as in dense crease buffers: edges without a crease are smooth, with null neighbors.
+ */
+struct SparseCreaseBuffer
+{
+#ifdef ENABLE_64BIT_INDICES
+	typedef uint64_t hash_t ; /*!< unsigned integer of the width of index_t, in which edges are hashed */
+	static const hash_t hash_factor = 11400714819323198485ull ; /*!< 2^64 divided by the golden ratio */
+#else
+	typedef uint32_t hash_t ; /*!< unsigned integer of the width of index_t, in which edges are hashed */
+	static const hash_t hash_factor = 2654435769u ; /*!< 2^32 divided by the golden ratio */
+#endif
+	static const int max_table_bits = 8 * sizeof(index_t) - 2 ; /*!< log2 of the largest table: twice as many slots as creases must be countable by index_t */
+
+	std::vector<index_t> edges ; /*!< edge of each crease, in increasing order */
+	std::vector<Crease> creases ; /*!< sharpness and neighbors of each crease */
+	std::vector<CreaseSlot> table ; /*!< hash table of 2^#table_bits slots, indexing creases by edge */
+	int table_bits = 0 ; /*!< log2 of the number of slots of the table */
+
+	/**
+	 * @brief count gives the number of creases
+	 */
+	index_t count() const { return edges.size() ; }
+
+	/**
+	 * @brief resize sets the number of creases. New creases are not initialized, and the table must be rebuilt (see #build_table).
+	 */
+	void resize(index_t n)
+	{
+		edges.resize(n) ;
+		creases.resize(n) ;
+	}
+
+	/**
+	 * @brief release frees the buffers
+	 */
+	void release()
+	{
+		std::vector<index_t>().swap(edges) ;
+		std::vector<Crease>().swap(creases) ;
+		std::vector<CreaseSlot>().swap(table) ;
+		table_bits = 0 ;
+	}
+
+	/**
+	 * @brief hash gives the home slot of an edge in a table of 2^bits slots: the bits high bits of the product of the edge with #hash_factor, in the width of index_t
+	 */
+	static index_t hash(index_t e, int bits)
+	{
+		return index_t((hash_t(e) * hash_factor) >> (8 * sizeof(hash_t) - bits)) ;
+	}
+
+	/**
+	 * @brief build_table indexes the creases in a table of at least twice as many slots.
+	 * Insertion is sequential (linear probing depends on the insertion order): it only visits the creases.
+	 * Exits if there are more creases than half the slots of the largest table (see #max_table_bits), which would never stop probing once full.
+	 */
+	void build_table()
+	{
+		const index_t n = count() ;
+		if (n > (index_t(1) << (max_table_bits - 1)))
+		{
+			std::cerr << "ERROR SparseCreaseBuffer::build_table: too many creases for the hash table, rebuild with ENABLE_64BIT_INDICES" << std::endl ;
+			exit(1) ;
+		}
+
+		table_bits = 1 ;
+		while ((index_t(1) << table_bits) < 2 * n)
+			++table_bits ;
+
+		const index_t mask = (index_t(1) << table_bits) - 1 ;
+		table.assign(mask + 1, {-1, -1}) ;
+		for (index_t c = 0 ; c < n ; ++c)
+		{
+			index_t slot = hash(edges[c], table_bits) ;
+			while (table[slot].Edge >= 0)
+				slot = (slot + 1) & mask ;
+			table[slot] = {edges[c], c} ;
+		}
+	}
+
+	/**
+	 * @brief find gives the index of the crease of an edge
+	 * @param e an edge index
+	 * @return the index of the crease of edge e, or -1 if e has no crease
+	 */
+	index_t find(index_t e) const
+	{
+		const index_t mask = (index_t(1) << table_bits) - 1 ;
+		for (index_t slot = hash(e, table_bits) ; table[slot].Edge >= 0 ; slot = (slot + 1) & mask)
+		{
+			if (table[slot].Edge == e)
+				return table[slot].Crease ;
+		}
+		return -1 ;
+	}
+
+	/**
+	 * @brief crease gives the crease of an edge, as it would be stored in a dense crease buffer
+	 * @param e an edge index
+	 * @return the crease of edge e, or a smooth crease with null neighbors if e has none
+	 */
+	Crease crease(index_t e) const
+	{
+		const index_t c = find(e) ;
+		return c < 0 ? Crease() : creases[c] ;
+	}
+
+	/**
+	 * @brief Sharpness gives the sharpness of an edge
+	 * @param e an edge index
+	 * @return the sharpness of the crease of edge e, or 0 if e has none
+	 */
+	float Sharpness(index_t e) const
+	{
+		const index_t c = find(e) ;
+		return c < 0 ? 0.0f : creases[c].Sharpness ;
+	}
+
+	/**
+	 * @brief from_dense keeps (in parallel) the creases of non-zero sharpness of a dense crease buffer, and builds the table
+	 * @param dense a crease buffer indexed by edge
+	 */
+	void from_dense(const std::vector<Crease>& dense)
+	{
+		const index_t n_dense = dense.size() ;
+		std::vector<index_t> offsets(n_dense) ;
+		_PARALLEL_FOR
+		for (index_t e = 0 ; e < n_dense ; ++e)
+			offsets[e] = dense[e].Sharpness > 0.0f ? 1 : 0 ;
+		_BARRIER
+		resize(exclusive_scan_parallel(offsets)) ;
+
+		_PARALLEL_FOR
+		for (index_t e = 0 ; e < n_dense ; ++e)
+		{
+			if (dense[e].Sharpness > 0.0f)
+			{
+				edges[offsets[e]] = e ;
+				creases[offsets[e]] = dense[e] ;
+			}
+		}
+		_BARRIER
+
+		build_table() ;
+	}
+
+	/**
+	 * @brief to_dense expands (in parallel) the creases into a dense crease buffer, whose other creases are smooth with null neighbors
+	 * @param dense the crease buffer indexed by edge
+	 * @param n_dense the number of creases of the dense buffer
+	 */
+	void to_dense(std::vector<Crease>& dense, index_t n_dense) const
+	{
+		dense.assign(n_dense, Crease()) ;
+		const index_t n = count() ;
+		_PARALLEL_FOR
+		for (index_t c = 0 ; c < n ; ++c)
+			dense[edges[c]] = creases[c] ;
+		_BARRIER
+	}
+};
+
+#endif
@@ -0,0 +1,212 @@
+#ifndef __STENCIL_TABLE_H__
+#define __STENCIL_TABLE_H__
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "index_type.h"
+#include "vec3.h"
+#include "utils.h"
+
+/**
+ * @brief The Stencil class is a refined vertex written as a weighted sum of the vertices of a coarser depth: a sparse row of a subdivision matrix.
+ * Its operations are those of vec3, such that the vertex refinement kernels instantiated on Stencil record their weights instead of computing positions
+ * (see Mesh_Subdiv_CPU::compute_stencil_tables). Entries are sorted by vertex, and entries whose weights cancel out are dropped.
+ */
+class Stencil
+{
+	Stencil friend operator*(const float& c, const Stencil& s)
+	{
+		return s * c ;
+	}
+
+private:
+	std::vector<std::pair<index_t, float>> entries ; /*!< coarse vertex and weight of each entry, in increasing vertex order */
+
+	/**
+	 * @brief merge sums the weights of two stencils, those of the second one being multiplied by c
+	 */
+	static Stencil merge(const Stencil& a, const Stencil& b, float c)
+	{
+		Stencil sum ;
+		sum.entries.reserve(a.entries.size() + b.entries.size()) ;
+		size_t i = 0, j = 0 ;
+		while (i < a.entries.size() || j < b.entries.size())
+		{
+			if (j == b.entries.size() || (i < a.entries.size() && a.entries[i].first < b.entries[j].first))
+				sum.entries.push_back(a.entries[i++]) ;
+			else if (i == a.entries.size() || b.entries[j].first < a.entries[i].first)
+			{
+				sum.entries.emplace_back(b.entries[j].first, c * b.entries[j].second) ;
+				++j ;
+			}
+			else
+			{
+				const float w = a.entries[i].second + c * b.entries[j].second ;
+				if (w != 0.0f)
+					sum.entries.emplace_back(a.entries[i].first, w) ;
+				++i ;
+				++j ;
+			}
+		}
+		return sum ;
+	}
+
+public:
+	Stencil()	{}
+
+	/**
+	 * @brief Stencil constructor of a coarse vertex itself
+	 * @param v the coarse vertex, with weight 1
+	 */
+	explicit Stencil(index_t v) : entries(1, std::make_pair(v, 1.0f))	{}
+
+	/**
+	 * @brief operator / divides the weights by a constant
+	 * @param c a scalar
+	 * @return the stencil that is the result of the operation
+	 */
+	Stencil operator/(const float& c) const
+	{
+		Stencil new_stencil(*this) ;
+		for (std::pair<index_t, float>& e: new_stencil.entries)
+			e.second /= c ;
+		return new_stencil ;
+	}
+
+	/**
+	 * @brief operator * multiplies the weights by a constant
+	 * @param c a scalar
+	 * @return the stencil that is the result of the operation
+	 */
+	Stencil operator*(const float& c) const
+	{
+		if (c == 0.0f)
+			return Stencil() ;
+		Stencil new_stencil(*this) ;
+		for (std::pair<index_t, float>& e: new_stencil.entries)
+			e.second *= c ;
+		return new_stencil ;
+	}
+
+	/**
+	 * @brief operator + sums two stencils
+	 * @param s the stencil to sum to the current one
+	 * @return the stencil that is the result of the operation
+	 */
+	Stencil operator+(const Stencil& s) const
+	{
+		return merge(*this, s, 1.0f) ;
+	}
+
+	/**
+	 * @brief operator - subtracts a stencil from the current one
+	 * @param s the stencil to subtract to the current one
+	 * @return the stencil that is the result of the operation
+	 */
+	Stencil operator-(const Stencil& s) const
+	{
+		return merge(*this, s, -1.0f) ;
+	}
+
+	/**
+	 * @brief get_entries gives the coarse vertices and weights of the stencil, in increasing vertex order
+	 */
+	const std::vector<std::pair<index_t, float>>& get_entries() const { return entries ; }
+};
+
+/**
+ * @brief The StencilTable struct stores a subdivision matrix in CSR format: the stencil of each refined vertex (row) over the vertices of a coarser depth (columns).
+ * Evaluating it is a sparse matrix-vector product, parallel over rows, without topology nor atomics (see Mesh_Subdiv_CPU::set_stencil_evaluation).
+ */
+struct StencilTable
+{
+	index_t column_count = 0 ; /*!< number of coarse vertices */
+	std::vector<index_t> row_offsets ; /*!< first entry of each row, followed by the number of entries */
+	std::vector<index_t> columns ; /*!< coarse vertex of each entry, in increasing order within each row */
+	std::vector<float> weights ; /*!< weight of each entry */
+
+	/**
+	 * @brief row_count gives the number of refined vertices
+	 */
+	index_t row_count() const { return row_offsets.empty() ? 0 : row_offsets.size() - 1 ; }
+
+	/**
+	 * @brief entry_count gives the number of weights
+	 */
+	index_t entry_count() const { return weights.size() ; }
+
+	/**
+	 * @brief memory_bytes gives the size of the buffers
+	 */
+	size_t memory_bytes() const
+	{
+		return (row_offsets.size() + columns.size()) * sizeof(index_t) + weights.size() * sizeof(float) ;
+	}
+
+	/**
+	 * @brief assign fills the table with a stencil per row
+	 * @param stencils the stencil of each refined vertex
+	 * @param n_columns the number of coarse vertices
+	 */
+	void assign(const std::vector<Stencil>& stencils, index_t n_columns)
+	{
+		const index_t n_rows = stencils.size() ;
+		column_count = n_columns ;
+		row_offsets.assign(n_rows + 1, 0) ;
+
+_PARALLEL_FOR
+		for (index_t r = 0 ; r < n_rows ; ++r)
+			row_offsets[r] = stencils[r].get_entries().size() ;
+_BARRIER
+
+		const index_t n_entries = exclusive_scan_parallel(row_offsets) ;
+		columns.resize(n_entries) ;
+		weights.resize(n_entries) ;
+
+_PARALLEL_FOR
+		for (index_t r = 0 ; r < n_rows ; ++r)
+		{
+			index_t k = row_offsets[r] ;
+			for (const std::pair<index_t, float>& e: stencils[r].get_entries())
+			{
+				columns[k] = e.first ;
+				weights[k] = e.second ;
+				++k ;
+			}
+		}
+_BARRIER
+	}
+
+	/**
+	 * @brief evaluate computes the refined vertices from the coarse ones. Each row is a dot product of its weights with the coarse vertices it gathers, vectorized over its entries.
+	 * @param in #column_count coarse vertices
+	 * @param out #row_count refined vertices (overwritten)
+	 */
+	void evaluate(const vec3* in, vec3* out) const
+	{
+		const index_t n_rows = row_count() ;
+		const index_t* offsets = row_offsets.data() ;
+		const index_t* cols = columns.data() ;
+		const float* w = weights.data() ;
+
+_PARALLEL_FOR
+		for (index_t r = 0 ; r < n_rows ; ++r)
+		{
+			float x = 0.0f, y = 0.0f, z = 0.0f ;
+_SIMD_REDUCTION(+, x, y, z)
+			for (index_t k = offsets[r] ; k < offsets[r + 1] ; ++k)
+			{
+				const vec3& v = in[cols[k]] ;
+				x += w[k] * v[0] ;
+				y += w[k] * v[1] ;
+				z += w[k] * v[2] ;
+			}
+			out[r] = vec3(x, y, z) ;
+		}
+_BARRIER
+	}
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef __TOPOLOGY_H__
+#define __TOPOLOGY_H__
+
+#include <vector>
+
+#include "halfedge.h"
+
+/**
+ * @brief The topology policies give the face connectivity (Next, Prev, Face, n_vertex_of_polygon) of one subdivision depth through non-virtual inline functions.
+ * CPU refinement kernels are templated on them and instantiated once per policy, so that the index arithmetic of uniform depths is inlined (and can be vectorized)
+ * instead of going through virtual calls that test at each halfedge whether the mesh is subdivided.
+ */
+
+/**
+ * @brief The CageTopology policy reads the connectivity of an arbitrary polygonal mesh from its HalfEdge_cage buffer.
+ */
+struct CageTopology
+{
+	CageTopology(const std::vector<HalfEdge_cage>& buffer):
+		halfedges_cage(buffer.data())
+	{}
+
+	index_t Next(index_t h) const { return halfedges_cage[h].Next ; }
+	index_t Prev(index_t h) const { return halfedges_cage[h].Prev ; }
+	index_t Face(index_t h) const { return halfedges_cage[h].Face ; }
+
+	int n_vertex_of_polygon(index_t h) const
+	{
+		int n = 1 ;
+		for (index_t h_fw = Next(h) ; h_fw != h ; h_fw = Next(h_fw))
+			++n ;
+		return n ;
+	}
+
+	const HalfEdge_cage* halfedges_cage ; /*!< HalfEdge_cage buffer of the mesh */
+};
+
+/**
+ * @brief The RegularTopology policy computes the connectivity of a mesh made of N-gons only, whose face f is made of halfedges N*f to N*f+N-1.
+ */
+template <int N>
+struct RegularTopology
+{
+	static index_t Next(index_t h) { return h % N == N - 1 ? h - (N - 1) : h + 1 ; }
+	static index_t Prev(index_t h) { return h % N == 0 ? h + (N - 1) : h - 1 ; }
+	static index_t Face(index_t h) { return h / N ; }
+	static int n_vertex_of_polygon(index_t) { return N ; }
+};
+
+typedef RegularTopology<3> TriangleTopology ;	/*!< topology of Loop subdivision meshes */
+typedef RegularTopology<4> QuadTopology ;		/*!< topology of Catmull-Clark subdivision meshes from depth 1 on */
+
+#endif
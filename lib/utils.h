@@ -1,10 +1,14 @@
 #ifndef __HELPERS__
 #define __HELPERS__
 
+#include <cstddef>
 #include <omp.h>
+#include <vector>
 
 #if defined(_WIN32)
 	typedef unsigned int uint;
+#else
+#	include <sys/types.h>
 #endif
 
 
@@ -21,6 +25,15 @@
 #       ifndef _BARRIER
 #           define _BARRIER         __pragma("omp barrier")
 #       endif
+#       ifndef _ATOMIC_CAPTURE
+#           define _ATOMIC_CAPTURE  __pragma("omp atomic capture")
+#       endif
+#       ifndef _PARALLEL_FOR_REDUCTION
+#           define _PARALLEL_FOR_REDUCTION(op, var) __pragma(omp parallel for reduction(op: var))
+#       endif
+#       ifndef _SIMD_REDUCTION
+#           define _SIMD_REDUCTION(op, ...) __pragma(omp simd reduction(op: __VA_ARGS__))
+#       endif
 #	else
 #       ifndef _ATOMIC
 #           define _ATOMIC          _Pragma("omp atomic" )
@@ -31,11 +44,26 @@
 #       ifndef _BARRIER
 #           define _BARRIER         _Pragma("omp barrier")
 #       endif
+#       ifndef _ATOMIC_CAPTURE
+#           define _ATOMIC_CAPTURE  _Pragma("omp atomic capture")
+#       endif
+#       ifndef _PRAGMA
+#           define _PRAGMA(x)       _Pragma(#x)
+#       endif
+#       ifndef _PARALLEL_FOR_REDUCTION
+#           define _PARALLEL_FOR_REDUCTION(op, var) _PRAGMA(omp parallel for reduction(op: var))
+#       endif
+#       ifndef _SIMD_REDUCTION
+#           define _SIMD_REDUCTION(op, ...) _PRAGMA(omp simd reduction(op: __VA_ARGS__))
+#       endif
 #	endif
 # else
 #		define _ATOMIC
 #		define _PARALLEL_FOR
 #		define _BARRIER
+#		define _ATOMIC_CAPTURE
+#		define _PARALLEL_FOR_REDUCTION(op, var)
+#		define _SIMD_REDUCTION(op, ...)
 # endif
 
 #define _epsilon_ 1e-9
@@ -56,5 +84,51 @@ int sgn(T val)
 	return (T(1e-9) < val) - (val < T(-1e-9));
 }
 
+/**
+ * @brief exclusive_scan_parallel replaces each value by the sum of the values preceding it, in parallel.
+ * @param values the values to scan (in place)
+ * @return the sum of all values
+ */
+template <typename T>
+T exclusive_scan_parallel(std::vector<T>& values)
+{
+	const size_t n = values.size() ;
+	std::vector<T> chunk_sums(omp_get_max_threads() + 1, T(0)) ;
+	T total = T(0) ;
+
+	#pragma omp parallel
+	{
+		const int n_chunks = omp_get_num_threads() ;
+		const int chunk = omp_get_thread_num() ;
+		const size_t begin = n * chunk / n_chunks ;
+		const size_t end = n * (chunk + 1) / n_chunks ;
+
+		// local scan of the chunk
+		T sum = T(0) ;
+		for (size_t i = begin ; i < end ; ++i)
+		{
+			const T value = values[i] ;
+			values[i] = sum ;
+			sum += value ;
+		}
+		chunk_sums[chunk + 1] = sum ;
+
+		#pragma omp barrier
+		#pragma omp single
+		{
+			for (int c = 1 ; c <= n_chunks ; ++c)
+				chunk_sums[c] += chunk_sums[c - 1] ;
+			total = chunk_sums[n_chunks] ;
+		}
+
+		// offset by the preceding chunks
+		const T offset = chunk_sums[chunk] ;
+		for (size_t i = begin ; i < end ; ++i)
+			values[i] += offset ;
+	}
+
+	return total ;
+}
+
 
 #endif
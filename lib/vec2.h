@@ -0,0 +1,112 @@
+#ifndef VEC2_H
+#define VEC2_H
+
+/**
+ * @brief The vec2 class is a utility class for UV coordinates.
+ */
+class vec2
+{
+	vec2 friend operator*(const float& c, const vec2& v)
+	{
+		return v * c ;
+	}
+
+private:
+	float val[2] = {}; /*!< Stores the value of the coordinate */
+
+public:
+	vec2()	{}
+
+	/**
+	 * @brief vec2 constructor from uv values
+	 * @param u first ordinate
+	 * @param v second ordinate
+	 */
+	vec2(float u, float v)
+	{
+		val[0] = u ;
+		val[1] = v ;
+	}
+
+	/**
+	 * @brief operator / divides the current coordinate by a constant
+	 * @param c a scalar
+	 * @return the coordinate that is the result of the operation
+	 */
+	vec2 operator/(const float& c) const
+	{
+		return vec2(val[0] / c, val[1] / c) ;
+	}
+
+	/**
+	 * @brief operator * multiplies the current coordinate by a constant
+	 * @param c a scalar
+	 * @return the coordinate that is the result of the operation
+	 */
+	vec2 operator*(const float& c) const
+	{
+		return vec2(val[0] * c, val[1] * c) ;
+	}
+
+	/**
+	 * @brief operator + sums two coordinates
+	 * @param v the coordinate to sum to the current one
+	 * @return the coordinate that is the result of the operation
+	 */
+	vec2 operator+(const vec2& v) const
+	{
+		return vec2(val[0] + v[0], val[1] + v[1]) ;
+	}
+
+	/**
+	 * @brief operator - subtracts a coordinate from the current one
+	 * @param v the coordinate to subtract to the current one
+	 * @return the coordinate that is the result of the operation
+	 */
+	vec2 operator-(const vec2& v) const
+	{
+		return vec2(val[0] - v[0], val[1] - v[1]) ;
+	}
+
+	/**
+	 * @brief operator == compares two coordinates exactly, as face-varying refinement tells UV seams by (see Mesh_Subdiv_CPU::is_uv_seam)
+	 * @param v the coordinate to compare to the current one
+	 * @return true if both ordinates are equal
+	 */
+	bool operator==(const vec2& v) const
+	{
+		return val[0] == v[0] && val[1] == v[1] ;
+	}
+
+	/**
+	 * @brief operator != compares two coordinates exactly
+	 * @param v the coordinate to compare to the current one
+	 * @return true if an ordinate differs
+	 */
+	bool operator!=(const vec2& v) const
+	{
+		return !(*this == v) ;
+	}
+
+	/**
+	 * @brief operator [] is an accessor for each element of the coordinate
+	 * @param i index to access
+	 * @return const reference to the scalar
+	 */
+	const float& operator[](const int& i) const
+	{
+		return val[i] ;
+	}
+
+	/**
+	 * @brief operator [] is an accessor for each element of the coordinate
+	 * @param i index to access
+	 * @return non-const reference to the scalar
+	 */
+	float& operator[](const int& i)
+	{
+		return val[i] ;
+	}
+};
+
+#endif // VEC2_H
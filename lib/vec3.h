@@ -1,6 +1,8 @@
 #ifndef VEC3_H
 #define VEC3_H
 
+#include <cmath>
+
 /**
  * @brief The vec3 class is a utility class for XYZ coordinates.
  */
@@ -20,6 +22,8 @@ private:
 	float val[3] = {}; /*!< Stores the value of the coordinate */
 
 public:
+	static const int size = 3 ; /*!< number of floats of the coordinate */
+
 	vec3()	{}
 
 	/**
@@ -105,6 +109,36 @@ public:
 		return new_val ;
 	}
 
+	/**
+	 * @brief dot computes the dot product of the current coordinate with another one
+	 * @param v a coordinate
+	 * @return the scalar that is the result of the operation
+	 */
+	float dot(const vec3& v) const
+	{
+		return val[0] * v[0] + val[1] * v[1] + val[2] * v[2] ;
+	}
+
+	/**
+	 * @brief cross computes the cross product of the current coordinate with another one
+	 * @param v a coordinate
+	 * @return the coordinate that is the result of the operation
+	 */
+	vec3 cross(const vec3& v) const
+	{
+		return vec3(val[1] * v[2] - val[2] * v[1], val[2] * v[0] - val[0] * v[2], val[0] * v[1] - val[1] * v[0]) ;
+	}
+
+	/**
+	 * @brief normalized scales the current coordinate to unit length
+	 * @return the coordinate that is the result of the operation, or the null coordinate if the current one is null
+	 */
+	vec3 normalized() const
+	{
+		const float length = std::sqrt(dot(*this)) ;
+		return length > 0.0f ? *this / length : vec3() ;
+	}
+
 	/**
 	 * @brief operator [] is an accessor for each element of the coordinate
 	 * @param i index to access
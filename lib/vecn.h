@@ -0,0 +1,97 @@
+#ifndef VECN_H
+#define VECN_H
+
+/**
+ * @brief The vecN class is a utility class for N floats per vertex: a position followed by vertex attributes (see Mesh_Subdiv_CPU::packed_vertex_width).
+ * Its operations are those of vec3, computed coordinate-wise in the same order, such that the first three coordinates are refined exactly as a vec3.
+ */
+template <int N>
+class vecN
+{
+	vecN friend operator*(const float& c, const vecN& v)
+	{
+		return v * c ;
+	}
+
+private:
+	float val[N] = {}; /*!< Stores the value of the coordinate */
+
+public:
+	static const int size = N ; /*!< number of floats of the coordinate */
+
+	vecN()	{}
+
+	/**
+	 * @brief operator / divides the current coordinate by a constant
+	 * @param c a scalar
+	 * @return the coordinate that is the result of the operation
+	 */
+	vecN operator/(const float& c) const
+	{
+		vecN new_val ;
+		for (int i = 0 ; i < N ; ++i)
+			new_val[i] = val[i] / c ;
+		return new_val ;
+	}
+
+	/**
+	 * @brief operator * multiplies the current coordinate by a constant
+	 * @param c a scalar
+	 * @return the coordinate that is the result of the operation
+	 */
+	vecN operator*(const float& c) const
+	{
+		vecN new_val ;
+		for (int i = 0 ; i < N ; ++i)
+			new_val[i] = val[i] * c ;
+		return new_val ;
+	}
+
+	/**
+	 * @brief operator + sums two coordinates
+	 * @param v the coordinate to sum to the current one
+	 * @return the coordinate that is the result of the operation
+	 */
+	vecN operator+(const vecN& v) const
+	{
+		vecN new_val ;
+		for (int i = 0 ; i < N ; ++i)
+			new_val[i] = val[i] + v[i] ;
+		return new_val ;
+	}
+
+	/**
+	 * @brief operator - subtracts a coordinate from the current one
+	 * @param v the coordinate to subtract to the current one
+	 * @return the coordinate that is the result of the operation
+	 */
+	vecN operator-(const vecN& v) const
+	{
+		vecN new_val ;
+		for (int i = 0 ; i < N ; ++i)
+			new_val[i] = val[i] - v[i] ;
+		return new_val ;
+	}
+
+	/**
+	 * @brief operator [] is an accessor for each element of the coordinate
+	 * @param i index to access
+	 * @return const reference to the scalar
+	 */
+	const float& operator[](const int& i) const
+	{
+		return val[i] ;
+	}
+
+	/**
+	 * @brief operator [] is an accessor for each element of the coordinate
+	 * @param i index to access
+	 * @return non-const reference to the scalar
+	 */
+	float& operator[](const int& i)
+	{
+		return val[i] ;
+	}
+};
+
+#endif // VECN_H
@@ -0,0 +1,109 @@
+#ifndef __VERTEX_BUFFER_SOA_H__
+#define __VERTEX_BUFFER_SOA_H__
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "index_type.h"
+#include "vec3.h"
+#include "utils.h"
+
+/**
+ * @brief The Aligned_allocator class allocates memory aligned on cache lines (which also aligns AVX-512 vectors).
+ */
+template <typename T>
+struct Aligned_allocator
+{
+	typedef T value_type ;
+	static const size_t alignment = 64 ;
+
+	Aligned_allocator() = default ;
+	template <typename U> Aligned_allocator(const Aligned_allocator<U>&) {}
+
+	T* allocate(size_t n)
+	{
+		const size_t size = (n * sizeof(T) + alignment - 1) / alignment * alignment ;
+#if defined(_WIN32)
+		void* ptr = _aligned_malloc(size, alignment) ;
+#else
+		void* ptr = std::aligned_alloc(alignment, size) ;
+#endif
+		if (ptr == nullptr)
+			throw std::bad_alloc() ;
+		return static_cast<T*>(ptr) ;
+	}
+
+	void deallocate(T* ptr, size_t)
+	{
+#if defined(_WIN32)
+		_aligned_free(ptr) ;
+#else
+		std::free(ptr) ;
+#endif
+	}
+
+	template <typename U> bool operator==(const Aligned_allocator<U>&) const { return true ; }
+	template <typename U> bool operator!=(const Aligned_allocator<U>&) const { return false ; }
+};
+
+/**
+ * @brief The VertexBufferSoA struct stores vertex coordinates as a structure of arrays: one aligned array per coordinate.
+ * Arrays are padded to a multiple of #padding floats, such that full SIMD vectors can be read and written past the last vertex.
+ */
+struct VertexBufferSoA
+{
+	static const index_t padding = 16 ; /*!< number of floats of an AVX-512 vector */
+
+	std::vector<float, Aligned_allocator<float>> xyz[3] ; /*!< x, y and z coordinates */
+	index_t count = 0 ; /*!< number of vertices */
+
+	/**
+	 * @brief resize sets the number of vertices. New coordinates are zeroed, and kept ones are left as they are.
+	 */
+	void resize(index_t n)
+	{
+		count = n ;
+		const index_t padded = (n + padding - 1) / padding * padding ;
+		for (int c = 0 ; c < 3 ; ++c)
+			xyz[c].resize(padded) ;
+	}
+
+	/**
+	 * @brief release frees the arrays
+	 */
+	void release()
+	{
+		count = 0 ;
+		for (int c = 0 ; c < 3 ; ++c)
+			std::vector<float, Aligned_allocator<float>>().swap(xyz[c]) ;
+	}
+
+	/**
+	 * @brief from_aos copies (in parallel) an array of vec3 into the buffer, which is resized to match it
+	 */
+	void from_aos(const std::vector<vec3>& vertices)
+	{
+		resize(vertices.size()) ;
+		_PARALLEL_FOR
+		for (index_t v = 0 ; v < count ; ++v)
+			for (int c = 0 ; c < 3 ; ++c)
+				xyz[c][v] = vertices[v][c] ;
+		_BARRIER
+	}
+
+	/**
+	 * @brief to_aos copies (in parallel) the buffer into an array of vec3, which is resized to match it
+	 */
+	void to_aos(std::vector<vec3>& vertices) const
+	{
+		vertices.resize(count) ;
+		_PARALLEL_FOR
+		for (index_t v = 0 ; v < count ; ++v)
+			vertices[v] = vec3(xyz[0][v], xyz[1][v], xyz[2][v]) ;
+		_BARRIER
+	}
+};
+
+#endif
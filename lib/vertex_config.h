@@ -0,0 +1,17 @@
+#ifndef __VERTEX_CONFIG__
+#define __VERTEX_CONFIG__
+
+#include "index_type.h"
+
+/**
+ * @brief The VertexConfig struct stores the local configuration of a vertex, which selects and parameterizes the vertex refinement rules
+ */
+struct VertexConfig
+{
+	int Edge_valence ; /*!< Number of edges adjacent to the vertex */
+	int Crease_valence ; /*!< Number of sharp creases adjacent to the vertex */
+	float Sharpness_sum ; /*!< Sum of the sharpnesses of the edges adjacent to the vertex */
+	index_t Border_neighbor ; /*!< Index of the previous vertex along the border (i.e., Vert of the incoming border halfedge), or -1 if the vertex is not on a border */
+};
+
+#endif
@@ -50,6 +50,8 @@ int main(int argc, char* argv[])
 	{ // encapsulates what requires GL context
 		std::cout << "Loading " << f_name << " ... " << std::flush ;
 		Mesh_Subdiv_Loop_GPU M(f_name, D) ;
+		if (!M.is_loaded())
+			return 1 ;
 		std::cout << "[OK]" << std::endl ;
 
 		if (M.V(D) > MAX_VERTICES)
@@ -7,26 +7,49 @@
 
 int main(int argc, char* argv[])
 {
+	const std::string usage = std::string("Usage: ") + argv[0] + " <filename>.obj [--write-cage <filename>.cage]" ;
 	if (argc < 2)
 	{
-		std::cout << "Usage: " << argv[0] << " <filename>.obj" << std::endl ;
+		std::cout << usage << std::endl ;
 		return 0 ;
 	}
 
 	const std::string f_name(argv[1]) ;
 
+	std::string f_name_cage ;
+	for (int i = 2 ; i < argc ; ++i)
+	{
+		const std::string option(argv[i]) ;
+		if (option == "--write-cage")
+		{
+			f_name_cage = i + 1 < argc ? argv[++i] : "" ;
+			if (f_name_cage.empty())
+			{
+				std::cout << "ERROR: --write-cage needs a filename" << std::endl << usage << std::endl ;
+				return 1 ;
+			}
+		}
+		else
+		{
+			std::cout << "ERROR: unknown option '" << option << "'" << std::endl << usage << std::endl ;
+			return 1 ;
+		}
+	}
+
 	std::cout << "Loading " << f_name << std::endl ;
 
 	const Mesh M(f_name) ;
+	if (!M.is_loaded())
+		return 1 ;
 	const bool is_tri = M.is_tri_only() ;
 	const bool is_quad = M.is_quad_only() ;
-	const int borders = M.count_border_edges() ;
-	const int H = M.H() ;
-	const int V = M.V() ;
-	const int E = M.E() ;
-	const int F = M.F() ;
-	const int C = M.C() ;
-	const int sharp_creases = M.count_sharp_creases() ;
+	const index_t borders = M.count_border_edges() ;
+	const index_t H = M.H() ;
+	const index_t V = M.V() ;
+	const index_t E = M.E() ;
+	const index_t F = M.F() ;
+	const index_t C = M.C() ;
+	const index_t sharp_creases = M.count_sharp_creases() ;
 
 	if (is_tri)
 		std::cout << "Triangle-only mesh" << std::endl ;
@@ -40,5 +63,16 @@ int main(int argc, char* argv[])
 	std::cout << "F:\t" << F << std::endl ;
 	std::cout << "C:\t" << C << "\t(" << sharp_creases << " sharp)" << std::endl ;
 
+	std::cout << "Load timings (ms): " << std::endl ;
+	for (const auto& step: M.get_load_timings())
+		std::cout << step.first << ":\t" << step.second << std::endl ;
+
+	if (!f_name_cage.empty())
+	{
+		std::cout << "Exporting cage " << f_name_cage << " ... " << std::flush ;
+		M.export_to_cage(f_name_cage) ;
+		std::cout << "[OK]" << std::endl ;
+	}
+
 	return 0 ;
 }